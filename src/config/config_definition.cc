@@ -534,6 +534,23 @@ std::vector<std::shared_ptr<ConfigSetup>> ConfigDefinition::getServerOptions()
         std::make_shared<ConfigBoolSetup>(ConfigVal::SERVER_STORAGE_USE_TRANSACTIONS,
             "/server/storage/attribute::use-transactions", "config-server.html#storage",
             NO),
+        std::make_shared<ConfigArraySetup>(ConfigVal::SERVER_STORAGE_PROMOTED_METADATA,
+            "/server/storage/promoted-metadata", "config-server.html#storage",
+            ConfigVal::A_IMPORT_LIBOPTS_AUXDATA_DATA, ConfigVal::A_IMPORT_LIBOPTS_AUXDATA_TAG,
+            false, false),
+        std::make_shared<ConfigArraySetup>(ConfigVal::SERVER_STORAGE_SORT_ARTICLES,
+            "/server/storage/sort-articles", "config-server.html#storage",
+            ConfigVal::A_IMPORT_LIBOPTS_AUXDATA_DATA, ConfigVal::A_IMPORT_LIBOPTS_AUXDATA_TAG,
+            false, false),
+        std::make_shared<ConfigIntSetup>(ConfigVal::SERVER_STORAGE_OBJECT_CACHE_SIZE,
+            "/server/storage/attribute::object-cache-size", "config-server.html#storage",
+            2000, 0, ConfigIntSetup::CheckMinValue),
+        std::make_shared<ConfigIntSetup>(ConfigVal::SERVER_STORAGE_SEARCH_CACHE_SIZE,
+            "/server/storage/attribute::search-cache-size", "config-server.html#storage",
+            100, 0, ConfigIntSetup::CheckMinValue),
+        std::make_shared<ConfigIntSetup>(ConfigVal::SERVER_STORAGE_SLOW_QUERY_TIME,
+            "/server/storage/attribute::slow-query-time", "config-server.html#storage",
+            1000, 0, ConfigIntSetup::CheckMinValue),
         std::make_shared<ConfigStringSetup>(ConfigVal::SERVER_STORAGE_MYSQL,
             "/server/storage/mysql", "config-server.html#storage"),
 #ifdef HAVE_MYSQL
@@ -564,6 +581,9 @@ std::vector<std::shared_ptr<ConfigSetup>> ConfigDefinition::getServerOptions()
         std::make_shared<ConfigPathSetup>(ConfigVal::SERVER_STORAGE_MYSQL_UPGRADE_FILE,
             "/server/storage/mysql/upgrade-file", "config-server.html#storage",
             "", ConfigPathArguments::isFile | ConfigPathArguments::mustExist | ConfigPathArguments::resolveEmpty),
+        std::make_shared<ConfigIntSetup>(ConfigVal::SERVER_STORAGE_MYSQL_CONNECTIONS,
+            "/server/storage/mysql/attribute::connections", "config-server.html#storage",
+            4, 1, ConfigIntSetup::CheckMinValue),
 #else
         std::make_shared<ConfigBoolSetup>(ConfigVal::SERVER_STORAGE_MYSQL_ENABLED,
             "/server/storage/mysql/attribute::enabled", "config-server.html#storage",
@@ -609,6 +629,12 @@ std::vector<std::shared_ptr<ConfigSetup>> ConfigDefinition::getServerOptions()
         std::make_shared<ConfigIntSetup>(ConfigVal::SERVER_STORAGE_SQLITE_SHUTDOWN_ATTEMPTS,
             "/server/storage/sqlite3/attribute::shutdown-attempts", "config-server.html#storage",
             5, 2, ConfigIntSetup::CheckMinValue),
+        std::make_shared<ConfigIntSetup>(ConfigVal::SERVER_STORAGE_SQLITE_READ_CONNECTIONS,
+            "/server/storage/sqlite3/attribute::read-connections", "config-server.html#storage",
+            0, 0, ConfigIntSetup::CheckMinValue),
+        std::make_shared<ConfigBoolSetup>(ConfigVal::SERVER_STORAGE_SQLITE_SEARCH_INDEX,
+            "/server/storage/sqlite3/attribute::search-index", "config-server.html#storage",
+            NO),
 
         // Web User Interface
         std::make_shared<ConfigBoolSetup>(ConfigVal::SERVER_UI_ENABLED,
@@ -778,6 +804,15 @@ std::vector<std::shared_ptr<ConfigSetup>> ConfigDefinition::getServerOptions()
         std::make_shared<ConfigIntSetup>(ConfigVal::UPNP_CAPTION_COUNT,
             "/server/upnp/attribute::caption-info-count", "config-server.html#upnp",
             1, 0, ConfigIntSetup::CheckMinValue),
+        std::make_shared<ConfigIntSetup>(ConfigVal::UPNP_DIDL_CACHE_SIZE,
+            "/server/upnp/attribute::didl-cache-size", "config-server.html#upnp",
+            8192, 0, ConfigIntSetup::CheckMinValue),
+        std::make_shared<ConfigIntSetup>(ConfigVal::UPNP_BROWSE_CACHE_SIZE,
+            "/server/upnp/attribute::browse-cache-size", "config-server.html#upnp",
+            4096, 0, ConfigIntSetup::CheckMinValue),
+        std::make_shared<ConfigIntSetup>(ConfigVal::UPNP_RENDER_THREADS,
+            "/server/upnp/attribute::render-threads", "config-server.html#upnp",
+            0, 0, ConfigIntSetup::CheckMinValue),
         std::make_shared<ConfigArraySetup>(ConfigVal::UPNP_SEARCH_ITEM_SEGMENTS,
             "/server/upnp/search-item-result", "config-server.html#upnpf",
             ConfigVal::A_IMPORT_LIBOPTS_AUXDATA_DATA, ConfigVal::A_IMPORT_LIBOPTS_AUXDATA_TAG,
@@ -2049,6 +2084,7 @@ void ConfigDefinition::initDependencies()
         { ConfigVal::SERVER_STORAGE_MYSQL_PASSWORD, ConfigVal::SERVER_STORAGE_MYSQL },
         { ConfigVal::SERVER_STORAGE_MYSQL_INIT_SQL_FILE, ConfigVal::SERVER_STORAGE_MYSQL },
         { ConfigVal::SERVER_STORAGE_MYSQL_UPGRADE_FILE, ConfigVal::SERVER_STORAGE_MYSQL },
+        { ConfigVal::SERVER_STORAGE_MYSQL_CONNECTIONS, ConfigVal::SERVER_STORAGE_MYSQL },
 #endif
 #ifdef HAVE_CURL
         { ConfigVal::EXTERNAL_TRANSCODING_CURL_BUFFER_SIZE, ConfigVal::TRANSCODING_TRANSCODING_ENABLED },
@@ -74,6 +74,11 @@ enum class ConfigVal {
     SERVER_STORAGE_SQLITE,
     SERVER_STORAGE_DRIVER,
     SERVER_STORAGE_USE_TRANSACTIONS,
+    SERVER_STORAGE_PROMOTED_METADATA,
+    SERVER_STORAGE_SORT_ARTICLES,
+    SERVER_STORAGE_OBJECT_CACHE_SIZE,
+    SERVER_STORAGE_SEARCH_CACHE_SIZE,
+    SERVER_STORAGE_SLOW_QUERY_TIME,
     SERVER_STORAGE_SQLITE_ENABLED,
     SERVER_STORAGE_SQLITE_DATABASE_FILE,
     SERVER_STORAGE_SQLITE_SYNCHRONOUS,
@@ -84,6 +89,8 @@ enum class ConfigVal {
     SERVER_STORAGE_SQLITE_INIT_SQL_FILE,
     SERVER_STORAGE_SQLITE_UPGRADE_FILE,
     SERVER_STORAGE_SQLITE_SHUTDOWN_ATTEMPTS,
+    SERVER_STORAGE_SQLITE_READ_CONNECTIONS,
+    SERVER_STORAGE_SQLITE_SEARCH_INDEX,
     SERVER_STORAGE_MYSQL_ENABLED,
 #ifdef HAVE_MYSQL
     SERVER_STORAGE_MYSQL_HOST,
@@ -94,6 +101,7 @@ enum class ConfigVal {
     SERVER_STORAGE_MYSQL_DATABASE,
     SERVER_STORAGE_MYSQL_INIT_SQL_FILE,
     SERVER_STORAGE_MYSQL_UPGRADE_FILE,
+    SERVER_STORAGE_MYSQL_CONNECTIONS,
 #endif
 #ifdef HAVE_FFMPEGTHUMBNAILER
     SERVER_EXTOPTS_FFMPEGTHUMBNAILER_ENABLED,
@@ -284,6 +292,9 @@ enum class ConfigVal {
     UPNP_OBJECT_PROPERTY_DEFAULTS,
     UPNP_CONTAINER_PROPERTY_DEFAULTS,
     UPNP_CAPTION_COUNT,
+    UPNP_DIDL_CACHE_SIZE,
+    UPNP_BROWSE_CACHE_SIZE,
+    UPNP_RENDER_THREADS,
     IMPORT_READABLE_NAMES,
     IMPORT_CASE_SENSITIVE_TAGS,
     SERVER_DYNAMIC_CONTENT_LIST_ENABLED,
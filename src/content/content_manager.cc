@@ -1674,6 +1674,8 @@ void ContentManager::triggerPlayHook(const std::string& group, const std::shared
     log_debug("Marking object {} as played", obj->getTitle());
     if (!suppress)
         updateObject(obj, true);
+    else
+        update_manager->containerContentChanged(obj->getParentID());
 
 #ifdef HAVE_LASTFMLIB
     if (config->getBoolOption(ConfigVal::SERVER_EXTOPTS_LASTFM_ENABLED) && item->isSubClass(UPNP_CLASS_AUDIO_ITEM)) {
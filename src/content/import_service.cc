@@ -39,6 +39,7 @@
 #include "metadata/metadata_enums.h"
 #include "metadata/metadata_handler.h"
 #include "metadata/metadata_service.h"
+#include "util/grb_time.h"
 #include "util/mime.h"
 #include "util/string_converter.h"
 #include "util/tools.h"
@@ -54,6 +55,50 @@
 #include <fmt/chrono.h>
 #include <regex>
 
+#define IMPORT_BATCH_SIZE 200 // number of new items written to the database in one transaction
+#define IMPORT_BATCH_MILLIS 1000 // maximum delay of writing new items to the database
+
+ImportBatch::ImportBatch(std::shared_ptr<Database> database, std::size_t maxSize, std::chrono::milliseconds maxAge)
+    : database(std::move(database))
+    , maxSize(maxSize)
+    , maxAge(maxAge)
+{
+}
+
+ImportBatch::~ImportBatch()
+{
+    try {
+        flush();
+    } catch (const std::runtime_error& e) {
+        log_error("Failed to add {} new objects: {}", objects.size(), e.what());
+    }
+}
+
+void ImportBatch::add(const std::shared_ptr<CdsObject>& obj)
+{
+    if (objects.empty())
+        start = currentTimeMS();
+    objects.push_back(obj);
+    if (objects.size() >= maxSize)
+        flush();
+}
+
+void ImportBatch::flushIfDue()
+{
+    if (!objects.empty() && getDeltaMillis(start) >= maxAge)
+        flush();
+}
+
+void ImportBatch::flush()
+{
+    if (objects.empty())
+        return;
+    // clear before writing, a failed batch is not written again
+    auto batch = std::move(objects);
+    objects.clear();
+    database->addObjects(batch);
+}
+
 bool UpnpMap::checkValue(const std::string& op, const std::string& expect, const std::string& actual) const
 {
     if (op == "=" || op == "==")
@@ -129,6 +174,7 @@ ContentState::ContentState(fs::directory_entry dirEntry, ImportState state, std:
     , dirEntry(std::move(dirEntry))
     , mtime(mtime)
     , cdsObject(std::move(cdsObject))
+    , objectId(INVALID_OBJECT_ID)
 {
     itemCounter[ObjectType::Audio] = 0;
     itemCounter[ObjectType::Video] = 0;
@@ -138,6 +184,11 @@ ContentState::ContentState(fs::directory_entry dirEntry, ImportState state, std:
     itemCounter[ObjectType::Unknown] = 0;
 }
 
+int ContentState::getObjectId() const
+{
+    return cdsObject ? cdsObject->getID() : objectId;
+}
+
 AutoscanMediaMode ContentState::getMediaMode() const
 {
     AutoscanMediaMode mediaMode = AutoscanMediaMode::Mixed;
@@ -297,7 +348,7 @@ void ImportService::doImport(
     }
     removeHidden(settings);
     createContainers(CDS_ID_FS_ROOT, settings);
-    createItems(settings);
+    createItems(isDir ? location : location.parent_path(), settings);
     updateFanArt(isDir);
     fillLayout(task);
 
@@ -305,10 +356,10 @@ void ImportService::doImport(
     for (auto&& [itemPath, stateEntry] : contentStateCache) {
         if (!stateEntry)
             continue;
-        if (stateEntry->getObject() && stateEntry->getState() == ImportState::Existing) {
-            auto entry = currentContent.find(stateEntry->getObject()->getID());
+        if (stateEntry->getObjectId() != INVALID_OBJECT_ID && stateEntry->getState() == ImportState::Existing) {
+            auto entry = currentContent.find(stateEntry->getObjectId());
             if (entry != currentContent.end()) {
-                currentContent.erase(stateEntry->getObject()->getID());
+                currentContent.erase(entry);
             }
         }
     }
@@ -326,7 +377,11 @@ std::shared_ptr<CdsObject> ImportService::getObject(const fs::path& location) co
 {
     log_debug("start {}", location.string());
     if (contentStateCache.find(location) != contentStateCache.end()) {
-        return contentStateCache.at(location)->getObject();
+        auto stateEntry = contentStateCache.at(location);
+        // unchanged items of a rescan are not loaded during the import
+        if (stateEntry && !stateEntry->getObject() && stateEntry->getObjectId() != INVALID_OBJECT_ID)
+            return database->loadObject(stateEntry->getObjectId());
+        return stateEntry ? stateEntry->getObject() : nullptr;
     }
     return {};
 }
@@ -546,15 +601,28 @@ std::tuple<bool, std::string, std::string> ImportService::getMimeForFile(const f
 }
 
 ///\brief create items for all discovered files
-void ImportService::createItems(AutoScanSetting& settings)
+void ImportService::createItems(const fs::path& scanDir, AutoScanSetting& settings)
 {
     log_debug("start {}", rootPath.string());
+    // load all stored files below the scanned directory at once instead of searching each file
+    std::unordered_map<std::string, FileState> fileStates;
+    auto scanState = contentStateCache.find(scanDir);
+    auto scanObj = scanState != contentStateCache.end() && scanState->second ? scanState->second->getObject() : nullptr;
+    auto hasFileStates = scanObj && scanObj->isContainer() && scanObj->getID() != INVALID_OBJECT_ID;
+    if (hasFileStates)
+        fileStates = database->getFileStates(scanObj->getID());
+
     std::shared_ptr<CdsContainer> parentContainer = nullptr;
     auto lastModifiedCurrentMax = std::chrono::seconds::zero();
     auto lastModifiedNewMax = lastModifiedCurrentMax;
     fs::path contPath;
 
+    // new items are added in batches to reduce the number of database transactions
+    ImportBatch newObjects(database, IMPORT_BATCH_SIZE, std::chrono::milliseconds(IMPORT_BATCH_MILLIS));
+
     for (auto&& [itemPath, stateEntry] : contentStateCache) {
+        // slow metadata extraction or database updates must not delay pending items
+        newObjects.flushIfDue();
         if (!stateEntry) {
             log_debug("broken entry {}", itemPath.string());
             continue;
@@ -591,18 +659,37 @@ void ImportService::createItems(AutoScanSetting& settings)
             else
                 log_error("No Container parent for Item {}", itemPath.string());
 
-            if (!cdsObj) {
+            bool fromFileState = false;
+            if (!cdsObj && hasFileStates) {
+                // Build item from stored state, full object is only loaded if the file changed
+                auto fileState = fileStates.find(itemPath.string());
+                if (fileState != fileStates.end()) {
+                    auto item = std::make_shared<CdsItem>();
+                    item->setID(fileState->second.id);
+                    item->setParentID(fileState->second.parentId);
+                    item->setFlags(fileState->second.flags);
+                    item->setMTime(fileState->second.mtime);
+                    item->setClass(fileState->second.upnpClass);
+                    item->setMimeType(fileState->second.mimeType);
+                    item->setLocation(itemPath);
+                    cdsObj = item;
+                    fromFileState = true;
+                }
+            } else if (!cdsObj) {
                 // Search item in database
                 log_debug("Searching Item {} in database", itemPath.string());
                 cdsObj = database->findObjectByPath(itemPath, UNUSED_CLIENT_GROUP, DbFileType::File);
             }
             if (cdsObj && cdsObj->isItem()) {
-                auto isChanged = stateEntry->getMTime() != cdsObj->getMTime() || cdsObj->getLocation().string() != dirEntry.path().string();
+                // items built from the file state are found by the scanned path, other objects may have been renamed
+                auto isChanged = stateEntry->getMTime() != cdsObj->getMTime() || (!fromFileState && cdsObj->getLocation().string() != dirEntry.path().string());
                 if (autoscanDir && autoscanDir->getForceRescan())
                     isChanged = isChanged || cdsObj->getClass().empty() || cdsObj->getClass() == UPNP_CLASS_ITEM;
                 if (isChanged) {
                     // Update changed item in database
                     log_debug("Updating Item {} in database {}", itemPath.string(), cdsObj->getID());
+                    if (fromFileState)
+                        cdsObj = database->loadObject(cdsObj->getID());
                     auto item = std::dynamic_pointer_cast<CdsItem>(cdsObj);
                     if (item->getMimeType().empty() || item->getClass().empty() || item->getClass() == UPNP_CLASS_ITEM) {
                         auto [skip, mimetype, upnpClass] = getMimeForFile(itemPath);
@@ -633,7 +720,11 @@ void ImportService::createItems(AutoScanSetting& settings)
                         if (lastModifiedNewMax < cdsObj->getMTime())
                             lastModifiedNewMax = cdsObj->getMTime();
                     }
-                    stateEntry->setObject(ImportState::Existing, cdsObj);
+                    // items built from stored state miss metadata and resources, they must not reach layout or callers
+                    if (fromFileState)
+                        stateEntry->setObjectId(ImportState::Existing, cdsObj->getID());
+                    else
+                        stateEntry->setObject(ImportState::Existing, cdsObj);
                     log_debug("Item found {} {}", itemPath.string(), cdsObj->getID());
                 }
             } else {
@@ -649,7 +740,7 @@ void ImportService::createItems(AutoScanSetting& settings)
                     }
                     stateEntry->setObject(ImportState::Created, cdsObj);
                     cdsObj->setParentID(parentContainer ? parentContainer->getID() : INVALID_OBJECT_ID);
-                    database->addObject(cdsObj, nullptr);
+                    newObjects.add(cdsObj);
                 } else {
                     stateEntry->setObject(ImportState::Broken, cdsObj);
                     cdsObj = nullptr;
@@ -668,6 +759,7 @@ void ImportService::createItems(AutoScanSetting& settings)
             log_debug("Not a file {}", itemPath.string());
         }
     }
+    newObjects.flush();
     if (autoscanDir && contPath != "") {
         autoscanDir->setCurrentLMT(contPath, lastModifiedNewMax);
     }
@@ -1090,8 +1182,12 @@ void ImportService::updateFanArt(bool isDir)
         if (!stateEntry || !stateEntry->getObject() || !stateEntry->getObject()->isContainer())
             continue;
         std::shared_ptr<CdsContainer> container = std::dynamic_pointer_cast<CdsContainer>(stateEntry->getObject());
+        auto firstObject = stateEntry->getFirstObject();
+        // items built from stored file state have no resources to take fanart from
+        if (firstObject && firstObject->isItem() && firstObject->getResourceCount() == 0 && firstObject->getID() != INVALID_OBJECT_ID)
+            firstObject = database->loadObject(firstObject->getID());
         assignFanArt(container,
-            stateEntry->getFirstObject(),
+            firstObject,
             stateEntry->getMediaMode(),
             isDir,
             1,
@@ -82,6 +82,8 @@ private:
     std::chrono::seconds mtime = std::chrono::seconds::zero();
     /// \brief CdsObject associated with the directory_entry
     std::shared_ptr<CdsObject> cdsObject;
+    /// \brief id of an unchanged item that was not loaded from the database
+    int objectId;
     /// \brief CdsObject associated with the container (if cdsObject is a container)
     std::shared_ptr<CdsObject> firstObject;
     /// \brief counters of child object types for container type
@@ -101,6 +103,13 @@ public:
         this->state = state;
         this->cdsObject = std::move(cdsObject);
     }
+    /// \brief keep only the id of an unchanged item, the object is loaded when it is requested
+    void setObjectId(ImportState state, int objectId)
+    {
+        this->state = state;
+        this->cdsObject = nullptr;
+        this->objectId = objectId;
+    }
     void setFirstObject(std::shared_ptr<CdsObject> firstObject)
     {
         this->firstObject = std::move(firstObject);
@@ -110,6 +119,7 @@ public:
         this->parentObject = std::move(parentObject);
     }
     std::shared_ptr<CdsObject> getObject() { return cdsObject; }
+    int getObjectId() const;
     std::shared_ptr<CdsObject> getFirstObject() { return firstObject; }
     std::shared_ptr<CdsContainer> getParentObject() { return parentObject; }
     fs::directory_entry getDirEntry() { return dirEntry; }
@@ -125,6 +135,34 @@ public:
     AutoscanMediaMode getMediaMode() const;
 };
 
+/// @brief Collects new objects of an import and adds them to the database in batches
+///
+/// Pending objects are written when the batch is full, when it is older than maxAge and
+/// when the batch is destroyed, so objects are not lost if the import is left by an exception.
+class ImportBatch {
+private:
+    std::shared_ptr<Database> database;
+    std::size_t maxSize;
+    std::chrono::milliseconds maxAge;
+    std::chrono::milliseconds start = std::chrono::milliseconds::zero();
+    std::vector<std::shared_ptr<CdsObject>> objects;
+
+public:
+    ImportBatch(std::shared_ptr<Database> database, std::size_t maxSize, std::chrono::milliseconds maxAge);
+    ~ImportBatch();
+
+    ImportBatch(const ImportBatch&) = delete;
+    ImportBatch& operator=(const ImportBatch&) = delete;
+
+    /// \brief add object to the batch, a full batch is written
+    void add(const std::shared_ptr<CdsObject>& obj);
+    /// \brief write the pending objects if the batch is older than maxAge
+    void flushIfDue();
+    /// \brief write the pending objects
+    void flush();
+    std::size_t size() const { return objects.size(); }
+};
+
 /// @brief Mapping logic to generate upnpClass from file (meta) data
 class UpnpMap {
 private:
@@ -207,7 +245,8 @@ private:
     /// \brief create containers for all discovered folders
     void createContainers(int parentContainerId, AutoScanSetting& settings);
     /// \brief create items for all discovered files
-    void createItems(AutoScanSetting& settings);
+    /// \param scanDir directory the scan started in, stored files below are loaded at once
+    void createItems(const fs::path& scanDir, AutoScanSetting& settings);
     void updateSingleItem(const fs::directory_entry& dirEntry, const std::shared_ptr<CdsItem>& item, const std::string& mimetype);
     void fillLayout(const std::shared_ptr<GenericTask>& task);
     void updateFanArt(bool isDir);
@@ -90,6 +90,8 @@ void UpdateManager::shutdown()
 void UpdateManager::containersChanged(const std::vector<int>& objectIDs, int flushPolicy)
 {
     log_debug("start");
+    if (server)
+        server->containersChanged(objectIDs);
     auto lock = threadRunner->uniqueLock();
     // signalling thread if it could have been idle, because
     // there were no unprocessed updates
@@ -127,11 +129,19 @@ void UpdateManager::containersChanged(const std::vector<int>& objectIDs, int flu
     log_debug("end");
 }
 
+void UpdateManager::containerContentChanged(int objectID) const
+{
+    if (server && objectID != INVALID_OBJECT_ID)
+        server->containersChanged({ objectID });
+}
+
 void UpdateManager::containerChanged(int objectID, int flushPolicy)
 {
     log_debug("start");
     if (objectID == INVALID_OBJECT_ID)
         return;
+    if (server)
+        server->containersChanged({ objectID });
 
     auto lock = threadRunner->lockGuard();
 
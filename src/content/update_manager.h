@@ -62,6 +62,8 @@ public:
 
     void containerChanged(int objectID, int flushPolicy = FLUSH_SPEC);
     void containersChanged(const std::vector<int>& objectIDs, int flushPolicy = FLUSH_SPEC);
+    /// \brief drop cached responses of the container without sending an update
+    void containerContentChanged(int objectID) const;
 
 protected:
     std::shared_ptr<Config> config;
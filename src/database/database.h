@@ -36,7 +36,10 @@
 
 #include "util/grb_fs.h"
 
+#include <chrono>
 #include <map>
+#include <string>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
@@ -72,6 +75,16 @@ enum class DbFileType {
     Any,
 };
 
+/// \brief Stored state of a file item, enough to detect changes during a rescan
+struct FileState {
+    int id;
+    int parentId;
+    unsigned int flags;
+    std::chrono::seconds mtime;
+    std::string upnpClass;
+    std::string mimeType;
+};
+
 class Database {
 public:
     explicit Database(std::shared_ptr<Config> config);
@@ -83,6 +96,12 @@ public:
 
     virtual void addObject(const std::shared_ptr<CdsObject>& object, int* changedContainer) = 0;
 
+    /// \brief Adds a batch of new objects in one transaction.
+    /// \param objects objects without id, the ids are set by the function
+    ///
+    /// Rows of metadata and resources are written with multi row inserts.
+    virtual void addObjects(const std::vector<std::shared_ptr<CdsObject>>& objects) = 0;
+
     /// \brief Adds a virtual container chain specified by path.
     /// \param parentContainerId the id of the parent container
     /// \param virtualPath container path separated by '/'
@@ -140,6 +159,12 @@ public:
     /// \return the obejectID
     virtual int findObjectIDByPath(const fs::path& fullpath, DbFileType fileType = DbFileType::Auto) = 0;
 
+    /// \brief Loads the state of all file items below a (pc directory) container
+    /// with a single query
+    /// \param containerId id of the container to start from
+    /// \return map of file location to stored state
+    virtual std::unordered_map<std::string, FileState> getFileStates(int containerId) = 0;
+
     /// \brief increments the updateIDs for the given objectIDs
     /// \param ids pointer to the array of ids
     /// \return a String for UPnP: a CSV list; for every existing object:
@@ -196,6 +221,12 @@ public:
     /* accounting methods */
     virtual long long getFileStats(const StatsParam& stats) = 0;
     virtual std::map<std::string, long long> getGroupStats(const StatsParam& stats) = 0;
+    /// \brief driver specific status values shown by the web ui, keyed by attribute name
+    virtual std::map<std::string, std::string> getStatus() { return {}; }
+    /// \brief run time statistics of the count statement shapes with the highest total time
+    virtual std::vector<std::map<std::string, std::string>> getQueryStats(std::size_t count) { return {}; }
+    /// \brief statements that took longer than the configured time with their plan
+    virtual std::vector<std::map<std::string, std::string>> getSlowQueries() { return {}; }
 
     /* internal setting methods */
     virtual std::string getInternalSetting(const std::string& key) = 0;
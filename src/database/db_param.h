@@ -26,6 +26,28 @@
 #ifndef __DB_PARAM_H__
 #define __DB_PARAM_H__
 
+/// \brief Position after the last row of a page, lets the following page seek to its first row instead of skipping all previous rows
+class PageCursor {
+protected:
+    /// \brief query without limit the position belongs to
+    std::string query;
+    /// \brief starting index of the following page
+    int nextIndex {};
+    /// \brief sort keys of the last row as SQL literals
+    std::vector<std::string> keys;
+
+public:
+    bool matches(const std::string& query, int startingIndex) const { return !keys.empty() && this->query == query && nextIndex == startingIndex; }
+    const std::vector<std::string>& getKeys() const { return keys; }
+
+    void setPosition(std::string query, int nextIndex, std::vector<std::string> keys)
+    {
+        this->query = std::move(query);
+        this->nextIndex = nextIndex;
+        this->keys = std::move(keys);
+    }
+};
+
 /// \brief Base class for actions performed based on UPnP requests
 class ActionParam {
 protected:
@@ -34,6 +56,7 @@ protected:
     int requestedCount {};
     std::string group;
     std::vector<std::string> forbiddenDirectories = {};
+    std::shared_ptr<PageCursor> cursor;
 
     // output parameters
     int totalMatches {};
@@ -71,6 +94,10 @@ public:
     const std::string& getGroup() const { return group; }
     void setGroup(const std::string& group) { this->group = group; }
 
+    /// \brief set cursor of previous page, it is updated to the end of the returned page
+    void setCursor(std::shared_ptr<PageCursor> cursor) { this->cursor = std::move(cursor); }
+    const std::shared_ptr<PageCursor>& getCursor() const { return cursor; }
+
     int getTotalMatches() const { return totalMatches; }
     void setTotalMatches(int totalMatches)
     {
@@ -116,6 +143,7 @@ protected:
     bool searchableContainers;
     bool searchContainers;
     bool searchItems;
+    int updateId { -1 };
 
 public:
     SearchParam(std::string containerID, std::string searchCriteria, const std::string& sortCriteria, int startingIndex,
@@ -135,6 +163,10 @@ public:
     bool getSearchableContainers() const { return searchableContainers; }
     bool getContainers() const { return searchContainers; }
     bool getItems() const { return searchItems; }
+
+    /// \brief set system update id the search is run for, cached results of older ids are dropped, -1 bypasses the cache
+    void setUpdateId(int updateId) { this->updateId = updateId; }
+    int getUpdateId() const { return updateId; }
 };
 
 class StatsParam {
@@ -24,6 +24,9 @@ CREATE TABLE `mt_cds_object` (
   `service_id` varchar(255) default NULL,
   `last_modified` bigint(20) unsigned default NULL,
   `last_updated` bigint(20) unsigned default '0',
+  `child_containers` int(11) NOT NULL default '0',
+  `child_items` int(11) NOT NULL default '0',
+  `sort_key` varchar(255) default NULL COLLATE utf8_bin,
   PRIMARY KEY  (`id`),
   KEY `cds_object_ref_id` (`ref_id`),
   KEY `cds_object_parent_id` (`parent_id`,`object_type`,`dc_title`),
@@ -31,6 +34,7 @@ CREATE TABLE `mt_cds_object` (
   KEY `location_parent` (`location_hash`,`parent_id`),
   KEY `cds_object_track_number` (`part_number`,`track_number`),
   KEY `cds_object_service_id` (`service_id`),
+  KEY `cds_object_sort_key` (`parent_id`,`sort_key`),
   CONSTRAINT `mt_cds_object_ibfk_1` FOREIGN KEY (`ref_id`) REFERENCES `mt_cds_object` (`id`) ON DELETE CASCADE ON UPDATE CASCADE,
   CONSTRAINT `mt_cds_object_ibfk_2` FOREIGN KEY (`parent_id`) REFERENCES `mt_cds_object` (`id`) ON DELETE CASCADE ON UPDATE CASCADE
 ) ENGINE=MyISAM CHARSET=utf8;
@@ -38,8 +42,8 @@ INSERT INTO `mt_cds_object` (
     `id`, `parent_id`, `object_type`, `flags`
 ) VALUES (-1,-1,0,9);
 INSERT INTO `mt_cds_object` (
-    `id`, `parent_id`, `object_type`, `upnp_class`, `dc_title`, `flags`
-) VALUES (0,-1,1,'object.container','Root',9);
+    `id`, `parent_id`, `object_type`, `upnp_class`, `dc_title`, `flags`, `child_containers`
+) VALUES (0,-1,1,'object.container','Root',9,1);
 UPDATE `mt_cds_object` SET `id`='0' WHERE `id`='1';
 INSERT INTO `mt_cds_object` (
     `id`,  `parent_id`, `object_type`, `upnp_class`, `dc_title`, `flags`
@@ -120,6 +124,17 @@ CREATE TABLE `grb_playstatus` (
   PRIMARY KEY (`group`, `item_id`),
   CONSTRAINT `grb_played_item` FOREIGN KEY (`item_id`) REFERENCES `mt_cds_object` (`id`) ON DELETE CASCADE ON UPDATE CASCADE
 ) ENGINE=MyISAM CHARSET=utf8;
+CREATE TABLE `grb_cds_ancestor` (
+  `ancestor_id` int(11) NOT NULL,
+  `object_id` int(11) NOT NULL,
+  PRIMARY KEY (`ancestor_id`, `object_id`),
+  KEY `grb_cds_ancestor_object_id` (`object_id`),
+  CONSTRAINT `grb_cds_ancestor_fk1` FOREIGN KEY (`ancestor_id`) REFERENCES `mt_cds_object` (`id`) ON DELETE CASCADE ON UPDATE CASCADE,
+  CONSTRAINT `grb_cds_ancestor_fk2` FOREIGN KEY (`object_id`) REFERENCES `mt_cds_object` (`id`) ON DELETE CASCADE ON UPDATE CASCADE
+) ENGINE=MyISAM CHARSET=utf8;
+INSERT INTO `grb_cds_ancestor` (
+  `ancestor_id`, `object_id`
+) VALUES (0, 1);
 INSERT INTO `mt_internal_setting` VALUES('resource_attribute', '');
 /*!40101 SET SQL_MODE=@OLD_SQL_MODE */;
 /*!40014 SET FOREIGN_KEY_CHECKS=@OLD_FOREIGN_KEY_CHECKS */;
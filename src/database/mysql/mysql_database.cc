@@ -40,11 +40,18 @@
 #include "util/thread_runner.h"
 #include "util/tools.h"
 
+#include <algorithm>
+#include <cstring>
+#include <errmsg.h>
+#include <mysqld_error.h>
 #include <netinet/in.h>
 
 #define MYSQL_SET_VERSION "INSERT INTO `mt_internal_setting` VALUES ('db_version','{}')"
 static constexpr auto mysqlUpdateVersion = std::string_view("UPDATE `mt_internal_setting` SET `value`='{}' WHERE `key`='db_version' AND `value`='{}'");
 static constexpr auto mysqlAddResourceAttr = std::string_view("ALTER TABLE `grb_cds_resource` ADD COLUMN `{}` varchar(255) default NULL");
+static constexpr auto mysqlAddPromotedMeta = std::string_view("ALTER TABLE `mt_cds_object` ADD COLUMN `{}` text default NULL");
+// metadata values have no length limit, the index only covers a prefix of the text column
+static constexpr auto mysqlAddPromotedIndex = std::string_view("ALTER TABLE `mt_cds_object` ADD KEY `cds_object_{0}` (`{0}`(255))");
 
 MySQLDatabase::MySQLDatabase(const std::shared_ptr<Config>& config, const std::shared_ptr<Mime>& mime, const std::shared_ptr<ConverterManager>& converterManager)
     : SQLDatabase(config, mime, converterManager)
@@ -53,21 +60,15 @@ MySQLDatabase::MySQLDatabase(const std::shared_ptr<Config>& config, const std::s
     table_quote_end = '`';
 
     // if mysql.sql or mysql-upgrade.xml is changed hashies have to be updated
-    hashies = { 684441550, // index 0 is used for create script mysql.sql = Version 1
+    hashies = { 214179814, // index 0 is used for create script mysql.sql = Version 1
         928913698, 1984244483, 2241152998, 1748460509, 2860006966, 974692115, 70310290, 1863649106, 4238128129, 2979337694, // upgrade 2-11
         1512596496, 507706380, 3545156190, 31528140, 372163748, 4097073836, 751952276, 3893982139, 798767550, 3731206823, // upgrade 12-21
-        3643149536, 4280737637 };
+        3643149536, 4280737637, 4093426247, 3347060818, 2989176963 };
 }
 
 MySQLDatabase::~MySQLDatabase()
 {
-    SqlAutoLock lock(sqlMutex); // just to ensure, that we don't close while another thread
-    // is executing a query
-
-    if (mysql_connection) {
-        mysql_close(&db);
-        mysql_connection = false;
-    }
+    closeConnections();
     log_debug("calling mysql_library_end ...");
     mysql_library_end();
     log_debug("...ok");
@@ -105,16 +106,36 @@ void MySQLDatabase::connect()
     mysql_library_init(0, nullptr, nullptr);
     pthread_setspecific(mysql_init_key, &mysql_init_val);
 
+    connectionCount = config->getIntOption(ConfigVal::SERVER_STORAGE_MYSQL_CONNECTIONS);
+
+    // escape connection is opened now to report configuration errors on startup, pool connections when they are needed
+    auto conn = std::make_unique<MySQLConnection>();
+    openConnection(conn.get());
+    // window functions are available since MySQL 8.0 and MariaDB 10.2
+    auto serverVersion = mysql_get_server_version(&conn->db);
+    windowFunctions = serverVersion >= 100200 || (serverVersion >= 80000 && serverVersion < 100000);
+    {
+        std::scoped_lock<std::mutex> lock(escape_mutex);
+        escapeConnection = std::move(conn);
+    }
+    {
+        std::scoped_lock<std::mutex> lock(pool_mutex);
+        mysql_connection = true;
+    }
+}
+
+void MySQLDatabase::openConnection(MySQLConnection* conn)
+{
     {
-        MYSQL* resMysql = mysql_init(&db);
+        MYSQL* resMysql = mysql_init(&conn->db);
         if (!resMysql) {
             throw_std_runtime_error("mysql_init() failed");
         }
 
-        mysql_options(&db, MYSQL_SET_CHARSET_NAME, "utf8mb4");
+        mysql_options(&conn->db, MYSQL_SET_CHARSET_NAME, "utf8mb4");
 
         bool myBoolVar = true;
-        mysql_options(&db, MYSQL_OPT_RECONNECT, &myBoolVar);
+        mysql_options(&conn->db, MYSQL_OPT_RECONNECT, &myBoolVar);
     }
 
     {
@@ -125,7 +146,7 @@ void MySQLDatabase::connect()
         std::string dbPass = config->getOption(ConfigVal::SERVER_STORAGE_MYSQL_PASSWORD);
         std::string dbSock = config->getOption(ConfigVal::SERVER_STORAGE_MYSQL_SOCKET);
 
-        MYSQL* resMysql = mysql_real_connect(&db,
+        MYSQL* resMysql = mysql_real_connect(&conn->db,
             dbHost.c_str(),
             dbUser.c_str(),
             (dbPass.empty() ? nullptr : dbPass.c_str()),
@@ -135,11 +156,84 @@ void MySQLDatabase::connect()
             0 // flags
         );
         if (!resMysql) {
-            throw_std_runtime_error("Connecting to database {}:{}/{} failed: {}", dbHost, dbPort, dbName, getError(&db));
+            std::string myError = getError(&conn->db);
+            mysql_close(&conn->db);
+            throw_std_runtime_error("Connecting to database {}:{}/{} failed: {}", dbHost, dbPort, dbName, myError);
         }
     }
+}
+
+void MySQLDatabase::closeConnections()
+{
+    std::unique_lock<std::mutex> lock(pool_mutex);
+    mysql_connection = false;
+    // wait for queries of other threads to finish
+    pool_cond.wait(lock, [this] { return std::none_of(connections.begin(), connections.end(), [](auto&& conn) { return conn->useCount > 0; }); });
+    for (auto&& conn : connections) {
+        clearStatementCache(conn.get());
+        mysql_close(&conn->db);
+    }
+    connections.clear();
+
+    std::scoped_lock<std::mutex> escapeLock(escape_mutex);
+    if (escapeConnection) {
+        mysql_close(&escapeConnection->db);
+        escapeConnection = nullptr;
+    }
+}
+
+MySQLConnection* MySQLDatabase::acquireConnection()
+{
+    auto self = std::this_thread::get_id();
+    std::unique_lock<std::mutex> lock(pool_mutex);
+    while (true) {
+        if (!mysql_connection)
+            throw_std_runtime_error("mysql connection is not open or already closed");
+
+        MySQLConnection* idle = nullptr;
+        for (auto&& conn : connections) {
+            // nested call or open transaction of this thread
+            if (conn->owner == self && (conn->useCount > 0 || conn->pinned)) {
+                conn->useCount++;
+                return conn.get();
+            }
+            if (conn->useCount == 0 && !conn->pinned && (!idle || conn->owner == self))
+                idle = conn.get();
+        }
+        if (idle) {
+            idle->owner = self;
+            idle->useCount = 1;
+            return idle;
+        }
+
+        if (connections.size() < connectionCount) {
+            auto conn = std::make_unique<MySQLConnection>();
+            conn->owner = self;
+            conn->useCount = 1;
+            auto result = conn.get();
+            connections.push_back(std::move(conn));
+            lock.unlock();
+            try {
+                openConnection(result);
+                log_debug("opened mysql connection {}", connections.size());
+            } catch (const std::runtime_error&) {
+                lock.lock();
+                connections.erase(std::find_if(connections.begin(), connections.end(), [result](auto&& c) { return c.get() == result; }));
+                pool_cond.notify_one();
+                throw;
+            }
+            return result;
+        }
+
+        pool_cond.wait(lock);
+    }
+}
 
-    mysql_connection = true;
+void MySQLDatabase::releaseConnection(MySQLConnection* conn)
+{
+    std::scoped_lock<std::mutex> lock(pool_mutex);
+    if (--conn->useCount == 0)
+        pool_cond.notify_all();
 }
 
 std::string MySQLDatabase::prepareDatabase()
@@ -159,15 +253,16 @@ std::string MySQLDatabase::prepareDatabase()
         auto&& myHash = stringHash(sql);
 
         if (myHash == hashies[0]) {
+            Connection conn(this);
             for (auto&& statement : splitString(sql, ';')) {
                 trimStringInPlace(statement);
                 if (statement.empty()) {
                     continue;
                 }
                 log_debug("executing statement: '{}'", statement);
-                int ret = mysql_real_query(&db, statement.c_str(), statement.size());
+                int ret = mysql_real_query(conn.db(), statement.c_str(), statement.size());
                 if (ret) {
-                    std::string myError = getError(&db);
+                    std::string myError = getError(conn.db());
                     throw DatabaseException(myError, fmt::format("Mysql: error while creating db: {}", myError));
                 }
             }
@@ -195,7 +290,8 @@ void MySQLDatabase::init()
 
     connect();
     auto dbVersion = prepareDatabase();
-    upgradeDatabase(std::stoul(dbVersion), hashies, ConfigVal::SERVER_STORAGE_MYSQL_UPGRADE_FILE, mysqlUpdateVersion, mysqlAddResourceAttr);
+    upgradeDatabase(std::stoul(dbVersion), hashies, ConfigVal::SERVER_STORAGE_MYSQL_UPGRADE_FILE, mysqlUpdateVersion, mysqlAddResourceAttr, mysqlAddPromotedMeta, mysqlAddPromotedIndex);
+    checkChildCounts();
     initDynContainers();
 
     lock.unlock();
@@ -215,9 +311,13 @@ std::string MySQLDatabase::quote(const std::string& value) const
      * the \0; then the string won't be null-terminated, but that doesn't matter,
      * because we give the correct length to std::string()
      */
+    std::scoped_lock<std::mutex> lock(escape_mutex);
+    if (!escapeConnection)
+        throw_std_runtime_error("mysql connection is not open or already closed");
+
     auto q = new char[value.length() * 2 + 2];
     *q = '\'';
-    auto size = mysql_real_escape_string(const_cast<MYSQL*>(&db), q + 1, value.c_str(), value.length());
+    auto size = mysql_real_escape_string(&escapeConnection->db, q + 1, value.c_str(), value.length());
     q[size + 1] = '\'';
     auto ret = std::string(q, size + 2);
     delete[] q;
@@ -237,24 +337,53 @@ MySQLDatabaseWithTransactions::MySQLDatabaseWithTransactions(const std::shared_p
 {
 }
 
+bool MySQLDatabaseWithTransactions::ownsTransaction()
+{
+    std::scoped_lock<std::mutex> lock(pool_mutex);
+    return transactionConnection && transactionConnection->owner == std::this_thread::get_id();
+}
+
+void MySQLDatabaseWithTransactions::releaseTransaction()
+{
+    std::scoped_lock<std::mutex> lock(pool_mutex);
+    if (transactionConnection) {
+        transactionConnection->pinned = false;
+        transactionConnection = nullptr;
+        pool_cond.notify_all();
+    }
+}
+
 void MySQLDatabaseWithTransactions::beginTransaction(std::string_view tName)
 {
-    log_debug("START TRANSACTION {} {}", tName, inTransaction);
+    log_debug("START TRANSACTION {} {}", tName, inTransaction.load());
     StdThreadRunner::waitFor(
         "MySqlDatabase", [this] { return !inTransaction; }, 100);
     inTransaction = true;
     log_debug("START TRANSACTION {}", tName);
-    SqlAutoLock lock(sqlMutex);
-    if (use_transaction)
+    if (use_transaction) {
+        checkMysqlThreadInit();
+        // statements of the transaction have to run on the same connection
+        Connection conn(this);
         _exec("START TRANSACTION");
+        std::scoped_lock<std::mutex> lock(pool_mutex);
+        conn.get()->pinned = true;
+        transactionConnection = conn.get();
+    }
 }
 
 void MySQLDatabaseWithTransactions::rollback(std::string_view tName)
 {
     log_debug("ROLLBACK {}", tName);
-    if (use_transaction && inTransaction && mysql_rollback(&db)) {
-        std::string myError = getError(&db);
-        throw DatabaseException(myError, fmt::format("Mysql: error while rolling back db: {}", myError));
+    if (use_transaction && inTransaction) {
+        if (!ownsTransaction())
+            return; // statement of another thread failed
+        Connection conn(this);
+        bool failed = mysql_rollback(conn.db());
+        std::string myError = failed ? getError(conn.db()) : "";
+        releaseTransaction();
+        inTransaction = false;
+        if (failed)
+            throw DatabaseException(myError, fmt::format("Mysql: error while rolling back db: {}", myError));
     }
     inTransaction = false;
 }
@@ -262,64 +391,190 @@ void MySQLDatabaseWithTransactions::rollback(std::string_view tName)
 void MySQLDatabaseWithTransactions::commit(std::string_view tName)
 {
     log_debug("COMMIT {}", tName);
-    SqlAutoLock lock(sqlMutex);
-    if (use_transaction && inTransaction && mysql_commit(&db)) {
-        std::string myError = getError(&db);
-        throw DatabaseException(myError, fmt::format("Mysql: error while committing db: {}", myError));
+    if (use_transaction && inTransaction && ownsTransaction()) {
+        Connection conn(this);
+        bool failed = mysql_commit(conn.db());
+        std::string myError = failed ? getError(conn.db()) : "";
+        releaseTransaction();
+        inTransaction = false;
+        if (failed)
+            throw DatabaseException(myError, fmt::format("Mysql: error while committing db: {}", myError));
     }
     inTransaction = false;
 }
 
 std::shared_ptr<SQLResult> MySQLDatabaseWithTransactions::select(const std::string& query)
 {
+    try {
+        return MySQLDatabase::select(query);
+    } catch (const std::runtime_error&) {
+        rollback("");
+        throw;
+    }
+}
+
+std::shared_ptr<SQLResult> MySQLDatabase::select(const std::string& query)
+{
+    QueryTimer timer(this, query);
     log_debug("{}", query);
 
     checkMysqlThreadInit();
-    SqlAutoLock lock(sqlMutex);
-    bool myTransaction = false;
-    if (!inTransaction) { // protect calls outside transactions
-        inTransaction = true;
-        myTransaction = true;
-    }
-    auto res = mysql_real_query(&db, query.c_str(), query.size());
+    Connection conn(this);
+    auto res = mysql_real_query(conn.db(), query.c_str(), query.size());
     if (res) {
-        std::string myError = getError(&db);
-        rollback("");
+        std::string myError = getError(conn.db());
         throw DatabaseException(myError, fmt::format("Mysql: mysql_real_query() failed: {}; query: {}", myError, query));
     }
 
-    MYSQL_RES* mysqlRes = mysql_store_result(&db);
-    if (!mysqlRes && mysql_field_count(&db)) {
-        std::string myError = getError(&db);
-        rollback("");
+    MYSQL_RES* mysqlRes = mysql_store_result(conn.db());
+    if (!mysqlRes && mysql_field_count(conn.db())) {
+        std::string myError = getError(conn.db());
         throw DatabaseException(myError, fmt::format("Mysql: mysql_store_result() failed: {}; query: {}", myError, query));
     }
-    if (myTransaction) {
-        inTransaction = false;
-    }
 
     return std::make_shared<MysqlResult>(mysqlRes);
 }
 
-std::shared_ptr<SQLResult> MySQLDatabase::select(const std::string& query)
+MYSQL_STMT* MySQLDatabase::getStatement(MySQLConnection* conn, const std::string& query)
 {
-    log_debug("{}", query);
+    auto stmt = conn->statementCache.get(query);
+    if (stmt)
+        return stmt;
+
+    stmt = mysql_stmt_init(&conn->db);
+    if (!stmt) {
+        std::string myError = getError(&conn->db);
+        throw DatabaseException(myError, fmt::format("Mysql: mysql_stmt_init() failed: {}; query: {}", myError, query));
+    }
+    if (mysql_stmt_prepare(stmt, query.c_str(), query.size())) {
+        auto myError = fmt::format("mysql_stmt_error ({}): \"{}\"", mysql_stmt_errno(stmt), mysql_stmt_error(stmt));
+        mysql_stmt_close(stmt);
+        throw DatabaseException(myError, fmt::format("Mysql: mysql_stmt_prepare() failed: {}; query: {}", myError, query));
+    }
+    conn->statementCache.put(query, stmt);
+    return stmt;
+}
 
-    checkMysqlThreadInit();
-    SqlAutoLock lock(sqlMutex);
-    auto res = mysql_real_query(&db, query.c_str(), query.size());
-    if (res) {
-        std::string myError = getError(&db);
-        throw DatabaseException(myError, fmt::format("Mysql: mysql_real_query() failed: {}; query: {}", myError, query));
+void MySQLDatabase::clearStatementCache(MySQLConnection* conn)
+{
+    conn->statementCache.clear();
+}
+
+/// \brief bind params, execute stmt and copy its rows, returns false on error
+static bool executeStatement(MYSQL_STMT* stmt, const std::vector<SQLParam>& params, std::vector<MysqlStmtResult::Row>& rows)
+{
+    std::vector<MYSQL_BIND> paramBinds(params.size());
+    for (std::size_t index = 0; index < params.size(); index++) {
+        auto&& param = params.at(index);
+        auto&& bind = paramBinds.at(index);
+        if (std::holds_alternative<long long>(param)) {
+            bind.buffer_type = MYSQL_TYPE_LONGLONG;
+            bind.buffer = const_cast<long long*>(&std::get<long long>(param));
+        } else if (std::holds_alternative<std::string>(param)) {
+            auto&& text = std::get<std::string>(param);
+            bind.buffer_type = MYSQL_TYPE_STRING;
+            bind.buffer = const_cast<char*>(text.data());
+            bind.buffer_length = text.size();
+        } else {
+            bind.buffer_type = MYSQL_TYPE_NULL;
+        }
+    }
+    if (!paramBinds.empty() && mysql_stmt_bind_param(stmt, paramBinds.data()))
+        return false;
+    if (mysql_stmt_execute(stmt))
+        return false;
+
+    MYSQL_RES* meta = mysql_stmt_result_metadata(stmt);
+    if (!meta)
+        return mysql_stmt_errno(stmt) == 0; // no result set
+
+    bool updateMaxLength = true;
+    mysql_stmt_attr_set(stmt, STMT_ATTR_UPDATE_MAX_LENGTH, &updateMaxLength);
+    if (mysql_stmt_store_result(stmt)) {
+        mysql_free_result(meta);
+        return false;
     }
 
-    MYSQL_RES* mysqlRes = mysql_store_result(&db);
-    if (!mysqlRes && mysql_field_count(&db)) {
-        std::string myError = getError(&db);
-        throw DatabaseException(myError, fmt::format("Mysql: mysql_store_result() failed: {}; query: {}", myError, query));
+    // columns are read as text like the results of mysql_real_query
+    using NullFlag = std::remove_pointer_t<decltype(MYSQL_BIND::is_null)>;
+    auto columns = mysql_num_fields(meta);
+    auto fields = mysql_fetch_fields(meta);
+    std::vector<MYSQL_BIND> resultBinds(columns);
+    std::vector<std::vector<char>> buffers(columns);
+    std::vector<unsigned long> lengths(columns);
+    auto nulls = std::make_unique<NullFlag[]>(columns);
+    for (unsigned int col = 0; col < columns; col++) {
+        buffers.at(col).resize(std::max<unsigned long>(fields[col].max_length, 32) + 1);
+        auto&& bind = resultBinds.at(col);
+        bind.buffer_type = MYSQL_TYPE_STRING;
+        bind.buffer = buffers.at(col).data();
+        bind.buffer_length = buffers.at(col).size();
+        bind.length = &lengths.at(col);
+        bind.is_null = &nulls[col];
     }
+    bool success = !mysql_stmt_bind_result(stmt, resultBinds.data());
+
+    int ret = MYSQL_NO_DATA;
+    while (success && ((ret = mysql_stmt_fetch(stmt)) == 0 || ret == MYSQL_DATA_TRUNCATED)) {
+        MysqlStmtResult::Row row(columns);
+        for (unsigned int col = 0; col < columns; col++) {
+            if (nulls[col])
+                continue;
+            if (lengths.at(col) < buffers.at(col).size()) {
+                row.at(col) = std::string(buffers.at(col).data(), lengths.at(col));
+                continue;
+            }
+            // value did not fit into the buffer
+            std::string value(lengths.at(col), '\0');
+            MYSQL_BIND bind {};
+            bind.buffer_type = MYSQL_TYPE_STRING;
+            bind.buffer = value.data();
+            bind.buffer_length = value.size();
+            if (mysql_stmt_fetch_column(stmt, &bind, col, 0)) {
+                success = false;
+                break;
+            }
+            row.at(col) = std::move(value);
+        }
+        rows.push_back(std::move(row));
+    }
+    if (success && ret != MYSQL_NO_DATA)
+        success = false;
 
-    return std::make_shared<MysqlResult>(mysqlRes);
+    mysql_stmt_free_result(stmt);
+    mysql_free_result(meta);
+    return success;
+}
+
+std::shared_ptr<SQLResult> MySQLDatabase::selectPrepared(const std::string& query, const std::vector<SQLParam>& params)
+{
+    QueryTimer timer(this, query, &params);
+    log_debug("{}", query);
+
+    checkMysqlThreadInit();
+    Connection conn(this);
+    for (int attempt = 0;; attempt++) {
+        auto stmt = getStatement(conn.get(), query);
+        if (mysql_stmt_param_count(stmt) != params.size())
+            throw DatabaseException(fmt::format("Wrong parameter count for statement: {}", query), LINE_MESSAGE);
+
+        std::vector<MysqlStmtResult::Row> rows;
+        if (executeStatement(stmt, params, rows))
+            return std::make_shared<MysqlStmtResult>(std::move(rows));
+
+        auto errNo = mysql_stmt_errno(stmt);
+        auto myError = fmt::format("mysql_stmt_error ({}): \"{}\"", errNo, mysql_stmt_error(stmt));
+        // statement is prepared again on the next call
+        conn.get()->statementCache.erase(query);
+
+        // statements are lost when the connection is reestablished or the table is altered
+        if (attempt == 0 && (errNo == CR_SERVER_LOST || errNo == CR_SERVER_GONE_ERROR || errNo == ER_UNKNOWN_STMT_HANDLER || errNo == ER_NEED_REPREPARE)) {
+            log_debug("preparing statement again after {}", myError);
+            continue;
+        }
+        rollback("");
+        throw DatabaseException(myError, fmt::format("Mysql: mysql_stmt_execute() failed: {}; query: {}", myError, query));
+    }
 }
 
 void MySQLDatabase::del(std::string_view tableName, const std::string& clause, const std::vector<int>& ids)
@@ -328,12 +583,13 @@ void MySQLDatabase::del(std::string_view tableName, const std::string& clause, c
         ? fmt::format("DELETE FROM {}", identifier(std::string(tableName))) //
         : fmt::format("DELETE FROM {} WHERE {}", identifier(std::string(tableName)), clause);
     log_debug("{}", query);
+    QueryTimer timer(this, query);
 
     checkMysqlThreadInit();
-    SqlAutoLock lock(sqlMutex);
-    auto res = mysql_real_query(&db, query.c_str(), query.size());
+    Connection conn(this);
+    auto res = mysql_real_query(conn.db(), query.c_str(), query.size());
     if (res) {
-        std::string myError = getError(&db);
+        std::string myError = getError(conn.db());
         rollback("");
         throw DatabaseException(myError, fmt::format("Mysql: mysql_real_query() failed: {}; query: {}", myError, query));
     }
@@ -341,13 +597,14 @@ void MySQLDatabase::del(std::string_view tableName, const std::string& clause, c
 
 void MySQLDatabase::exec(std::string_view tableName, const std::string& query, int objId)
 {
+    QueryTimer timer(this, query);
     log_debug("{}", query);
 
     checkMysqlThreadInit();
-    SqlAutoLock lock(sqlMutex);
-    auto res = mysql_real_query(&db, query.c_str(), query.size());
+    Connection conn(this);
+    auto res = mysql_real_query(conn.db(), query.c_str(), query.size());
     if (res) {
-        std::string myError = getError(&db);
+        std::string myError = getError(conn.db());
         rollback("");
         throw DatabaseException(myError, fmt::format("Mysql: mysql_real_query() failed: {}; query: {}", myError, query));
     }
@@ -355,31 +612,33 @@ void MySQLDatabase::exec(std::string_view tableName, const std::string& query, i
 
 int MySQLDatabase::exec(const std::string& query, bool getLastInsertId)
 {
+    QueryTimer timer(this, query);
     log_debug("{}", query);
 
     checkMysqlThreadInit();
-    SqlAutoLock lock(sqlMutex);
-    auto res = mysql_real_query(&db, query.c_str(), query.size());
+    Connection conn(this);
+    auto res = mysql_real_query(conn.db(), query.c_str(), query.size());
     if (res) {
-        std::string myError = getError(&db);
+        std::string myError = getError(conn.db());
         rollback("");
         throw DatabaseException(myError, fmt::format("Mysql: mysql_real_query() failed: {}; query: {}", myError, query));
     }
     int insertId = -1;
     if (getLastInsertId)
-        insertId = mysql_insert_id(&db);
+        insertId = mysql_insert_id(conn.db());
     return insertId;
 }
 
 void MySQLDatabase::execOnly(const std::string& query)
 {
+    QueryTimer timer(this, query);
     log_debug("{}", query);
 
     checkMysqlThreadInit();
-    SqlAutoLock lock(sqlMutex);
-    auto res = mysql_real_query(&db, query.c_str(), query.size());
+    Connection conn(this);
+    auto res = mysql_real_query(conn.db(), query.c_str(), query.size());
     if (res) {
-        std::string myError = getError(&db);
+        std::string myError = getError(conn.db());
         log_error("{}\n{}", myError, fmt::format("Mysql: mysql_real_query() failed: {}; query: {}", myError, query));
     }
 }
@@ -394,10 +653,25 @@ void MySQLDatabase::storeInternalSetting(const std::string& key, const std::stri
         INTERNAL_SETTINGS_TABLE, quote(key), quote(value)));
 }
 
+std::string MySQLDatabase::explain(const std::string& query, const std::vector<SQLParam>* params)
+{
+    // placeholders are only accepted by prepared statements
+    // the columns of the table format differ between MySQL and MariaDB, json is a single column in both
+    auto explainQuery = fmt::format("EXPLAIN FORMAT=JSON {}", query);
+    auto res = params ? selectPrepared(explainQuery, *params) : select(explainQuery);
+    std::vector<std::string> lines;
+    std::unique_ptr<SQLRow> row;
+    while (res && (row = res->nextRow())) {
+        lines.push_back(row->col(0));
+    }
+    return fmt::format("{}", fmt::join(lines, "\n"));
+}
+
 void MySQLDatabase::_exec(const std::string& query)
 {
-    if (mysql_real_query(&db, query.c_str(), query.size())) {
-        std::string myError = getError(&db);
+    Connection conn(this);
+    if (mysql_real_query(conn.db(), query.c_str(), query.size())) {
+        std::string myError = getError(conn.db());
         throw DatabaseException(myError, fmt::format("Mysql: error while updating db: {}; query: {}", myError, query));
     }
 }
@@ -424,7 +698,7 @@ MysqlResult::~MysqlResult()
 std::unique_ptr<SQLRow> MysqlResult::nextRow()
 {
     if (auto m = mysql_fetch_row(mysqlRes)) {
-        return std::make_unique<MysqlRow>(m);
+        return std::make_unique<MysqlRow>(m, mysql_fetch_lengths(mysqlRes));
     }
     nullRead = true;
     mysql_free_result(mysqlRes);
@@ -434,8 +708,9 @@ std::unique_ptr<SQLRow> MysqlResult::nextRow()
 
 /* MysqlRow */
 
-MysqlRow::MysqlRow(MYSQL_ROW mysqlRow)
+MysqlRow::MysqlRow(MYSQL_ROW mysqlRow, unsigned long* lengths)
     : mysqlRow(mysqlRow)
+    , lengths(lengths)
 {
 }
 
@@ -444,4 +719,44 @@ char* MysqlRow::col_c_str(int index) const
     return mysqlRow[index];
 }
 
+std::string_view MysqlRow::col_blob(int index) const
+{
+    if (!mysqlRow[index])
+        return {};
+    return { mysqlRow[index], lengths ? lengths[index] : std::strlen(mysqlRow[index]) };
+}
+
+/* MysqlStmtResult */
+
+MysqlStmtResult::MysqlStmtResult(std::vector<Row> rows)
+    : rows(std::move(rows))
+{
+}
+
+std::unique_ptr<SQLRow> MysqlStmtResult::nextRow()
+{
+    if (cur_row < rows.size())
+        return std::make_unique<MysqlStmtRow>(std::move(rows.at(cur_row++)));
+    return nullptr;
+}
+
+/* MysqlStmtRow */
+
+MysqlStmtRow::MysqlStmtRow(MysqlStmtResult::Row row)
+    : row(std::move(row))
+{
+}
+
+char* MysqlStmtRow::col_c_str(int index) const
+{
+    auto&& value = row.at(index);
+    return value ? value->data() : nullptr;
+}
+
+std::string_view MysqlStmtRow::col_blob(int index) const
+{
+    auto&& value = row.at(index);
+    return value ? std::string_view(*value) : std::string_view();
+}
+
 #endif // HAVE_MYSQL
@@ -37,12 +37,33 @@
 #define __MYSQL_DATABASE_H__
 
 #include "database/sql_database.h"
+#include "database/statement_cache.h"
 
 #include "config/config_val.h"
 
+#include <condition_variable>
+#include <mutex>
 #include <mysql.h>
+#include <optional>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
+#define MYSQL_STATEMENT_CACHE_MAX_SIZE 64 // close least recently used prepared statement of a connection, if cache grows beyond
+
+/// \brief Connection of the MySQL connection pool
+struct MySQLConnection {
+    MYSQL db {};
+    /// \brief thread that used the connection last, the thread gets it again if it is idle
+    std::thread::id owner;
+    /// \brief number of nested uses by the owner, 0 if idle
+    int useCount {};
+    /// \brief connection keeps an open transaction and is reserved for its owner
+    bool pinned {};
+    /// \brief server side prepared statements by query string
+    StatementCache<MYSQL_STMT*> statementCache { MYSQL_STATEMENT_CACHE_MAX_SIZE, [](MYSQL_STMT* stmt) { mysql_stmt_close(stmt); } };
+};
+
 /// \brief The Database class for using MySQL
 class MySQLDatabase : public SQLDatabase, public std::enable_shared_from_this<SQLDatabase> {
 public:
@@ -53,14 +74,42 @@ public:
     MySQLDatabase& operator=(const MySQLDatabase&) = delete;
 
 protected:
+    /// \brief Lease of a pool connection for the calling thread, returned to the pool on destruction
+    class Connection {
+    public:
+        explicit Connection(MySQLDatabase* mysql)
+            : mysql(mysql)
+            , conn(mysql->acquireConnection())
+        {
+        }
+        ~Connection() { mysql->releaseConnection(conn); }
+
+        Connection(const Connection&) = delete;
+        Connection& operator=(const Connection&) = delete;
+
+        MYSQL* db() const { return &conn->db; }
+        MySQLConnection* get() const { return conn; }
+
+    private:
+        MySQLDatabase* mysql;
+        MySQLConnection* conn;
+    };
+
     void _exec(const std::string& query) override;
     void checkMysqlThreadInit() const;
     void connect();
     std::string prepareDatabase();
 
+    /// \brief get an idle connection, preferably the last one used by this thread, waits if all are busy
+    MySQLConnection* acquireConnection();
+    void releaseConnection(MySQLConnection* conn);
+
     static std::string getError(MYSQL* db);
 
-    MYSQL db {};
+    std::shared_ptr<SQLResult> select(const std::string& query) override;
+
+    std::mutex pool_mutex;
+    std::condition_variable pool_cond;
 
 private:
     void init() override;
@@ -69,15 +118,33 @@ private:
 
     std::string quote(const std::string& value) const override;
 
-    std::shared_ptr<SQLResult> select(const std::string& query) override;
+    std::shared_ptr<SQLResult> selectPrepared(const std::string& query, const std::vector<SQLParam>& params) override;
+    std::string explain(const std::string& query, const std::vector<SQLParam>* params) override;
     void del(std::string_view tableName, const std::string& clause, const std::vector<int>& ids) override;
     void exec(std::string_view tableName, const std::string& query, int objId) override;
     int exec(const std::string& query, bool getLastInsertId = false) override;
     void execOnly(const std::string& query) override;
+    /// \brief mysql_insert_id reports the first row, MyISAM assigns consecutive ids to the rows of one insert under its table lock
+    int firstInsertId(int insertId, std::size_t) const override { return insertId; }
 
     void storeInternalSetting(const std::string& key, const std::string& value) override;
 
+    /// \brief get prepared statement for query from the cache of the connection or prepare it
+    MYSQL_STMT* getStatement(MySQLConnection* conn, const std::string& query);
+    /// \brief close all prepared statements of the connection
+    static void clearStatementCache(MySQLConnection* conn);
+    /// \brief open a connection of the pool
+    void openConnection(MySQLConnection* conn);
+    void closeConnections();
+
     bool mysql_connection {};
+    /// \brief connection outside of the pool, only used to escape strings with the connection charset
+    std::unique_ptr<MySQLConnection> escapeConnection;
+    mutable std::mutex escape_mutex;
+
+    /// \brief maximum number of connections, opened when they are needed first
+    std::size_t connectionCount { 1 };
+    std::vector<std::unique_ptr<MySQLConnection>> connections;
 
     void threadCleanup() override;
     bool threadCleanupRequired() const override { return true; }
@@ -94,8 +161,19 @@ public:
     void beginTransaction(std::string_view tName) override;
     void rollback(std::string_view tName) override;
     void commit(std::string_view tName) override;
+    /// \brief reads run on any pooled connection, the write transaction would serialize them
+    void beginReadTransaction(std::string_view tName) override { }
+    void commitReadTransaction(std::string_view tName) override { }
 
     std::shared_ptr<SQLResult> select(const std::string& query) override;
+
+private:
+    /// \brief true if the calling thread runs the open transaction
+    bool ownsTransaction();
+    /// \brief return the connection of the transaction to the pool
+    void releaseTransaction();
+    /// \brief connection of the open transaction, pinned to the thread that started it
+    MySQLConnection* transactionConnection {};
 };
 
 class MysqlResult : public SQLResult {
@@ -118,12 +196,43 @@ private:
 
 class MysqlRow : public SQLRow {
 public:
-    explicit MysqlRow(MYSQL_ROW mysqlRow);
+    MysqlRow(MYSQL_ROW mysqlRow, unsigned long* lengths);
+
+    std::string_view col_blob(int index) const override;
 
 private:
     char* col_c_str(int index) const override;
 
     MYSQL_ROW mysqlRow;
+    /// \brief byte length of the columns
+    unsigned long* lengths;
+};
+
+/// \brief Result of a prepared statement, the rows are copied so the statement can be reused immediately
+class MysqlStmtResult : public SQLResult {
+public:
+    /// \brief column values of a row, nullopt for NULL
+    using Row = std::vector<std::optional<std::string>>;
+    explicit MysqlStmtResult(std::vector<Row> rows);
+
+private:
+    std::unique_ptr<SQLRow> nextRow() override;
+    unsigned long long getNumRows() const override { return rows.size(); }
+
+    std::vector<Row> rows;
+    std::size_t cur_row {};
+};
+
+class MysqlStmtRow : public SQLRow {
+public:
+    explicit MysqlStmtRow(MysqlStmtResult::Row row);
+
+    std::string_view col_blob(int index) const override;
+
+private:
+    char* col_c_str(int index) const override;
+
+    mutable MysqlStmtResult::Row row;
 };
 
 #endif // __mysql_database_H__
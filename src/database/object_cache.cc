@@ -0,0 +1,169 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    object_cache.cc - this file is part of Gerbera.
+
+    Copyright (C) 2025 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file object_cache.cc
+
+#define GRB_LOG_FAC GrbLogFacility::sqldatabase
+#include "object_cache.h" // API
+
+#include "cds/cds_container.h"
+#include "cds/cds_item.h"
+#include "common.h"
+
+#include <algorithm>
+
+ObjectCache::ObjectCache(std::size_t capacity, std::size_t shardCount)
+    : shardCapacity(std::max<std::size_t>(1, capacity / std::max<std::size_t>(1, shardCount)))
+{
+    shards.reserve(std::max<std::size_t>(1, shardCount));
+    for (std::size_t i = 0; i < std::max<std::size_t>(1, shardCount); i++)
+        shards.push_back(std::make_unique<Shard>());
+}
+
+std::shared_ptr<CdsObject> ObjectCache::get(int objectId)
+{
+    auto& shard = getShard(objectId);
+    std::scoped_lock<std::mutex> lock(shard.mutex);
+    auto entry = shard.index.find(objectId);
+    if (entry == shard.index.end()) {
+        misses++;
+        return nullptr;
+    }
+    hits++;
+    shard.entries.splice(shard.entries.begin(), shard.entries, entry->second);
+    return copyObject(*entry->second);
+}
+
+void ObjectCache::put(const std::shared_ptr<CdsObject>& obj, std::size_t generation)
+{
+    auto objectId = obj->getID();
+    auto copy = copyObject(obj);
+    if (copy->isItem())
+        std::static_pointer_cast<CdsItem>(copy)->setPlayStatus(nullptr);
+
+    auto& shard = getShard(objectId);
+    std::scoped_lock<std::mutex> lock(shard.mutex);
+    // object may have been loaded before a change was written
+    if (generation != this->generation)
+        return;
+
+    auto entry = shard.index.find(objectId);
+    if (entry != shard.index.end()) {
+        removeReferrer((*entry->second)->getRefID(), objectId);
+        *entry->second = std::move(copy);
+        shard.entries.splice(shard.entries.begin(), shard.entries, entry->second);
+    } else {
+        shard.entries.push_front(std::move(copy));
+        shard.index[objectId] = shard.entries.begin();
+    }
+    addReferrer(obj->getRefID(), objectId);
+
+    while (shard.entries.size() > shardCapacity) {
+        auto&& last = shard.entries.back();
+        removeReferrer(last->getRefID(), last->getID());
+        shard.index.erase(last->getID());
+        shard.entries.pop_back();
+        evictions++;
+    }
+}
+
+void ObjectCache::erase(int objectId)
+{
+    generation++;
+    eraseEntry(objectId);
+
+    std::vector<int> refs;
+    {
+        std::scoped_lock<std::mutex> lock(ref_mutex);
+        auto [first, last] = referrers.equal_range(objectId);
+        for (auto it = first; it != last; ++it)
+            refs.push_back(it->second);
+        referrers.erase(first, last);
+    }
+    for (auto&& ref : refs)
+        eraseEntry(ref);
+}
+
+void ObjectCache::clear()
+{
+    generation++;
+    for (auto&& shard : shards) {
+        std::scoped_lock<std::mutex> lock(shard->mutex);
+        shard->index.clear();
+        shard->entries.clear();
+    }
+    std::scoped_lock<std::mutex> lock(ref_mutex);
+    referrers.clear();
+}
+
+std::size_t ObjectCache::size() const
+{
+    std::size_t result = 0;
+    for (auto&& shard : shards) {
+        std::scoped_lock<std::mutex> lock(shard->mutex);
+        result += shard->entries.size();
+    }
+    return result;
+}
+
+void ObjectCache::eraseEntry(int objectId)
+{
+    auto& shard = getShard(objectId);
+    std::scoped_lock<std::mutex> lock(shard.mutex);
+    auto entry = shard.index.find(objectId);
+    if (entry != shard.index.end()) {
+        removeReferrer((*entry->second)->getRefID(), objectId);
+        shard.entries.erase(entry->second);
+        shard.index.erase(entry);
+    }
+}
+
+void ObjectCache::addReferrer(int refId, int objectId)
+{
+    if (refId == CDS_ID_ROOT || refId == INVALID_OBJECT_ID)
+        return;
+    std::scoped_lock<std::mutex> lock(ref_mutex);
+    referrers.emplace(refId, objectId);
+}
+
+void ObjectCache::removeReferrer(int refId, int objectId)
+{
+    if (refId == CDS_ID_ROOT || refId == INVALID_OBJECT_ID)
+        return;
+    std::scoped_lock<std::mutex> lock(ref_mutex);
+    auto [first, last] = referrers.equal_range(refId);
+    auto it = std::find_if(first, last, [objectId](auto&& ref) { return ref.second == objectId; });
+    if (it != last)
+        referrers.erase(it);
+}
+
+std::shared_ptr<CdsObject> ObjectCache::copyObject(const std::shared_ptr<CdsObject>& obj)
+{
+    auto copy = CdsObject::createObject(obj->getObjectType());
+    obj->copyTo(copy);
+    // not part of copyTo as clones of the importer must not take them over
+    copy->setUTime(obj->getUTime());
+    if (obj->isContainer())
+        std::static_pointer_cast<CdsContainer>(copy)->setAutoscanType(std::static_pointer_cast<CdsContainer>(obj)->getAutoscanType());
+    return copy;
+}
@@ -0,0 +1,96 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    object_cache.h - this file is part of Gerbera.
+
+    Copyright (C) 2025 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file object_cache.h
+/// \brief Definition of the ObjectCache class.
+
+#ifndef __OBJECT_CACHE_H__
+#define __OBJECT_CACHE_H__
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+class CdsObject;
+
+#define OBJECT_CACHE_SHARDS 16 // number of independently locked parts of the object cache
+
+/// \brief Bounded LRU cache of objects loaded from the database
+///
+/// Objects are kept without the play status of a client group. The cache is split into shards
+/// by object id, each with its own lock and LRU order. Callers always get a copy they may change.
+class ObjectCache {
+public:
+    /// \param capacity maximum number of cached objects of all shards
+    /// \param shardCount number of shards
+    explicit ObjectCache(std::size_t capacity, std::size_t shardCount = OBJECT_CACHE_SHARDS);
+
+    /// \brief copy of the cached object, nullptr if it is not cached
+    std::shared_ptr<CdsObject> get(int objectId);
+    /// \brief store a copy of obj, skipped if the cache was changed since generation was read
+    void put(const std::shared_ptr<CdsObject>& obj, std::size_t generation);
+    /// \brief remove object and the objects that take their data from it
+    void erase(int objectId);
+    void clear();
+
+    /// \brief read before loading an object from the database to detect invalidation while loading
+    std::size_t getGeneration() const { return generation; }
+
+    std::size_t getHits() const { return hits; }
+    std::size_t getMisses() const { return misses; }
+    std::size_t getEvictions() const { return evictions; }
+    std::size_t size() const;
+
+private:
+    struct Shard {
+        mutable std::mutex mutex;
+        /// \brief most recently used object first
+        std::list<std::shared_ptr<CdsObject>> entries;
+        std::unordered_map<int, std::list<std::shared_ptr<CdsObject>>::iterator> index;
+    };
+
+    Shard& getShard(int objectId) const { return *shards.at(static_cast<unsigned int>(objectId) % shards.size()); }
+    /// \brief remove objectId from its shard
+    void eraseEntry(int objectId);
+    void addReferrer(int refId, int objectId);
+    void removeReferrer(int refId, int objectId);
+    static std::shared_ptr<CdsObject> copyObject(const std::shared_ptr<CdsObject>& obj);
+
+    std::size_t shardCapacity;
+    std::vector<std::unique_ptr<Shard>> shards;
+
+    /// \brief ids of cached objects by the id of the object they refer to
+    std::mutex ref_mutex;
+    std::unordered_multimap<int, int> referrers;
+
+    /// \brief increased by each invalidation
+    std::atomic<std::size_t> generation {};
+    std::atomic<std::size_t> hits {};
+    std::atomic<std::size_t> misses {};
+    std::atomic<std::size_t> evictions {};
+};
+
+#endif // __OBJECT_CACHE_H__
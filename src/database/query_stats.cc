@@ -0,0 +1,173 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    query_stats.cc - this file is part of Gerbera.
+
+    Copyright (C) 2025 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file query_stats.cc
+
+#define GRB_LOG_FAC GrbLogFacility::sqldatabase
+#include "query_stats.h" // API
+
+#include "util/grb_time.h"
+
+#include <algorithm>
+#include <cctype>
+
+using namespace std::chrono_literals;
+
+const std::array<std::chrono::microseconds, QUERY_STATS_BUCKETS - 1> QueryStats::bucketLimits { 100us, 1ms, 10ms, 100ms, 1s };
+
+QueryStats::QueryStats(std::chrono::milliseconds slowTime)
+    : slowTime(slowTime)
+{
+}
+
+static bool isIdentifierChar(char c)
+{
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+}
+
+/// \brief append placeholder to shape, lists of placeholders are reduced to one
+static void appendPlaceholder(std::string& shape)
+{
+    auto pos = shape.find_last_not_of(' ');
+    if (pos != std::string::npos && shape[pos] == ',') {
+        auto prev = shape.find_last_not_of(' ', pos - 1);
+        if (prev != std::string::npos && shape[prev] == '?') {
+            shape.erase(prev + 1);
+            return;
+        }
+    }
+    shape.push_back('?');
+}
+
+std::string QueryStats::normalize(std::string_view query)
+{
+    std::string shape;
+    shape.reserve(query.size());
+    for (std::size_t i = 0; i < query.size(); i++) {
+        char c = query[i];
+        if (c == '\'') {
+            // string literal, quotes are doubled or escaped by backslash
+            for (i++; i < query.size(); i++) {
+                if (query[i] == '\\') {
+                    i++;
+                } else if (query[i] == '\'') {
+                    if (i + 1 < query.size() && query[i + 1] == '\'')
+                        i++;
+                    else
+                        break;
+                }
+            }
+            appendPlaceholder(shape);
+        } else if (c == '"' || c == '`') {
+            // quoted identifier is part of the shape
+            auto end = query.find(c, i + 1);
+            if (end == std::string_view::npos)
+                end = query.size() - 1;
+            shape.append(query.substr(i, end - i + 1));
+            i = end;
+        } else if (std::isdigit(static_cast<unsigned char>(c)) && (shape.empty() || !isIdentifierChar(shape.back()))) {
+            while (i + 1 < query.size() && (std::isdigit(static_cast<unsigned char>(query[i + 1])) || query[i + 1] == '.'))
+                i++;
+            appendPlaceholder(shape);
+        } else if (std::isspace(static_cast<unsigned char>(c))) {
+            if (!shape.empty() && shape.back() != ' ')
+                shape.push_back(' ');
+        } else {
+            shape.push_back(c);
+        }
+    }
+    if (!shape.empty() && shape.back() == ' ')
+        shape.pop_back();
+    return shape;
+}
+
+std::string QueryStats::getVerb(std::string_view query)
+{
+    std::size_t pos = 0;
+    while (pos < query.size()) {
+        if (std::isspace(static_cast<unsigned char>(query[pos]))) {
+            pos++;
+        } else if (query.substr(pos, 2) == "--") {
+            pos = query.find('\n', pos);
+        } else if (query.substr(pos, 2) == "/*") {
+            pos = query.find("*/", pos + 2);
+            if (pos != std::string_view::npos)
+                pos += 2;
+        } else {
+            break;
+        }
+    }
+    std::string verb;
+    for (; pos < query.size() && std::isalpha(static_cast<unsigned char>(query[pos])); pos++)
+        verb.push_back(std::toupper(static_cast<unsigned char>(query[pos])));
+    return verb;
+}
+
+bool QueryStats::record(std::string_view query, std::chrono::microseconds duration)
+{
+    auto shape = normalize(query);
+    auto bucket = std::distance(bucketLimits.begin(), std::find_if(bucketLimits.begin(), bucketLimits.end(), [duration](auto limit) { return duration < limit; }));
+
+    std::scoped_lock<std::mutex> lock(mutex);
+    auto entry = shapes.find(shape);
+    if (entry == shapes.end()) {
+        if (shapes.size() >= QUERY_STATS_MAX_SHAPES)
+            return slowTime.count() > 0 && duration >= slowTime;
+        entry = shapes.emplace(shape, QueryShapeStats { shape }).first;
+    }
+    auto&& stats = entry->second;
+    stats.count++;
+    stats.total += duration;
+    stats.max = std::max(stats.max, duration);
+    stats.histogram.at(bucket)++;
+    return slowTime.count() > 0 && duration >= slowTime;
+}
+
+void QueryStats::addSlowQuery(std::string query, std::chrono::microseconds duration, std::string plan)
+{
+    std::scoped_lock<std::mutex> lock(mutex);
+    slowQueries.push_front(SlowQuery { currentTime(), duration, std::move(query), std::move(plan) });
+    if (slowQueries.size() > QUERY_STATS_SLOW_LOG_SIZE)
+        slowQueries.pop_back();
+}
+
+std::vector<QueryShapeStats> QueryStats::getTop(std::size_t count) const
+{
+    std::vector<QueryShapeStats> result;
+    {
+        std::scoped_lock<std::mutex> lock(mutex);
+        result.reserve(shapes.size());
+        for (auto&& [shape, stats] : shapes)
+            result.push_back(stats);
+    }
+    std::sort(result.begin(), result.end(), [](auto&& a, auto&& b) { return a.total > b.total; });
+    if (result.size() > count)
+        result.resize(count);
+    return result;
+}
+
+std::vector<SlowQuery> QueryStats::getSlowQueries() const
+{
+    std::scoped_lock<std::mutex> lock(mutex);
+    return { slowQueries.begin(), slowQueries.end() };
+}
@@ -0,0 +1,96 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    query_stats.h - this file is part of Gerbera.
+
+    Copyright (C) 2025 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file query_stats.h
+/// \brief Definition of the QueryStats class.
+
+#ifndef __QUERY_STATS_H__
+#define __QUERY_STATS_H__
+
+#include <array>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#define QUERY_STATS_MAX_SHAPES 500 // statements of new shapes are not counted beyond
+#define QUERY_STATS_SLOW_LOG_SIZE 50 // number of slow statements kept for the web ui
+#define QUERY_STATS_BUCKETS 6
+
+/// \brief Run time statistics of all statements with the same shape
+struct QueryShapeStats {
+    std::string shape;
+    std::size_t count {};
+    std::chrono::microseconds total {};
+    std::chrono::microseconds max {};
+    /// \brief number of runs by upper bound of QueryStats::bucketLimits
+    std::array<std::size_t, QUERY_STATS_BUCKETS> histogram {};
+};
+
+/// \brief Statement that took longer than the configured time
+struct SlowQuery {
+    std::chrono::seconds time;
+    std::chrono::microseconds duration;
+    std::string query;
+    std::string plan;
+};
+
+/// \brief Latency histograms of database statements by shape and log of slow statements
+///
+/// The shape of a statement is the statement with all literals replaced by ?,
+/// so statements only differing in ids or strings are counted together.
+class QueryStats {
+public:
+    /// \param slowTime statements running longer are slow, 0 disables the slow log
+    explicit QueryStats(std::chrono::milliseconds slowTime);
+
+    /// \brief replace literals in query by ? and collapse lists and whitespace
+    static std::string normalize(std::string_view query);
+    /// \brief first keyword of query in upper case, leading whitespace and comments are skipped
+    static std::string getVerb(std::string_view query);
+
+    /// \brief count run of query in the histogram of its shape
+    /// \return true if the statement is slow
+    bool record(std::string_view query, std::chrono::microseconds duration);
+    void addSlowQuery(std::string query, std::chrono::microseconds duration, std::string plan);
+
+    /// \brief shapes with the highest total run time first
+    std::vector<QueryShapeStats> getTop(std::size_t count) const;
+    /// \brief most recent slow statement first
+    std::vector<SlowQuery> getSlowQueries() const;
+
+    /// \brief upper bounds of the histogram buckets, the last bucket has no bound
+    static const std::array<std::chrono::microseconds, QUERY_STATS_BUCKETS - 1> bucketLimits;
+
+private:
+    std::chrono::microseconds slowTime;
+
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, QueryShapeStats> shapes;
+    std::deque<SlowQuery> slowQueries;
+};
+
+#endif // __QUERY_STATS_H__
@@ -0,0 +1,90 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    search_cache.cc - this file is part of Gerbera.
+
+    Copyright (C) 2025 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file search_cache.cc
+
+#define GRB_LOG_FAC GrbLogFacility::sqldatabase
+#include "search_cache.h" // API
+
+#include <algorithm>
+
+SearchCache::SearchCache(std::size_t capacity)
+    : capacity(std::max<std::size_t>(1, capacity))
+{
+}
+
+std::shared_ptr<const SearchCacheEntry> SearchCache::get(const std::string& key, int updateId)
+{
+    std::scoped_lock<std::mutex> lock(mutex);
+    if (updateId > this->updateId) {
+        // content directory changed
+        generation++;
+        entries.clear();
+        index.clear();
+        this->updateId = updateId;
+    }
+    auto entry = index.find(key);
+    if (updateId != this->updateId || entry == index.end()) {
+        misses++;
+        return nullptr;
+    }
+    hits++;
+    entries.splice(entries.begin(), entries, entry->second);
+    return entry->second->second;
+}
+
+void SearchCache::put(const std::string& key, int updateId, std::size_t generation, std::shared_ptr<const SearchCacheEntry> entry)
+{
+    std::scoped_lock<std::mutex> lock(mutex);
+    // result may have been read before a change was written
+    if (updateId != this->updateId || generation != this->generation)
+        return;
+
+    auto old = index.find(key);
+    if (old != index.end()) {
+        old->second->second = std::move(entry);
+        entries.splice(entries.begin(), entries, old->second);
+    } else {
+        entries.emplace_front(key, std::move(entry));
+        index[key] = entries.begin();
+    }
+
+    while (entries.size() > capacity) {
+        index.erase(entries.back().first);
+        entries.pop_back();
+    }
+}
+
+void SearchCache::clear()
+{
+    std::scoped_lock<std::mutex> lock(mutex);
+    generation++;
+    entries.clear();
+    index.clear();
+}
+
+std::size_t SearchCache::size() const
+{
+    std::scoped_lock<std::mutex> lock(mutex);
+    return entries.size();
+}
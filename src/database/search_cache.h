@@ -0,0 +1,89 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    search_cache.h - this file is part of Gerbera.
+
+    Copyright (C) 2025 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file search_cache.h
+/// \brief Definition of the SearchCache class.
+
+#ifndef __SEARCH_CACHE_H__
+#define __SEARCH_CACHE_H__
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#define SEARCH_CACHE_MAX_IDS 10000 // searches with more matches are not cached
+
+/// \brief Ordered result of a search
+struct SearchCacheEntry {
+    /// \brief ids of all matching objects in sort order
+    std::vector<int> ids;
+    int totalMatches {};
+    /// \brief search has more matches than SEARCH_CACHE_MAX_IDS, no ids are stored and the search runs uncached
+    bool tooLarge {};
+};
+
+/// \brief Bounded LRU cache of search results by search statement
+///
+/// Entries belong to the system update id they were read with. A search with a newer
+/// update id drops all entries. The database clears the cache when it writes objects,
+/// because the update id is only increased after the change is reported.
+class SearchCache {
+public:
+    /// \param capacity maximum number of cached searches
+    explicit SearchCache(std::size_t capacity);
+
+    /// \brief cached result of key, nullptr if it is not cached for updateId
+    std::shared_ptr<const SearchCacheEntry> get(const std::string& key, int updateId);
+    /// \brief store result of key, skipped if the cache was changed since generation was read
+    void put(const std::string& key, int updateId, std::size_t generation, std::shared_ptr<const SearchCacheEntry> entry);
+    void clear();
+
+    /// \brief read before running the search to detect invalidation while searching
+    std::size_t getGeneration() const { return generation; }
+
+    std::size_t getHits() const { return hits; }
+    std::size_t getMisses() const { return misses; }
+    std::size_t size() const;
+
+private:
+    using Entry = std::pair<std::string, std::shared_ptr<const SearchCacheEntry>>;
+
+    std::size_t capacity;
+    mutable std::mutex mutex;
+    /// \brief most recently used search first
+    std::list<Entry> entries;
+    std::unordered_map<std::string, std::list<Entry>::iterator> index;
+    /// \brief system update id of all entries
+    int updateId {};
+
+    /// \brief increased by each invalidation
+    std::atomic<std::size_t> generation {};
+    std::atomic<std::size_t> hits {};
+    std::atomic<std::size_t> misses {};
+};
+
+#endif // __SEARCH_CACHE_H__
@@ -545,11 +545,12 @@ std::string ASTOrOperator::emit() const
     return sqlEmitter.emit(this, lhs->emit(), rhs->emit());
 }
 
-DefaultSQLEmitter::DefaultSQLEmitter(std::shared_ptr<ColumnMapper> colMapper, std::shared_ptr<ColumnMapper> metaMapper, std::shared_ptr<ColumnMapper> resMapper, std::shared_ptr<ColumnMapper> plyMapper)
+DefaultSQLEmitter::DefaultSQLEmitter(std::shared_ptr<ColumnMapper> colMapper, std::shared_ptr<ColumnMapper> metaMapper, std::shared_ptr<ColumnMapper> resMapper, std::shared_ptr<ColumnMapper> plyMapper, std::shared_ptr<SearchIndex> searchIndex)
     : colMapper(std::move(colMapper))
     , metaMapper(std::move(metaMapper))
     , resMapper(std::move(resMapper))
     , plyMapper(std::move(plyMapper))
+    , searchIndex(std::move(searchIndex))
 {
 }
 
@@ -650,11 +651,34 @@ std::string DefaultSQLEmitter::emit(const ASTStringOperator* node, const std::st
     if (logicOperator.find(stringOperator) == logicOperator.end()) {
         throw SearchParseException(fmt::format("Operation '{}' not yet supported", stringOperator), LINE_MESSAGE);
     }
+    auto indexStatement = getIndexStatement(stringOperator, property, value);
+    if (!indexStatement.empty())
+        return indexStatement;
+
     auto [prpUpper, prpLower, prpType] = getPropertyStatement(property);
     auto clsUpper = std::get<0>(getPropertyStatement(UPNP_SEARCH_CLASS));
     return fmt::format(logicOperator.at(stringOperator), clsUpper, prpUpper, prpLower, value, prpType);
 }
 
+std::string DefaultSQLEmitter::getIndexStatement(const std::string& stringOperator, const std::string& property, const std::string& value) const
+{
+    if (!searchIndex || !colMapper || (stringOperator != "contains" && stringOperator != "startswith"))
+        return {};
+    if (std::find(searchIndex->properties.begin(), searchIndex->properties.end(), property) == searchIndex->properties.end())
+        return {};
+
+    auto pattern = fmt::format((stringOperator == "contains") ? "'%{}%'" : "'{}%'", value);
+    if (colMapper->hasEntry(property)) {
+        // title is searched in object table if search on filename is active
+        if (searchIndex->titleQuery.empty() || property != MetaEnumMapper::getMetaFieldName(MetadataFields::M_TITLE))
+            return {};
+        return fmt::format("({} IN ({}))", colMapper->mapQuoted(UPNP_SEARCH_ID), fmt::format(searchIndex->titleQuery, pattern));
+    }
+    if ((resMapper && resMapper->hasEntry(property)) || (plyMapper && plyMapper->hasEntry(property)) || searchIndex->metaQuery.empty())
+        return {};
+    return fmt::format("({} IN ({}))", colMapper->mapQuoted(UPNP_SEARCH_ID), fmt::format(searchIndex->metaQuery, property, pattern));
+}
+
 std::string DefaultSQLEmitter::emit(const ASTExistsOperator* node, const std::string& property, const std::string& value) const
 {
     std::string exists;
@@ -691,6 +715,11 @@ SortParser::SortParser(std::shared_ptr<ColumnMapper> colMapper, std::shared_ptr<
 }
 
 std::string SortParser::parse(std::string& addColumns, std::string& addJoin)
+{
+    return fmt::format("{}", fmt::join(parseList(addColumns, addJoin), ", "));
+}
+
+std::vector<std::string> SortParser::parseList(std::string& addColumns, std::string& addJoin)
 {
     if (sortCrit.empty() || !colMapper || !metaMapper)
         return {};
@@ -738,5 +767,5 @@ std::string SortParser::parse(std::string& addColumns, std::string& addJoin)
     }
     addColumns = fmt::format("{}", fmt::join(colBuf, ", "));
     addJoin = fmt::format("{}", fmt::join(joinBuf, " "));
-    return fmt::format("{}", fmt::join(sort, ", "));
+    return sort;
 }
@@ -352,12 +352,23 @@ struct SearchProperty {
     }
 };
 
+/// \brief Full text index that answers contains and startsWith on selected properties
+struct SearchIndex {
+    /// \brief properties with entries in the index
+    std::vector<std::string> properties;
+    /// \brief subquery returning ids of objects with matching metadata, format indexes: 0: property name, 1: like pattern
+    std::string metaQuery;
+    /// \brief subquery returning ids of objects with matching title column, format index 0: like pattern
+    std::string titleQuery;
+};
+
 class DefaultSQLEmitter : public SQLEmitter {
 public:
     DefaultSQLEmitter(std::shared_ptr<ColumnMapper> colMapper,
         std::shared_ptr<ColumnMapper> metaMapper,
         std::shared_ptr<ColumnMapper> resMapper,
-        std::shared_ptr<ColumnMapper> plyMapper);
+        std::shared_ptr<ColumnMapper> plyMapper,
+        std::shared_ptr<SearchIndex> searchIndex = nullptr);
 
     std::string emitSQL(const ASTNode* node) const override;
     std::string emit(const ASTAsterisk* node) const override { return {}; }
@@ -377,8 +388,11 @@ private:
     std::shared_ptr<ColumnMapper> metaMapper;
     std::shared_ptr<ColumnMapper> resMapper;
     std::shared_ptr<ColumnMapper> plyMapper;
+    std::shared_ptr<SearchIndex> searchIndex;
 
     std::tuple<std::string, std::string, FieldType> getPropertyStatement(const std::string& property) const;
+    /// \brief condition on search index, empty if property is not indexed
+    std::string getIndexStatement(const std::string& stringOperator, const std::string& property, const std::string& value) const;
 };
 
 class SearchParser {
@@ -503,6 +517,8 @@ class SortParser {
 public:
     SortParser(std::shared_ptr<ColumnMapper> colMapper, std::shared_ptr<ColumnMapper> plyMapper, std::shared_ptr<ColumnMapper> metaMapper, std::string sortCriteria);
     std::string parse(std::string& addColumns, std::string& addJoin);
+    /// \brief parse sort criteria into list of terms "column direction"
+    std::vector<std::string> parseList(std::string& addColumns, std::string& addJoin);
 
 private:
     std::shared_ptr<ColumnMapper> colMapper;
@@ -44,6 +44,9 @@
 #include "db_param.h"
 #include "exceptions.h"
 #include "metadata/metadata_enums.h"
+#include "object_cache.h"
+#include "query_stats.h"
+#include "search_cache.h"
 #include "search_handler.h"
 #include "upnp/clients.h"
 #include "upnp/xml_builder.h"
@@ -54,10 +57,12 @@
 #include "util/url_utils.h"
 
 #include <algorithm>
+#include <cctype>
 #include <fmt/chrono.h>
 #include <vector>
 
 #define MAX_REMOVE_SIZE 1000
+#define MAX_INSERT_ROWS 500 // rows per multi row insert
 #define MAX_REMOVE_RECURSION 500
 
 #define SQL_NULL "NULL"
@@ -103,7 +108,9 @@ enum class BrowseCol {
     RefAuxdata,
     RefMimeType,
     RefServiceId,
-    AsPersistent
+    AsPersistent,
+    SortKey, // only used for ordering, not selected
+    PromotedMeta, // index of first promoted metadata column
 };
 
 /// \brief search column ids
@@ -121,6 +128,8 @@ enum class SearchCol {
     Location,
     LastModified,
     LastUpdated,
+    SortKey, // only used for ordering, not selected
+    PromotedMeta, // index of first promoted metadata column
 };
 
 /// \brief meta column ids
@@ -330,12 +339,10 @@ static const std::vector<std::pair<std::string, PlaystatusCol>> playstatusTagMap
     { UPNP_SEARCH_LAST_PLAYED, PlaystatusCol::LastPlayed },
 };
 
-// Format string for a recursive query of a parent container
+// Format string for a query of all descendants of a container
 static constexpr auto sql_search_container_query_raw = R"(
--- Find all children of parent_id
-WITH {0} AS (SELECT * FROM {2} WHERE {4} = {{}}
-UNION
-SELECT {3}.* FROM {2} JOIN {0} AS {1} ON {3}.{4} = {1}.{5}
+-- Find all descendants of the container in the ancestor table
+WITH {0} AS (SELECT {3}.* FROM {2} JOIN {7} ON {8} = {3}.{5} WHERE {4} = {{}}
 ),
 -- Find all physical items and de-reference any virtual item (i.e. follow ref-id)
 items AS (SELECT * from {0} AS {1} WHERE {6} IS NULL
@@ -350,6 +357,7 @@ SELECT {{}} FROM items AS {3})";
 
 static std::shared_ptr<EnumColumnMapper<BrowseCol>> browseColumnMapper;
 static std::shared_ptr<EnumColumnMapper<SearchCol>> searchColumnMapper;
+static std::shared_ptr<EnumColumnMapper<SearchCol>> searchSortColumnMapper;
 static std::shared_ptr<EnumColumnMapper<MetadataCol>> metaColumnMapper;
 static std::shared_ptr<EnumColumnMapper<AutoscanCol>> asColumnMapper;
 static std::shared_ptr<EnumColumnMapper<AutoscanColumn>> autoscanColumnMapper;
@@ -374,7 +382,7 @@ void SQLDatabase::init()
         { MetaEnumMapper::getMetaFieldName(MetadataFields::M_PARTNUMBER), BrowseCol::PartNumber },
         { MetaEnumMapper::getMetaFieldName(MetadataFields::M_TRACKNUMBER), BrowseCol::PartNumber },
         { MetaEnumMapper::getMetaFieldName(MetadataFields::M_TRACKNUMBER), BrowseCol::TrackNumber },
-        { MetaEnumMapper::getMetaFieldName(MetadataFields::M_TITLE), BrowseCol::DcTitle },
+        { MetaEnumMapper::getMetaFieldName(MetadataFields::M_TITLE), BrowseCol::SortKey },
         { UPNP_SEARCH_CLASS, BrowseCol::UpnpClass },
         { UPNP_SEARCH_PATH, BrowseCol::Location },
         { UPNP_SEARCH_REFID, BrowseCol::RefId },
@@ -415,7 +423,7 @@ void SQLDatabase::init()
     /// \brief List of column names to be used in insert and update to ensure correct order of columns
     // only columns listed here are added to the insert and update statements
     tableColumnOrder = {
-        { CDS_OBJECT_TABLE, { "ref_id", "parent_id", "object_type", "upnp_class", "dc_title", "location", "location_hash", "auxdata", "update_id", "mime_type", "flags", "part_number", "track_number", "service_id", "last_modified", "last_updated" } },
+        { CDS_OBJECT_TABLE, { "ref_id", "parent_id", "object_type", "upnp_class", "dc_title", "location", "location_hash", "auxdata", "update_id", "mime_type", "flags", "part_number", "track_number", "service_id", "last_modified", "last_updated", "sort_key" } },
         { METADATA_TABLE, { "item_id", "property_name", "property_value" } },
         { RESOURCE_TABLE, { "item_id", "res_id", "handlerType", "purpose", "options", "parameters" } },
     };
@@ -426,12 +434,48 @@ void SQLDatabase::init()
         tableColumnOrder[RESOURCE_TABLE].push_back(std::move(attrName));
     }
 
-    browseColumnMapper = std::make_shared<EnumColumnMapper<BrowseCol>>(table_quote_begin, table_quote_end, ITM_ALIAS, CDS_OBJECT_TABLE, browseSortMap, browseColMap);
     auto searchTagMap = searchSortMap;
     if (config->getBoolOption(ConfigVal::UPNP_SEARCH_FILENAME)) {
         searchTagMap.emplace_back(MetaEnumMapper::getMetaFieldName(MetadataFields::M_TITLE), SearchCol::DcTitle);
     }
-    searchColumnMapper = std::make_shared<EnumColumnMapper<SearchCol>>(table_quote_begin, table_quote_end, SRC_ALIAS, CDS_OBJECT_TABLE, searchTagMap, searchColMap);
+
+    auto cacheSize = config->getIntOption(ConfigVal::SERVER_STORAGE_OBJECT_CACHE_SIZE);
+    if (cacheSize > 0)
+        objectCache = std::make_shared<ObjectCache>(cacheSize);
+    queryStats = std::make_shared<QueryStats>(std::chrono::milliseconds(config->getIntOption(ConfigVal::SERVER_STORAGE_SLOW_QUERY_TIME)));
+    auto searchCacheSize = config->getIntOption(ConfigVal::SERVER_STORAGE_SEARCH_CACHE_SIZE);
+    if (searchCacheSize > 0)
+        searchCache = std::make_shared<SearchCache>(searchCacheSize);
+
+    // promoted metadata is copied to columns of the object table
+    // multi valued fields only hold the first value and are only used for sorting
+    initPromotedMetadata();
+    sortArticles = config->getArrayOption(ConfigVal::SERVER_STORAGE_SORT_ARTICLES);
+    auto browseMapperColMap = browseColMap;
+    auto searchMapperColMap = searchColMap;
+    browseMapperColMap.emplace(BrowseCol::SortKey, SearchProperty { ITM_ALIAS, "sort_key" });
+    searchMapperColMap.emplace(SearchCol::SortKey, SearchProperty { SRC_ALIAS, "sort_key" });
+    // titles are sorted by the precomputed key
+    auto searchSortTagMap = searchSortMap;
+    searchSortTagMap.emplace_back(MetaEnumMapper::getMetaFieldName(MetadataFields::M_TITLE), SearchCol::SortKey);
+    std::size_t promotedIndex = 0;
+    for (auto&& [field, column] : promotedMetadata) {
+        auto browseCol = static_cast<BrowseCol>(to_underlying(BrowseCol::PromotedMeta) + promotedIndex);
+        auto searchCol = static_cast<SearchCol>(to_underlying(SearchCol::PromotedMeta) + promotedIndex);
+        browseSortMap.emplace_back(field, browseCol);
+        browseMapperColMap.emplace(browseCol, SearchProperty { ITM_ALIAS, column });
+        searchMapperColMap.emplace(searchCol, SearchProperty { SRC_ALIAS, column });
+        searchSortTagMap.emplace_back(field, searchCol);
+        auto single = mt_single.find(MetaEnumMapper::remapMetaDataField(field));
+        if (single != mt_single.end() && single->second)
+            searchTagMap.emplace_back(field, searchCol);
+        tableColumnOrder[CDS_OBJECT_TABLE].push_back(column);
+        promotedIndex++;
+    }
+
+    browseColumnMapper = std::make_shared<EnumColumnMapper<BrowseCol>>(table_quote_begin, table_quote_end, ITM_ALIAS, CDS_OBJECT_TABLE, browseSortMap, browseMapperColMap);
+    searchColumnMapper = std::make_shared<EnumColumnMapper<SearchCol>>(table_quote_begin, table_quote_end, SRC_ALIAS, CDS_OBJECT_TABLE, searchTagMap, searchMapperColMap);
+    searchSortColumnMapper = std::make_shared<EnumColumnMapper<SearchCol>>(table_quote_begin, table_quote_end, SRC_ALIAS, CDS_OBJECT_TABLE, searchSortTagMap, searchMapperColMap);
     metaColumnMapper = std::make_shared<EnumColumnMapper<MetadataCol>>(table_quote_begin, table_quote_end, MTA_ALIAS, METADATA_TABLE, metaTagMap, metaColMap);
     resourceColumnMapper = std::make_shared<EnumColumnMapper<int>>(table_quote_begin, table_quote_end, RES_ALIAS, RESOURCE_TABLE, resourceTagMap, resourceColMap);
     playstatusColumnMapper = std::make_shared<EnumColumnMapper<PlaystatusCol>>(table_quote_begin, table_quote_end, PLY_ALIAS, PLAYSTATUS_TABLE, playstatusTagMap, playstatusColMap);
@@ -467,7 +511,9 @@ void SQLDatabase::init()
         this->sql_search_query = fmt::format("{} {} {} {}", searchColumnMapper->tableQuoted(), join1, join2, join3);
 
         // Build container query format string
-        auto sql_container_query = fmt::format(sql_search_container_query_raw, identifier("containers"), identifier("cont"), searchColumnMapper->tableQuoted(), searchColumnMapper->getAlias(), searchColumnMapper->mapQuoted(UPNP_SEARCH_PARENTID, true), searchColumnMapper->mapQuoted(UPNP_SEARCH_ID, true), searchColumnMapper->mapQuoted(UPNP_SEARCH_REFID, true));
+        auto sql_container_query = fmt::format(sql_search_container_query_raw, identifier("containers"), identifier("cont"), searchColumnMapper->tableQuoted(), searchColumnMapper->getAlias(),
+            fmt::format("{}.{}", identifier(ANCESTOR_TABLE), identifier("ancestor_id")), searchColumnMapper->mapQuoted(UPNP_SEARCH_ID, true), searchColumnMapper->mapQuoted(UPNP_SEARCH_REFID, true),
+            identifier(ANCESTOR_TABLE), fmt::format("{}.{}", identifier(ANCESTOR_TABLE), identifier("object_id")));
         this->sql_search_container_query_format = fmt::format("{} {} {} {}", sql_container_query, join1, join2, join3);
     }
     // Statement for metadata
@@ -498,11 +544,50 @@ void SQLDatabase::init()
         }
         this->sql_resource_query = fmt::format("SELECT {} ", fmt::join(buf, ", "));
     }
+    // Prepared statements for single object lookups
+    {
+        this->sql_object_by_id_stmt = fmt::format("SELECT {} FROM {} WHERE {} = ?",
+            sql_browse_columns, sql_browse_query, browseColumnMapper->mapQuoted(BrowseCol::Id));
+        this->sql_object_by_service_id_stmt = fmt::format("SELECT {} FROM {} WHERE {} = ?",
+            sql_browse_columns, sql_browse_query, browseColumnMapper->mapQuoted(BrowseCol::ServiceId));
+        this->sql_object_by_location_stmt = fmt::format("SELECT {} FROM {} WHERE {} = ? AND {} = ? AND {} IS NULL LIMIT 1",
+            sql_browse_columns, sql_browse_query, browseColumnMapper->mapQuoted(BrowseCol::LocationHash), browseColumnMapper->mapQuoted(BrowseCol::Location), browseColumnMapper->mapQuoted(BrowseCol::RefId));
+        this->sql_meta_by_item_stmt = fmt::format("{} FROM {} WHERE {} = ?",
+            sql_meta_query, identifier(METADATA_TABLE), identifier("item_id"));
+        this->sql_resource_by_item_stmt = fmt::format("{} FROM {} WHERE {} = ? ORDER BY {}",
+            sql_resource_query, identifier(RESOURCE_TABLE), identifier("item_id"), identifier("res_id"));
+        auto fields = std::vector {
+            identifier("group"),
+            identifier("item_id"),
+            identifier("playCount"),
+            identifier("lastPlayed"),
+            identifier("lastPlayedPosition"),
+            identifier("bookMarkPos"),
+        };
+        this->sql_playstatus_query = fmt::format("SELECT {} FROM {}", fmt::join(fields, ", "), identifier(PLAYSTATUS_TABLE));
+        this->sql_playstatus_stmt = fmt::format("{} WHERE {} = ? AND {} = ?", sql_playstatus_query, identifier("group"), identifier("item_id"));
+    }
 
     sqlEmitter = std::make_shared<DefaultSQLEmitter>(searchColumnMapper, metaColumnMapper, resourceColumnMapper, playstatusColumnMapper);
 }
 
-void SQLDatabase::upgradeDatabase(unsigned int dbVersion, const std::array<unsigned int, DBVERSION>& hashies, ConfigVal upgradeOption, std::string_view updateVersionCommand, std::string_view addResourceColumnCmd)
+std::vector<std::string> SQLDatabase::getSearchIndexProperties()
+{
+    return {
+        MetaEnumMapper::getMetaFieldName(MetadataFields::M_TITLE),
+        MetaEnumMapper::getMetaFieldName(MetadataFields::M_ARTIST),
+        MetaEnumMapper::getMetaFieldName(MetadataFields::M_ALBUM),
+        MetaEnumMapper::getMetaFieldName(MetadataFields::M_GENRE),
+        MetaEnumMapper::getMetaFieldName(MetadataFields::M_CREATOR),
+    };
+}
+
+void SQLDatabase::setSearchIndex(std::shared_ptr<SearchIndex> searchIndex)
+{
+    sqlEmitter = std::make_shared<DefaultSQLEmitter>(searchColumnMapper, metaColumnMapper, resourceColumnMapper, playstatusColumnMapper, std::move(searchIndex));
+}
+
+void SQLDatabase::upgradeDatabase(unsigned int dbVersion, const std::array<unsigned int, DBVERSION>& hashies, ConfigVal upgradeOption, std::string_view updateVersionCommand, std::string_view addResourceColumnCmd, std::string_view addPromotedColumnCmd, std::string_view addPromotedIndexCmd)
 {
     /* --- load database upgrades from config file --- */
     const fs::path& upgradeFile = config->getOption(upgradeOption);
@@ -543,6 +628,7 @@ void SQLDatabase::upgradeDatabase(unsigned int dbVersion, const std::array<unsig
     static const std::map<std::string, bool (SQLDatabase::*)()> migActions {
         { "metadata", &SQLDatabase::doMetadataMigration },
         { "resources", &SQLDatabase::doResourceMigration },
+        { "ancestors", &SQLDatabase::doAncestorMigration },
     };
     this->addResourceColumnCmd = addResourceColumnCmd;
 
@@ -568,6 +654,8 @@ void SQLDatabase::upgradeDatabase(unsigned int dbVersion, const std::array<unsig
         throw DatabaseException(fmt::format("The database seems to be from another Gerbera version. Expected {}, actual {}", DBVERSION, dbVersion), LINE_MESSAGE);
 
     prepareResourceTable(addResourceColumnCmd);
+    preparePromotedColumns(addPromotedColumnCmd, addPromotedIndexCmd);
+    prepareSortKeys();
 }
 
 void SQLDatabase::shutdown()
@@ -689,6 +777,7 @@ std::vector<SQLDatabase::AddUpdateTable> SQLDatabase::_addUpdateObject(const std
     cdsObjectSql.emplace("dc_title", quote(obj->getTitle()));
     // else if (isUpdate)
     //     cdsObjectSql.emplace("dc_title", SQL_NULL);
+    cdsObjectSql.emplace("sort_key", quote(makeSortKey(obj->getTitle(), sortArticles)));
 
     if (op == Operation::Update)
         cdsObjectSql.emplace("auxdata", SQL_NULL);
@@ -769,6 +858,15 @@ std::vector<SQLDatabase::AddUpdateTable> SQLDatabase::_addUpdateObject(const std
 
     cdsObjectSql.emplace("parent_id", quote(parentID));
 
+    for (auto&& [field, column] : promotedMetadata) {
+        auto value = obj->getMetaData(field);
+        if (!value.empty()) {
+            cdsObjectSql.emplace(column, quote(value));
+        } else if (op == Operation::Update) {
+            cdsObjectSql.emplace(column, SQL_NULL);
+        }
+    }
+
     std::vector<AddUpdateTable> returnVal;
     // check for a duplicate (virtual) object
     if (hasReference && op != Operation::Update) {
@@ -817,6 +915,10 @@ void SQLDatabase::addObject(const std::shared_ptr<CdsObject>& obj, int* changedC
         if (addUpdateTable.getTableName() == CDS_OBJECT_TABLE) {
             int newId = exec(qb, true);
             obj->setID(newId);
+            ChildCounts change;
+            addChildCount(change, obj->getObjectType(), 1);
+            changeChildCounts({ { obj->getParentID(), change } });
+            addAncestors(newId, obj->getParentID());
         } else {
             exec(CDS_OBJECT_TABLE, qb, obj->getID());
         }
@@ -824,6 +926,80 @@ void SQLDatabase::addObject(const std::shared_ptr<CdsObject>& obj, int* changedC
     commit("addObject");
 }
 
+void SQLDatabase::addObjects(const std::vector<std::shared_ptr<CdsObject>>& objects)
+{
+    if (objects.empty())
+        return;
+
+    std::vector<std::vector<AddUpdateTable>> objectTables;
+    objectTables.reserve(objects.size());
+    for (auto&& obj : objects) {
+        if (obj->getID() != INVALID_OBJECT_ID)
+            throw DatabaseException("Tried to add an object with an object ID set", LINE_MESSAGE);
+        objectTables.push_back(_addUpdateObject(obj, Operation::Insert, nullptr));
+    }
+
+    auto toIdentifiers = [this](const std::vector<std::string>& fieldNames) {
+        std::vector<SQLIdentifier> fields;
+        fields.reserve(fieldNames.size());
+        std::transform(fieldNames.begin(), fieldNames.end(), std::back_inserter(fields), [this](auto&& name) { return identifier(name); });
+        return fields;
+    };
+
+    // object rows are grouped by column list, the ids of each group are assigned from its multi row insert
+    std::map<std::vector<std::string>, std::pair<std::vector<std::size_t>, std::vector<std::vector<std::string>>>> objectRows;
+    for (std::size_t i = 0; i < objects.size(); i++) {
+        for (auto&& addUpdateTable : objectTables.at(i)) {
+            if (addUpdateTable.getTableName() == CDS_OBJECT_TABLE) {
+                auto [fields, values] = rowForInsert(objects.at(i), addUpdateTable);
+                auto&& group = objectRows[std::move(fields)];
+                group.first.push_back(i);
+                group.second.push_back(std::move(values));
+            }
+        }
+    }
+
+    // dependent rows are collected by table and column list, resources have optional columns
+    std::map<std::pair<std::string, std::vector<std::string>>, std::vector<std::vector<std::string>>> rows;
+    std::map<int, ChildCounts> childCounts;
+    const auto ancestorFields = std::pair<std::string, std::vector<std::string>>(ANCESTOR_TABLE, { "ancestor_id", "object_id" });
+
+    beginTransaction("addObjects");
+    for (auto&& [fieldNames, group] : objectRows) {
+        auto ids = insertMultipleRowsGetIds(CDS_OBJECT_TABLE, toIdentifiers(fieldNames), group.second);
+        for (std::size_t i = 0; i < ids.size(); i++)
+            objects.at(group.first.at(i))->setID(ids.at(i));
+    }
+
+    std::vector<int> parentIds;
+    parentIds.reserve(objects.size());
+    std::transform(objects.begin(), objects.end(), std::back_inserter(parentIds), [](auto&& obj) { return obj->getParentID(); });
+    auto parentAncestors = getAncestors(parentIds);
+    for (std::size_t i = 0; i < objects.size(); i++) {
+        auto&& obj = objects.at(i);
+        addChildCount(childCounts[obj->getParentID()], obj->getObjectType(), 1);
+        if (obj->getParentID() >= CDS_ID_ROOT) {
+            const auto objectId = fmt::to_string(obj->getID());
+            rows[ancestorFields].push_back({ fmt::to_string(obj->getParentID()), objectId });
+            for (auto&& ancestorId : parentAncestors[obj->getParentID()])
+                rows[ancestorFields].push_back({ fmt::to_string(ancestorId), objectId });
+        }
+        for (auto&& addUpdateTable : objectTables.at(i)) {
+            if (addUpdateTable.getTableName() != CDS_OBJECT_TABLE) {
+                auto [fields, values] = rowForInsert(obj, addUpdateTable);
+                rows[{ addUpdateTable.getTableName(), std::move(fields) }].push_back(std::move(values));
+            }
+        }
+    }
+
+    for (auto&& [table, valuesets] : rows) {
+        insertMultipleRows(table.first, toIdentifiers(table.second), valuesets);
+    }
+    changeChildCounts(childCounts);
+    commit("addObjects");
+    log_debug("Added {} objects", objects.size());
+}
+
 void SQLDatabase::updateObject(const std::shared_ptr<CdsObject>& obj, int* changedContainer)
 {
     std::vector<AddUpdateTable> data;
@@ -831,6 +1007,7 @@ void SQLDatabase::updateObject(const std::shared_ptr<CdsObject>& obj, int* chang
         std::map<std::string, std::string> cdsObjectSql;
 
         cdsObjectSql["dc_title"] = quote(obj->getTitle());
+        cdsObjectSql["sort_key"] = quote(makeSortKey(obj->getTitle(), sortArticles));
         cdsObjectSql["upnp_class"] = quote(obj->getClass());
 
         data.emplace_back(CDS_OBJECT_TABLE, std::move(cdsObjectSql), Operation::Update);
@@ -841,6 +1018,19 @@ void SQLDatabase::updateObject(const std::shared_ptr<CdsObject>& obj, int* chang
     }
 
     beginTransaction("updateObject");
+    // keep child counts in sync if the object is moved to another container
+    int oldParentId = INVALID_OBJECT_ID;
+    int oldObjectType = 0;
+    if (obj->getID() != CDS_ID_FS_ROOT) {
+        auto res = selectPrepared(fmt::format("SELECT {}, {} FROM {} WHERE {} = ?",
+                                      identifier("parent_id"), identifier("object_type"), identifier(CDS_OBJECT_TABLE), identifier("id")),
+            { obj->getID() });
+        std::unique_ptr<SQLRow> row;
+        if (res && (row = res->nextRow())) {
+            oldParentId = row->col_int(0, INVALID_OBJECT_ID);
+            oldObjectType = row->col_int(1, 0);
+        }
+    }
     for (auto&& addUpdateTable : data) {
         Operation op = addUpdateTable.getOperation();
         auto qb = [this, &obj, op, &addUpdateTable]() {
@@ -866,29 +1056,24 @@ void SQLDatabase::updateObject(const std::shared_ptr<CdsObject>& obj, int* chang
             break;
         }
     }
+    if (oldParentId != INVALID_OBJECT_ID && (oldParentId != obj->getParentID() || oldObjectType != obj->getObjectType())) {
+        std::map<int, ChildCounts> childCounts;
+        addChildCount(childCounts[oldParentId], oldObjectType, -1);
+        addChildCount(childCounts[obj->getParentID()], obj->getObjectType(), 1);
+        changeChildCounts(childCounts);
+        if (oldParentId != obj->getParentID())
+            moveAncestors(obj->getID(), obj->getParentID());
+    }
     commit("updateObject");
+    if (objectCache)
+        objectCache->erase(obj->getID());
+    if (searchCache)
+        searchCache->clear();
 }
 
 std::shared_ptr<CdsObject> SQLDatabase::loadObject(int objectID)
 {
-    if (dynamicContainers.find(objectID) != dynamicContainers.end()) {
-        return dynamicContainers.at(objectID);
-    }
-
-    beginTransaction("loadObject");
-    auto loadSql = fmt::format("SELECT {} FROM {} WHERE {} = {}", sql_browse_columns, sql_browse_query, browseColumnMapper->mapQuoted(BrowseCol::Id), objectID);
-    auto res = select(loadSql);
-    if (res) {
-        auto row = res->nextRow();
-        if (row) {
-            auto result = createObjectFromRow(UNUSED_CLIENT_GROUP, row);
-            commit("loadObject");
-            return result;
-        }
-    }
-    log_debug("sql_query = {}", loadSql);
-    commit("loadObject");
-    throw ObjectNotFoundException(fmt::format("Object not found: {}", objectID));
+    return loadObject(UNUSED_CLIENT_GROUP, objectID);
 }
 
 std::shared_ptr<CdsObject> SQLDatabase::loadObject(const std::string& group, int objectID)
@@ -897,35 +1082,49 @@ std::shared_ptr<CdsObject> SQLDatabase::loadObject(const std::string& group, int
         return dynamicContainers.at(objectID);
     }
 
-    beginTransaction("loadObject");
-    auto loadSql = fmt::format("SELECT {} FROM {} WHERE {} = {}", sql_browse_columns, sql_browse_query, browseColumnMapper->mapQuoted(BrowseCol::Id), objectID);
-    auto res = select(loadSql);
+    if (objectCache) {
+        auto result = objectCache->get(objectID);
+        if (result) {
+            // play status is not cached as it is written without waiting
+            if (!group.empty() && result->isItem()) {
+                auto playStatus = getPlayStatus(group, objectID);
+                if (playStatus)
+                    std::static_pointer_cast<CdsItem>(result)->setPlayStatus(playStatus);
+            }
+            return result;
+        }
+    }
+    auto cacheGeneration = objectCache ? objectCache->getGeneration() : 0;
+
+    beginReadTransaction("loadObject");
+    auto res = selectPrepared(sql_object_by_id_stmt, { objectID });
     if (res) {
         auto row = res->nextRow();
         if (row) {
             auto result = createObjectFromRow(group, row);
-            commit("loadObject");
+            commitReadTransaction("loadObject");
+            if (objectCache)
+                objectCache->put(result, cacheGeneration);
             return result;
         }
     }
-    log_debug("sql_query = {}", loadSql);
-    commit("loadObject");
+    log_debug("sql_query = {} [{}]", sql_object_by_id_stmt, objectID);
+    commitReadTransaction("loadObject");
     throw ObjectNotFoundException(fmt::format("Object not found: {}", objectID));
 }
 
 std::shared_ptr<CdsObject> SQLDatabase::loadObjectByServiceID(const std::string& serviceID, const std::string& group)
 {
-    auto loadSql = fmt::format("SELECT {} FROM {} WHERE {} = {}", sql_browse_columns, sql_browse_query, browseColumnMapper->mapQuoted(BrowseCol::ServiceId), quote(serviceID));
-    beginTransaction("loadObjectByServiceID");
-    auto res = select(loadSql);
+    beginReadTransaction("loadObjectByServiceID");
+    auto res = selectPrepared(sql_object_by_service_id_stmt, { serviceID });
     if (res) {
         auto row = res->nextRow();
         if (row) {
-            commit("loadObjectByServiceID");
+            commitReadTransaction("loadObjectByServiceID");
             return createObjectFromRow(group, row);
         }
     }
-    commit("loadObjectByServiceID");
+    commitReadTransaction("loadObjectByServiceID");
 
     return {};
 }
@@ -947,9 +1146,9 @@ std::vector<int> SQLDatabase::getServiceObjectIDs(char servicePrefix)
         identifier("id"), identifier(CDS_OBJECT_TABLE),
         identifier("service_id"), quote(std::string(1, servicePrefix) + '%'));
 
-    beginTransaction("getServiceObjectIDs");
+    beginReadTransaction("getServiceObjectIDs");
     auto res = select(getSql);
-    commit("getServiceObjectIDs");
+    commitReadTransaction("getServiceObjectIDs");
     if (!res)
         throw DatabaseException(fmt::format("error selecting form {}", CDS_OBJECT_TABLE), LINE_MESSAGE);
 
@@ -999,6 +1198,7 @@ std::vector<std::shared_ptr<CdsObject>> SQLDatabase::browse(BrowseParam& param)
     }
 
     std::vector<std::string> where;
+    std::vector<std::string> orderTerms;
     std::string orderBy;
     std::string limit;
     std::string addColumns;
@@ -1022,15 +1222,16 @@ std::vector<std::shared_ptr<CdsObject>> SQLDatabase::browse(BrowseParam& param)
 
         // order by code..
         auto orderByCode = [&]() {
-            std::string orderQb;
+            std::vector<std::string> orderQb;
             if (param.getFlag(BROWSE_TRACK_SORT)) {
-                orderQb = fmt::format("{},{}", browseColumnMapper->mapQuoted(BrowseCol::PartNumber), browseColumnMapper->mapQuoted(BrowseCol::TrackNumber));
+                orderQb.push_back(fmt::format("{} ASC", browseColumnMapper->mapQuoted(BrowseCol::PartNumber)));
+                orderQb.push_back(fmt::format("{} ASC", browseColumnMapper->mapQuoted(BrowseCol::TrackNumber)));
             } else {
                 SortParser sortParser(browseColumnMapper, playstatusColumnMapper, metaColumnMapper, param.getSortCriteria());
-                orderQb = sortParser.parse(addColumns, addJoin);
+                orderQb = sortParser.parseList(addColumns, addJoin);
             }
             if (orderQb.empty()) {
-                orderQb = browseColumnMapper->mapQuoted(BrowseCol::DcTitle);
+                orderQb.push_back(fmt::format("{} ASC", browseColumnMapper->mapQuoted(BrowseCol::SortKey)));
             }
             return orderQb;
         };
@@ -1054,15 +1255,21 @@ std::vector<std::shared_ptr<CdsObject>> SQLDatabase::browse(BrowseParam& param)
             // Sorting by UpnpClass will avoid mixing different types of containers
             // "Special" containers like "All Songs" (which are of upnp_class 'object.container') will be displayed before
             // albums (which are of upnp_class 'object.container.album.musicAlbum')
-            orderBy = fmt::format(" ORDER BY {}, {}", browseColumnMapper->mapQuoted(BrowseCol::UpnpClass), orderByCode());
+            orderTerms.push_back(fmt::format("{} ASC", browseColumnMapper->mapQuoted(BrowseCol::UpnpClass)));
         } else if (!getContainers && getItems) {
             where.push_back(fmt::format("({0} & {1}) = {1}", browseColumnMapper->mapQuoted(BrowseCol::ObjectType), OBJECT_TYPE_ITEM));
-            orderBy = fmt::format(" ORDER BY {}", orderByCode());
         } else {
             // ORDER BY (object_type = OBJECT_TYPE_CONTAINER) ensures that containers are returned before items
             // Sorting by UpnpClass will avoid mixing different types of containers
-            orderBy = fmt::format(" ORDER BY ({} = {}) DESC, {}, {}", browseColumnMapper->mapQuoted(BrowseCol::ObjectType), OBJECT_TYPE_CONTAINER,
-                browseColumnMapper->mapQuoted(BrowseCol::UpnpClass), orderByCode());
+            orderTerms.push_back(fmt::format("({} = {}) DESC", browseColumnMapper->mapQuoted(BrowseCol::ObjectType), OBJECT_TYPE_CONTAINER));
+            orderTerms.push_back(fmt::format("{} ASC", browseColumnMapper->mapQuoted(BrowseCol::UpnpClass)));
+        }
+        if (getContainers || getItems) {
+            auto orderCode = orderByCode();
+            orderTerms.insert(orderTerms.end(), orderCode.begin(), orderCode.end());
+            // id makes the order unique, so pages neither overlap nor skip rows
+            orderTerms.push_back(fmt::format("{} ASC", browseColumnMapper->mapQuoted(BrowseCol::Id)));
+            orderBy = fmt::format(" ORDER BY {}", fmt::join(orderTerms, ", "));
         }
 
         limit = limitCode(param.getStartingIndex(), param.getRequestedCount());
@@ -1070,18 +1277,50 @@ std::vector<std::shared_ptr<CdsObject>> SQLDatabase::browse(BrowseParam& param)
         where.push_back(fmt::format("{} = {}", browseColumnMapper->mapQuoted(BrowseCol::Id), parent->getID()));
         limit = " LIMIT 1";
     }
-    auto qb = fmt::format("SELECT {} {} FROM {} {} WHERE {}{}{}", sql_browse_columns, addColumns, sql_browse_query, addJoin, fmt::join(where, " AND "), orderBy, limit);
+
+    // continue after last row of previous page instead of skipping rows with offset
+    const auto& cursor = param.getCursor();
+    std::string keyColumns;
+    std::string cursorQuery;
+    if (cursor && !orderTerms.empty()) {
+        keyColumns = getSortKeyColumns(orderTerms);
+        cursorQuery = fmt::format("{} WHERE {}{}", addJoin, fmt::join(where, " AND "), orderBy);
+        if (cursor->matches(cursorQuery, param.getStartingIndex())) {
+            where.push_back(getSeekCondition(orderTerms, cursor->getKeys()));
+            limit = param.getRequestedCount() > 0 ? fmt::format(" LIMIT {}", param.getRequestedCount()) : "";
+        }
+    }
+    auto qb = fmt::format("SELECT {}{} {} FROM {} {} WHERE {}{}{}", sql_browse_columns, keyColumns, addColumns, sql_browse_query, addJoin, fmt::join(where, " AND "), orderBy, limit);
     log_debug("QUERY: {}", qb);
-    beginTransaction("browse");
+    beginReadTransaction("browse");
     std::shared_ptr<SQLResult> sqlResult = select(qb);
-    commit("browse");
+    commitReadTransaction("browse");
 
-    std::vector<std::shared_ptr<CdsObject>> result;
-    std::vector<std::shared_ptr<CdsContainer>> containers;
-    result.reserve(sqlResult->getNumRows());
+    // read page first to load metadata and resources of all objects in one batch
+    std::vector<std::unique_ptr<SQLRow>> rows;
+    std::vector<int> objectIds;
+    std::vector<int> itemIds;
+    rows.reserve(sqlResult->getNumRows());
     std::unique_ptr<SQLRow> row;
     while ((row = sqlResult->nextRow())) {
-        auto obj = createObjectFromRow(param.getGroup(), row);
+        auto objectId = getColInt(row, BrowseCol::Id, INVALID_OBJECT_ID);
+        objectIds.push_back(objectId);
+        auto refId = getColInt(row, BrowseCol::RefId, CDS_ID_ROOT);
+        if (refId != CDS_ID_ROOT)
+            objectIds.push_back(refId);
+        if (!param.getGroup().empty() && (getColInt(row, BrowseCol::ObjectType, OBJECT_TYPE_CONTAINER) & OBJECT_TYPE_ITEM) != 0)
+            itemIds.push_back(objectId);
+        rows.push_back(std::move(row));
+    }
+    const auto details = retrieveObjectDetails(param.getGroup(), std::move(objectIds), itemIds);
+    if (!keyColumns.empty() && !rows.empty())
+        cursor->setPosition(cursorQuery, param.getStartingIndex() + static_cast<int>(rows.size()), getSortKeys(rows.back(), browseColMap.size(), orderTerms.size()));
+
+    std::vector<std::shared_ptr<CdsObject>> result;
+    std::vector<std::shared_ptr<CdsContainer>> containers;
+    result.reserve(rows.size());
+    for (auto&& objRow : rows) {
+        auto obj = createObjectFromRow(param.getGroup(), objRow, &details);
         if (obj->isContainer()) {
             containers.push_back(std::static_pointer_cast<CdsContainer>(obj));
         }
@@ -1207,35 +1446,59 @@ std::vector<std::shared_ptr<CdsObject>> SQLDatabase::search(SearchParam& param)
         // Use faster, non-recursive search for root container
         countSQL = fmt::format("SELECT COUNT(DISTINCT {}) FROM {} WHERE {}", searchColumnMapper->mapQuoted(UPNP_SEARCH_ID), sql_search_query, searchSQL);
     } else {
-        // Use recursive container search
+        // Search descendants of the container
         const std::string countSelect = fmt::format("COUNT(DISTINCT {})", searchColumnMapper->mapQuoted(UPNP_SEARCH_ID));
         countSQL = fmt::format(sql_search_container_query_format, param.getContainerID(), countSelect);
         countSQL += fmt::format(" WHERE {}", searchSQL);
     }
 
-    log_debug("Search count resolves to SQL [\n{}\n]", countSQL);
-    beginTransaction("search");
-    auto sqlResult = select(countSQL);
-    commit("search");
-
-    auto countRow = sqlResult->nextRow();
-    if (countRow) {
-        param.setTotalMatches(countRow->col_int(0, 0));
+    // repeated searches are served from the cached ids until the content directory changes
+    std::string cacheKey;
+    std::size_t cacheGeneration = 0;
+    std::shared_ptr<const SearchCacheEntry> cached;
+    bool useCache = searchCache && param.getUpdateId() >= 0;
+    if (useCache) {
+        cacheKey = fmt::format("{}\n{}\n{}\n{}", param.getGroup(), param.getContainerID(), param.getSortCriteria(), searchSQL);
+        cacheGeneration = searchCache->getGeneration();
+        cached = searchCache->get(cacheKey, param.getUpdateId());
+    }
+    // searches with too many matches are remembered, so their ids are not read again
+    bool tooLarge = cached && cached->tooLarge;
+    if (tooLarge)
+        cached = nullptr;
+
+    std::shared_ptr<SQLResult> sqlResult;
+    auto countMatches = [&]() {
+        log_debug("Search count resolves to SQL [\n{}\n]", countSQL);
+        beginReadTransaction("search");
+        sqlResult = select(countSQL);
+        commitReadTransaction("search");
+
+        auto countRow = sqlResult->nextRow();
+        if (countRow) {
+            param.setTotalMatches(countRow->col_int(0, 0));
+        }
+    };
+    if (cached) {
+        param.setTotalMatches(cached->totalMatches);
     }
 
     std::string addColumns;
     std::string addJoin;
     // order by code..
     auto orderByCode = [&]() {
-        SortParser sortParser(searchColumnMapper, playstatusColumnMapper, metaColumnMapper, param.getSortCriteria());
-        auto orderQb = sortParser.parse(addColumns, addJoin);
+        SortParser sortParser(searchSortColumnMapper, playstatusColumnMapper, metaColumnMapper, param.getSortCriteria());
+        auto orderQb = sortParser.parseList(addColumns, addJoin);
         if (orderQb.empty()) {
-            orderQb = searchColumnMapper->mapQuoted(SearchCol::DcTitle);
+            orderQb.push_back(fmt::format("{} ASC", searchColumnMapper->mapQuoted(SearchCol::SortKey)));
         }
+        // id makes the order unique, so pages neither overlap nor skip rows
+        orderQb.push_back(fmt::format("{} ASC", searchColumnMapper->mapQuoted(SearchCol::Id)));
         return orderQb;
     };
 
-    auto orderBy = fmt::format(" ORDER BY {}", orderByCode());
+    auto orderTerms = orderByCode();
+    auto orderBy = fmt::format(" ORDER BY {}", fmt::join(orderTerms, ", "));
 
     auto startingIndex = param.getStartingIndex();
     auto requestedCount = param.getRequestedCount();
@@ -1253,27 +1516,184 @@ std::vector<std::shared_ptr<CdsObject>> SQLDatabase::search(SearchParam& param)
     std::string limit = limitCode();
     log_vdebug("limitCode {}", limit);
 
-    std::string retrievalSQL;
-    if (rootContainer) {
-        // Use faster, non-recursive search for root container
-        retrievalSQL = fmt::format("SELECT DISTINCT {} {} FROM {} {} WHERE {}{}{}", sql_search_columns, addColumns, sql_search_query, addJoin, searchSQL, orderBy, limit);
+    // read all ids in sort order once to slice the following pages from the cache
+    // the ids are counted while reading them, one more row than the cache takes tells that the search is too large
+    if (useCache && !cached && !tooLarge) {
+        std::vector<std::string> sortColumns;
+        sortColumns.reserve(orderTerms.size());
+        for (auto&& term : orderTerms) {
+            sortColumns.push_back(term.substr(0, term.rfind(' ')));
+        }
+        // id is the last sort column
+        auto idSelect = fmt::format("DISTINCT {}", fmt::join(sortColumns, ", "));
+        std::string idSQL;
+        if (rootContainer) {
+            idSQL = fmt::format("SELECT {} FROM {} {} WHERE {}{} LIMIT {}", idSelect, sql_search_query, addJoin, searchSQL, orderBy, SEARCH_CACHE_MAX_IDS + 1);
+        } else {
+            idSQL = fmt::format(sql_search_container_query_format, param.getContainerID(), idSelect);
+            idSQL += fmt::format(" {} WHERE {}{} LIMIT {}", addJoin, searchSQL, orderBy, SEARCH_CACHE_MAX_IDS + 1);
+        }
+
+        log_debug("Search ids resolve to SQL [\n{}\n]", idSQL);
+        beginReadTransaction("search ids");
+        sqlResult = select(idSQL);
+        commitReadTransaction("search ids");
+
+        auto entry = std::make_shared<SearchCacheEntry>();
+        std::unordered_set<int> seen;
+        std::size_t idRows = 0;
+        std::unique_ptr<SQLRow> idRow;
+        while ((idRow = sqlResult->nextRow())) {
+            idRows++;
+            auto objectId = idRow->col_int(sortColumns.size() - 1, INVALID_OBJECT_ID);
+            // objects with several values of a sort key appear repeatedly
+            if (seen.insert(objectId).second)
+                entry->ids.push_back(objectId);
+        }
+        // larger searches are counted by the statement reading the page
+        if (idRows <= SEARCH_CACHE_MAX_IDS) {
+            entry->totalMatches = entry->ids.size();
+            param.setTotalMatches(entry->totalMatches);
+            searchCache->put(cacheKey, param.getUpdateId(), cacheGeneration, entry);
+            cached = std::move(entry);
+        } else {
+            entry->ids.clear();
+            entry->tooLarge = true;
+            searchCache->put(cacheKey, param.getUpdateId(), cacheGeneration, entry);
+        }
+    }
+
+    std::vector<std::unique_ptr<SQLRow>> rows;
+    const auto& cursor = param.getCursor();
+    std::string keyColumns;
+    std::string cursorQuery;
+    if (cached) {
+        // slice page from cached ids and load the rows by id
+        auto&& ids = cached->ids;
+        auto first = std::min<std::size_t>(std::max(startingIndex, 0), ids.size());
+        auto last = requestedCount > 0 ? std::min<std::size_t>(first + requestedCount, ids.size()) : ids.size();
+        std::vector<int> pageIds(ids.begin() + first, ids.begin() + last);
+        if (!pageIds.empty()) {
+            auto pageSQL = fmt::format("SELECT {} FROM {} WHERE {} IN ({})", sql_search_columns, searchColumnMapper->tableQuoted(), searchColumnMapper->mapQuoted(SearchCol::Id), fmt::join(pageIds, ","));
+            log_debug("Search page resolves to SQL [\n{}\n]", pageSQL);
+            beginReadTransaction("search page");
+            sqlResult = select(pageSQL);
+            commitReadTransaction("search page");
+
+            std::unordered_map<int, std::unique_ptr<SQLRow>> pageRows;
+            std::unique_ptr<SQLRow> pageRow;
+            while ((pageRow = sqlResult->nextRow())) {
+                auto objectId = getColInt(pageRow, SearchCol::Id, INVALID_OBJECT_ID);
+                pageRows[objectId] = std::move(pageRow);
+            }
+            // objects removed since the search was cached are skipped
+            rows.reserve(pageIds.size());
+            for (auto&& objectId : pageIds) {
+                auto pageEntry = pageRows.find(objectId);
+                if (pageEntry != pageRows.end())
+                    rows.push_back(std::move(pageEntry->second));
+            }
+        }
     } else {
-        // Use recursive container search
-        const std::string retrievalSelect = fmt::format("DISTINCT {} {}", sql_search_columns, addColumns);
-        retrievalSQL = fmt::format(sql_search_container_query_format, param.getContainerID(), retrievalSelect);
-        retrievalSQL += fmt::format(" {} WHERE {}{}{}", addJoin, searchSQL, orderBy, limit);
+        // continue after last row of previous page instead of skipping rows with offset
+        bool seek = false;
+        if (cursor) {
+            keyColumns = getSortKeyColumns(orderTerms);
+            cursorQuery = fmt::format("{} {} WHERE {}{}", param.getContainerID(), addJoin, searchSQL, orderBy);
+            if (cursor->matches(cursorQuery, startingIndex)) {
+                searchSQL = fmt::format("({}) AND {}", searchSQL, getSeekCondition(orderTerms, cursor->getKeys()));
+                limit = requestedCount > 0 ? fmt::format(" LIMIT {}", requestedCount) : "";
+                seek = true;
+            }
+        }
+
+        // count all matches in the statement reading the page, rows skipped by seeking would be missing in the count
+        bool windowCount = windowFunctions && !seek;
+        if (!windowCount)
+            countMatches();
+
+        std::string retrievalSQL;
+        std::size_t countColumn = 0;
+        if (windowCount) {
+            // window function is evaluated before DISTINCT, so the distinct rows are counted in the outer statement
+            // columns of the derived table need unique names, key columns directly follow the object columns
+            std::vector<std::string> innerColumns;
+            std::vector<std::string> sortColumns;
+            std::vector<std::string> outerOrder;
+            for (std::size_t i = 0; i < orderTerms.size(); i++) {
+                auto&& term = orderTerms.at(i);
+                auto column = term.substr(0, term.rfind(' '));
+                if (!keyColumns.empty())
+                    innerColumns.push_back(fmt::format("QUOTE({}) AS {}", column, identifier(fmt::format("key{}", i))));
+                auto sortColumn = identifier(fmt::format("sort{}", i));
+                sortColumns.push_back(fmt::format("{} AS {}", column, sortColumn));
+                outerOrder.push_back(fmt::format("{} {}", sortColumn, term.substr(term.rfind(' ') + 1)));
+            }
+            innerColumns.insert(innerColumns.end(), sortColumns.begin(), sortColumns.end());
+            // the first row of each object is marked, objects with several values of a sort key appear repeatedly
+            countColumn = searchColMap.size() + innerColumns.size() + 1;
+
+            std::string innerSQL;
+            auto innerSelect = fmt::format("DISTINCT {}, {}", sql_search_columns, fmt::join(innerColumns, ", "));
+            if (rootContainer) {
+                innerSQL = fmt::format("SELECT {} FROM {} {} WHERE {}", innerSelect, sql_search_query, addJoin, searchSQL);
+            } else {
+                innerSQL = fmt::format(sql_search_container_query_format, param.getContainerID(), innerSelect);
+                innerSQL += fmt::format(" {} WHERE {}", addJoin, searchSQL);
+            }
+            auto firstSQL = fmt::format("SELECT {0}.*, CASE WHEN ROW_NUMBER() OVER (PARTITION BY {0}.{1}) = 1 THEN 1 ELSE 0 END AS {2} FROM ({3}) AS {0}", identifier("matches"), identifier(searchColMap.at(SearchCol::Id).field), identifier("first"), innerSQL);
+            retrievalSQL = fmt::format("SELECT {0}.*, SUM({0}.{1}) OVER () FROM ({2}) AS {0} ORDER BY {3}{4}", identifier("page"), identifier("first"), firstSQL, fmt::join(outerOrder, ", "), limit);
+        } else if (rootContainer) {
+            // Use faster, non-recursive search for root container
+            retrievalSQL = fmt::format("SELECT DISTINCT {}{} {} FROM {} {} WHERE {}{}{}", sql_search_columns, keyColumns, addColumns, sql_search_query, addJoin, searchSQL, orderBy, limit);
+        } else {
+            // Search descendants of the container
+            const std::string retrievalSelect = fmt::format("DISTINCT {}{} {}", sql_search_columns, keyColumns, addColumns);
+            retrievalSQL = fmt::format(sql_search_container_query_format, param.getContainerID(), retrievalSelect);
+            retrievalSQL += fmt::format(" {} WHERE {}{}{}", addJoin, searchSQL, orderBy, limit);
+        }
+
+        log_debug("Search statement resolves to SQL [\n{}\n]", retrievalSQL);
+        beginReadTransaction("search 2");
+        sqlResult = select(retrievalSQL);
+        commitReadTransaction("search 2");
+
+        rows.reserve(sqlResult->getNumRows());
+        std::unique_ptr<SQLRow> row;
+        while ((row = sqlResult->nextRow())) {
+            rows.push_back(std::move(row));
+        }
+
+        if (windowCount) {
+            if (!rows.empty())
+                param.setTotalMatches(rows.front()->col_int(countColumn, 0));
+            else if (startingIndex > 0)
+                countMatches(); // page is behind the last match
+            else
+                param.setTotalMatches(0);
+        }
     }
 
-    log_debug("Search statement resolves to SQL [\n{}\n]", retrievalSQL);
-    beginTransaction("search 2");
-    sqlResult = select(retrievalSQL);
-    commit("search 2");
+    // read page first to load metadata and resources of all objects in one batch
+    std::vector<int> objectIds;
+    std::vector<int> itemIds;
+    for (auto&& row : rows) {
+        auto objectId = getColInt(row, SearchCol::Id, INVALID_OBJECT_ID);
+        objectIds.push_back(objectId);
+        auto refId = getColInt(row, SearchCol::RefId, CDS_ID_ROOT);
+        if (refId != CDS_ID_ROOT)
+            objectIds.push_back(refId);
+        if ((getColInt(row, SearchCol::ObjectType, OBJECT_TYPE_CONTAINER) & OBJECT_TYPE_ITEM) != 0)
+            itemIds.push_back(objectId);
+    }
+    const auto details = retrieveObjectDetails(param.getGroup(), std::move(objectIds), itemIds);
+    if (!keyColumns.empty() && !rows.empty())
+        cursor->setPosition(cursorQuery, startingIndex + static_cast<int>(rows.size()), getSortKeys(rows.back(), searchColMap.size(), orderTerms.size()));
 
     std::vector<std::shared_ptr<CdsObject>> result;
-    result.reserve(sqlResult->getNumRows());
-    std::unique_ptr<SQLRow> row;
-    while ((row = sqlResult->nextRow())) {
-        result.push_back(createObjectFromSearchRow(param.getGroup(), row));
+    result.reserve(rows.size());
+    for (auto&& objRow : rows) {
+        result.push_back(createObjectFromSearchRow(param.getGroup(), objRow, &details));
     }
 
     if (static_cast<long long>(result.size()) < requestedCount) {
@@ -1283,30 +1703,80 @@ std::vector<std::shared_ptr<CdsObject>> SQLDatabase::search(SearchParam& param)
     return result;
 }
 
+std::string SQLDatabase::getSortKeyColumns(const std::vector<std::string>& orderTerms)
+{
+    std::vector<std::string> columns;
+    columns.reserve(orderTerms.size());
+    for (auto&& term : orderTerms) {
+        columns.push_back(fmt::format(", QUOTE({})", term.substr(0, term.rfind(' '))));
+    }
+    return fmt::format("{}", fmt::join(columns, ""));
+}
+
+std::string SQLDatabase::getSeekCondition(const std::vector<std::string>& orderTerms, const std::vector<std::string>& keys)
+{
+    if (keys.size() != orderTerms.size())
+        throw DatabaseException(fmt::format("Cursor has {} keys for {} sort columns", keys.size(), orderTerms.size()), LINE_MESSAGE);
+
+    // rows after (k1, k2, ..) are (c1 > k1) OR (c1 = k1 AND c2 > k2) OR ..
+    // NULL sorts first in ascending order
+    std::vector<std::string> equal;
+    std::vector<std::string> after;
+    for (std::size_t i = 0; i < orderTerms.size(); i++) {
+        auto pos = orderTerms[i].rfind(' ');
+        auto column = orderTerms[i].substr(0, pos);
+        bool desc = orderTerms[i].substr(pos + 1) == "DESC";
+        auto&& key = keys[i];
+
+        std::string greater;
+        if (key == "NULL") {
+            if (!desc)
+                greater = fmt::format("{} IS NOT NULL", column);
+        } else if (desc) {
+            greater = fmt::format("({0} < {1} OR {0} IS NULL)", column, key);
+        } else {
+            greater = fmt::format("{} > {}", column, key);
+        }
+        if (!greater.empty()) {
+            auto condition = equal;
+            condition.push_back(std::move(greater));
+            after.push_back(fmt::format("({})", fmt::join(condition, " AND ")));
+        }
+        equal.push_back(key == "NULL" ? fmt::format("{} IS NULL", column) : fmt::format("{} = {}", column, key));
+    }
+    if (after.empty())
+        return "0 = 1";
+    return fmt::format("({})", fmt::join(after, " OR "));
+}
+
+std::vector<std::string> SQLDatabase::getSortKeys(const std::unique_ptr<SQLRow>& row, std::size_t index, std::size_t count)
+{
+    std::vector<std::string> keys;
+    keys.reserve(count);
+    for (std::size_t i = 0; i < count; i++) {
+        keys.push_back(row->col(index + i));
+    }
+    return keys;
+}
+
 int SQLDatabase::getChildCount(int contId, bool containers, bool items, bool hideFsRoot)
 {
     if (!containers && !items)
         return 0;
 
-    auto where = std::vector {
-        fmt::format("{} = {}", identifier("parent_id"), contId)
-    };
-    if (containers && !items)
-        where.push_back(fmt::format("{} = {}", identifier("object_type"), OBJECT_TYPE_CONTAINER));
-    else if (items && !containers)
-        where.push_back(fmt::format("({0} & {1}) = {1}", identifier("object_type"), OBJECT_TYPE_ITEM));
-    if (contId == CDS_ID_ROOT && hideFsRoot) {
-        where.push_back(fmt::format("{} != {:d}", identifier("id"), CDS_ID_FS_ROOT));
-    }
-
-    beginTransaction("getChildCount");
-    auto res = select(fmt::format("SELECT COUNT(*) FROM {} WHERE {}", identifier(CDS_OBJECT_TABLE), fmt::join(where, " AND ")));
-    commit("getChildCount");
+    beginReadTransaction("getChildCount");
+    auto res = selectPrepared(fmt::format("SELECT {}, {} FROM {} WHERE {} = ?",
+                                  identifier("child_containers"), identifier("child_items"), identifier(CDS_OBJECT_TABLE), identifier("id")),
+        { contId });
+    commitReadTransaction("getChildCount");
 
     if (res) {
         auto row = res->nextRow();
         if (row) {
-            return row->col_int(0, 0);
+            int childContainers = row->col_int(0, 0);
+            if (contId == CDS_ID_ROOT && hideFsRoot)
+                childContainers = std::max(childContainers - 1, 0);
+            return (containers ? childContainers : 0) + (items ? row->col_int(1, 0) : 0);
         }
     }
     return 0;
@@ -1321,37 +1791,178 @@ std::map<int, int> SQLDatabase::getChildCounts(const std::vector<int>& contId, b
     if (contId.empty())
         return result;
 
-    auto where = std::vector {
-        fmt::format("{} IN ({})", identifier("parent_id"), fmt::join(contId, ","))
-    };
-    if (containers && !items)
-        where.push_back(fmt::format("{} = {}", identifier("object_type"), OBJECT_TYPE_CONTAINER));
-    else if (items && !containers)
-        where.push_back(fmt::format("({0} & {1}) = {1}", identifier("object_type"), OBJECT_TYPE_ITEM));
-    if (hideFsRoot && std::find(contId.begin(), contId.end(), CDS_ID_ROOT) != contId.end()) {
-        where.push_back(fmt::format("{} != {:d}", identifier("id"), CDS_ID_FS_ROOT));
+    beginReadTransaction("getChildCounts");
+    auto res = select(fmt::format("SELECT {0}, {1}, {2} FROM {3} WHERE {0} IN ({4}) ORDER BY {0}",
+        identifier("id"), identifier("child_containers"), identifier("child_items"), identifier(CDS_OBJECT_TABLE), fmt::join(contId, ",")));
+    commitReadTransaction("getChildCounts");
+
+    if (res) {
+        std::unique_ptr<SQLRow> row;
+        while ((row = res->nextRow())) {
+            const int id = row->col_int(0, INVALID_OBJECT_ID);
+            int childContainers = row->col_int(1, 0);
+            if (id == CDS_ID_ROOT && hideFsRoot)
+                childContainers = std::max(childContainers - 1, 0);
+            const int count = (containers ? childContainers : 0) + (items ? row->col_int(2, 0) : 0);
+            if (count > 0)
+                result.emplace_hint(result.end(), id, count);
+        }
     }
+    return result;
+}
 
-    beginTransaction("getChildCounts");
-    auto res = select(fmt::format("SELECT {0}, COUNT(*) FROM {1} WHERE {2} GROUP BY {0} ORDER BY {0}",
-        identifier("parent_id"), identifier(CDS_OBJECT_TABLE), fmt::join(where, " AND ")));
-    commit("getChildCounts");
+void SQLDatabase::addChildCount(ChildCounts& counts, int objectType, int count)
+{
+    if (objectType == OBJECT_TYPE_CONTAINER)
+        counts.containers += count;
+    else if ((objectType & OBJECT_TYPE_ITEM) == OBJECT_TYPE_ITEM)
+        counts.items += count;
+}
 
+void SQLDatabase::updateChildCounts(const std::set<int>& parentIds)
+{
+    if (parentIds.empty())
+        return;
+    // the grouped derived table is materialized, so MySQL accepts it in an update of the same table
+    auto counts = fmt::format("(SELECT {0}, SUM({1} = {2}) AS {3}, SUM(({1} & {4}) = {4}) AS {5} FROM {6} WHERE {0} IN ({7}) GROUP BY {0})",
+        identifier("parent_id"), identifier("object_type"), OBJECT_TYPE_CONTAINER, identifier("containers"), OBJECT_TYPE_ITEM, identifier("items"),
+        identifier(CDS_OBJECT_TABLE), fmt::join(parentIds, ","));
+    exec(fmt::format("UPDATE {0} SET {1} = COALESCE((SELECT {2} FROM {3} {4} WHERE {4}.{5} = {0}.{6}), 0), {7} = COALESCE((SELECT {8} FROM {3} {4} WHERE {4}.{5} = {0}.{6}), 0) WHERE {6} IN ({9})",
+        identifier(CDS_OBJECT_TABLE), identifier("child_containers"), identifier("containers"), counts, identifier("c"), identifier("parent_id"), identifier("id"),
+        identifier("child_items"), identifier("items"), fmt::join(parentIds, ",")));
+    // cached containers hold the old counts
+    if (objectCache) {
+        for (auto&& parentId : parentIds)
+            objectCache->erase(parentId);
+    }
+    // the system update id is increased later, cached searches must not miss new or removed objects meanwhile
+    if (searchCache)
+        searchCache->clear();
+}
+
+void SQLDatabase::changeChildCounts(const std::map<int, ChildCounts>& changes)
+{
+    // parents with the same change are updated together
+    std::map<std::pair<int, int>, std::vector<int>> parentsByChange;
+    for (auto&& [parentId, change] : changes) {
+        if (change.containers != 0 || change.items != 0)
+            parentsByChange[{ change.containers, change.items }].push_back(parentId);
+    }
+    for (auto&& [change, parentIds] : parentsByChange) {
+        exec(fmt::format("UPDATE {0} SET {1} = {1} + ({2}), {3} = {3} + ({4}) WHERE {5} IN ({6})",
+            identifier(CDS_OBJECT_TABLE), identifier("child_containers"), change.first, identifier("child_items"), change.second, identifier("id"), fmt::join(parentIds, ",")));
+    }
+    // cached containers hold the old counts
+    if (objectCache) {
+        for (auto&& [parentId, change] : changes)
+            objectCache->erase(parentId);
+    }
+    // the system update id is increased later, cached searches must not miss new or removed objects meanwhile
+    if (searchCache)
+        searchCache->clear();
+}
+
+void SQLDatabase::checkChildCounts()
+{
+    log_debug("Checking child counts of containers");
+    beginTransaction("checkChildCounts");
+    auto res = select(fmt::format("SELECT {0}, {1}, COUNT(*) FROM {2} GROUP BY {0}, {1}",
+        identifier("parent_id"), identifier("object_type"), identifier(CDS_OBJECT_TABLE)));
+    if (!res) {
+        rollback("checkChildCounts");
+        throw DatabaseException(fmt::format("error selecting form {}", CDS_OBJECT_TABLE), LINE_MESSAGE);
+    }
+    std::map<int, ChildCounts> counts;
+    std::unique_ptr<SQLRow> row;
+    while ((row = res->nextRow())) {
+        addChildCount(counts[row->col_int(0, INVALID_OBJECT_ID)], row->col_int(1, 0), row->col_int(2, 0));
+    }
+
+    res = select(fmt::format("SELECT {0}, {1}, {2} FROM {3} WHERE {4} = {5}",
+        identifier("id"), identifier("child_containers"), identifier("child_items"), identifier(CDS_OBJECT_TABLE), identifier("object_type"), OBJECT_TYPE_CONTAINER));
+    if (!res) {
+        rollback("checkChildCounts");
+        throw DatabaseException(fmt::format("error selecting form {}", CDS_OBJECT_TABLE), LINE_MESSAGE);
+    }
+    std::set<int> wrongCounts;
+    while ((row = res->nextRow())) {
+        const int id = row->col_int(0, INVALID_OBJECT_ID);
+        auto it = counts.find(id);
+        auto expected = (it != counts.end()) ? it->second : ChildCounts();
+        if (expected.containers != row->col_int(1, 0) || expected.items != row->col_int(2, 0))
+            wrongCounts.insert(id);
+    }
+    updateChildCounts(wrongCounts);
+    commit("checkChildCounts");
+
+    if (!wrongCounts.empty())
+        log_info("Corrected child counts of {} containers", wrongCounts.size());
+}
+
+std::map<int, std::vector<int>> SQLDatabase::getAncestors(const std::vector<int>& objectIds)
+{
+    std::map<int, std::vector<int>> result;
+    if (objectIds.empty())
+        return result;
+
+    auto res = select(fmt::format("SELECT {0}, {1} FROM {2} WHERE {0} IN ({3})",
+        identifier("object_id"), identifier("ancestor_id"), identifier(ANCESTOR_TABLE), fmt::join(objectIds, ",")));
     if (res) {
         std::unique_ptr<SQLRow> row;
         while ((row = res->nextRow())) {
-            result.emplace_hint(result.end(), row->col_int(0, INVALID_OBJECT_ID), row->col_int(1, 0));
+            result[row->col_int(0, INVALID_OBJECT_ID)].push_back(row->col_int(1, INVALID_OBJECT_ID));
         }
     }
     return result;
 }
 
+void SQLDatabase::addAncestors(int objectId, int parentId)
+{
+    if (parentId < CDS_ID_ROOT)
+        return;
+
+    exec(fmt::format("INSERT INTO {0} ({1}, {2}) SELECT {1}, {3} FROM {0} WHERE {2} = {4} UNION ALL SELECT {4}, {3}",
+        identifier(ANCESTOR_TABLE), identifier("ancestor_id"), identifier("object_id"), objectId, parentId));
+}
+
+void SQLDatabase::moveAncestors(int objectId, int parentId)
+{
+    std::vector<int> subtree { objectId };
+    auto res = select(fmt::format("SELECT {0} FROM {1} WHERE {2} = {3}",
+        identifier("object_id"), identifier(ANCESTOR_TABLE), identifier("ancestor_id"), objectId));
+    if (res) {
+        std::unique_ptr<SQLRow> row;
+        while ((row = res->nextRow())) {
+            subtree.push_back(row->col_int(0, INVALID_OBJECT_ID));
+        }
+    }
+
+    // descendants keep the rows of the moved object
+    auto oldAncestors = getAncestors({ objectId })[objectId];
+    if (!oldAncestors.empty()) {
+        del(ANCESTOR_TABLE, fmt::format("{} IN ({}) AND {} IN ({})", identifier("object_id"), fmt::join(subtree, ","), identifier("ancestor_id"), fmt::join(oldAncestors, ",")), {});
+    }
+
+    if (parentId < CDS_ID_ROOT)
+        return;
+    auto newAncestors = getAncestors({ parentId })[parentId];
+    newAncestors.push_back(parentId);
+    std::vector<std::vector<std::string>> valuesets;
+    valuesets.reserve(newAncestors.size() * subtree.size());
+    for (auto&& ancestorId : newAncestors) {
+        for (auto&& id : subtree) {
+            valuesets.push_back({ fmt::to_string(ancestorId), fmt::to_string(id) });
+        }
+    }
+    insertMultipleRows(ANCESTOR_TABLE, { identifier("ancestor_id"), identifier("object_id") }, valuesets);
+}
+
 std::vector<std::string> SQLDatabase::getMimeTypes()
 {
-    beginTransaction("getMimeTypes");
+    beginReadTransaction("getMimeTypes");
     auto res = select(fmt::format("SELECT DISTINCT {0} FROM {1} WHERE {0} IS NOT NULL ORDER BY {0}",
         identifier("mime_type"), identifier(CDS_OBJECT_TABLE)));
-    commit("getMimeTypes");
+    commitReadTransaction("getMimeTypes");
 
     if (!res)
         throw DatabaseException(fmt::format("error selecting form {}", CDS_OBJECT_TABLE), LINE_MESSAGE);
@@ -1404,29 +2015,24 @@ std::shared_ptr<CdsObject> SQLDatabase::findObjectByPath(const fs::path& fullpat
             return addLocationPrefix(LOC_DIR_PREFIX, fullpath);
         }();
 
-        auto where = std::vector {
-            fmt::format("{} = {}", browseColumnMapper->mapQuoted(BrowseCol::LocationHash), quote(stringHash(dbLocation))),
-            fmt::format("{} = {}", browseColumnMapper->mapQuoted(BrowseCol::Location), quote(dbLocation)),
-            fmt::format("{} IS NULL", browseColumnMapper->mapQuoted(BrowseCol::RefId)),
-        };
-        auto findSql = fmt::format("SELECT {} FROM {} WHERE {} LIMIT 1", sql_browse_columns, sql_browse_query, fmt::join(where, " AND "));
+        auto locationHash = static_cast<long long>(stringHash(dbLocation));
 
-        beginTransaction("findObjectByPath");
-        auto res = select(findSql);
-        log_debug("{} -> res={} ({})", findSql, !!res, res ? res->getNumRows() : -1);
+        beginReadTransaction("findObjectByPath");
+        auto res = selectPrepared(sql_object_by_location_stmt, { locationHash, dbLocation });
+        log_debug("{} [{}, {}] -> res={} ({})", sql_object_by_location_stmt, locationHash, dbLocation, !!res, res ? res->getNumRows() : -1);
         if (!res) {
-            commit("findObjectByPath");
-            throw DatabaseException(fmt::format("error while doing select: {}", findSql), LINE_MESSAGE);
+            commitReadTransaction("findObjectByPath");
+            throw DatabaseException(fmt::format("error while doing select: {} [{}]", sql_object_by_location_stmt, dbLocation), LINE_MESSAGE);
         }
         auto row = res->nextRow();
         if (row) {
             auto result = createObjectFromRow(group, row);
-            commit("findObjectByPath");
+            commitReadTransaction("findObjectByPath");
             return result;
         }
     }
 
-    commit("findObjectByPath");
+    commitReadTransaction("findObjectByPath");
     return nullptr;
 }
 
@@ -1438,6 +2044,35 @@ int SQLDatabase::findObjectIDByPath(const fs::path& fullpath, DbFileType fileTyp
     return obj->getID();
 }
 
+std::unordered_map<std::string, FileState> SQLDatabase::getFileStates(int containerId)
+{
+    // all descendants of the container are found in the ancestor table
+    auto sql = fmt::format("SELECT {0}id{1}, {0}parent_id{1}, {0}location{1}, {0}last_modified{1}, {0}upnp_class{1}, {0}mime_type{1}, {0}flags{1} FROM {0}{2}{1} JOIN {0}{3}{1} ON {0}object_id{1} = {0}id{1} WHERE {0}ancestor_id{1} = {4} AND {0}object_type{1} != {5} AND {0}ref_id{1} IS NULL",
+        table_quote_begin, table_quote_end, CDS_OBJECT_TABLE, ANCESTOR_TABLE, containerId, OBJECT_TYPE_CONTAINER);
+    auto res = select(sql);
+    if (!res)
+        throw DatabaseException(fmt::format("error while doing select: {}", sql), LINE_MESSAGE);
+
+    std::unordered_map<std::string, FileState> result;
+    std::unique_ptr<SQLRow> row;
+    while ((row = res->nextRow())) {
+        auto [location, prefix] = stripLocationPrefix(row->col_view(2));
+        if (prefix != LOC_FILE_PREFIX)
+            continue;
+        result.emplace(location.string(),
+            FileState {
+                row->col_int(0, INVALID_OBJECT_ID),
+                row->col_int(1, INVALID_OBJECT_ID),
+                static_cast<unsigned int>(row->col_long(6, 0)),
+                std::chrono::seconds(row->col_long(3, 0)),
+                row->col(4),
+                row->col(5),
+            });
+    }
+    log_debug("{} file states below {}", result.size(), containerId);
+    return result;
+}
+
 int SQLDatabase::ensurePathExistence(const fs::path& path, int* changedContainer)
 {
     if (changedContainer)
@@ -1483,6 +2118,7 @@ int SQLDatabase::createContainer(int parentID, const std::string& name, const st
         identifier("flags"),
         identifier("upnp_class"),
         identifier("dc_title"),
+        identifier("sort_key"),
         identifier("location"),
         identifier("location_hash"),
         identifier("ref_id"),
@@ -1493,14 +2129,24 @@ int SQLDatabase::createContainer(int parentID, const std::string& name, const st
         fmt::to_string(flags),
         !upnpClass.empty() ? quote(upnpClass) : quote(UPNP_CLASS_CONTAINER),
         quote(name),
+        quote(makeSortKey(name, sortArticles)),
         quote(dbLocation),
         quote(stringHash(dbLocation)),
         (refID > 0) ? fmt::to_string(refID) : fmt::to_string(SQL_NULL),
     };
+    for (auto&& [field, column] : promotedMetadata) {
+        auto meta = std::find_if(itemMetadata.begin(), itemMetadata.end(), [&](auto&& md) { return md.first == field; });
+        if (meta != itemMetadata.end() && !meta->second.empty()) {
+            fields.push_back(identifier(column));
+            values.push_back(quote(meta->second));
+        }
+    }
 
     beginTransaction("createContainer");
     int newId = insert(CDS_OBJECT_TABLE, fields, values, true); // true = get last id#
     log_debug("Created object row, id: {}", newId);
+    changeChildCounts({ { parentID, { 1, 0 } } });
+    addAncestors(newId, parentID);
 
     if (!itemMetadata.empty()) {
         auto mfields = std::vector {
@@ -1558,6 +2204,147 @@ int SQLDatabase::createContainer(int parentID, const std::string& name, const st
     return newId;
 }
 
+std::shared_ptr<SQLResult> SQLDatabase::selectPrepared(const std::string& query, const std::vector<SQLParam>& params)
+{
+    return select(bindParams(query, params));
+}
+
+std::future<void> SQLDatabase::execAsync(const std::string& query)
+{
+    std::promise<void> done;
+    try {
+        exec(query);
+        done.set_value();
+    } catch (const std::runtime_error& e) {
+        // callers do not wait for queued writes, so the failure is reported here
+        log_warning("Failed to execute queued write\n{}", e.what());
+        done.set_exception(std::current_exception());
+    }
+    return done.get_future();
+}
+
+std::string SQLDatabase::bindParams(const std::string& query, const std::vector<SQLParam>& params) const
+{
+    std::string result;
+    result.reserve(query.size() + 16 * params.size());
+    auto param = params.begin();
+    // placeholders in string literals and quoted identifiers are kept, doubled quotes toggle twice
+    char quoteChar = '\0';
+    for (auto&& c : query) {
+        if (quoteChar != '\0') {
+            if (c == quoteChar)
+                quoteChar = '\0';
+            result.push_back(c);
+            continue;
+        }
+        if (c == '\'' || c == '"' || c == '`') {
+            quoteChar = c;
+            result.push_back(c);
+            continue;
+        }
+        if (c != '?') {
+            result.push_back(c);
+            continue;
+        }
+        if (param == params.end())
+            throw DatabaseException(fmt::format("Missing parameter for statement: {}", query), LINE_MESSAGE);
+        result += std::visit([this](auto&& value) -> std::string {
+            using T = std::decay_t<decltype(value)>;
+            if constexpr (std::is_same_v<T, std::nullptr_t>)
+                return "NULL";
+            else
+                return quote(value);
+        },
+            *param);
+        ++param;
+    }
+    if (param != params.end())
+        throw DatabaseException(fmt::format("Too many parameters for statement: {}", query), LINE_MESSAGE);
+    return result;
+}
+
+SQLDatabase::QueryTimer::QueryTimer(SQLDatabase* db, const std::string& query, const std::vector<SQLParam>* params)
+    : db(db)
+    , query(query)
+    , params(params)
+    , start(std::chrono::steady_clock::now())
+    , exceptions(std::uncaught_exceptions())
+{
+}
+
+SQLDatabase::QueryTimer::~QueryTimer()
+{
+    if (std::uncaught_exceptions() > exceptions)
+        return;
+    try {
+        db->recordQuery(query, params, duration.value_or(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start)));
+    } catch (const std::runtime_error& e) {
+        log_warning("Failed to record statement: {}", e.what());
+    }
+}
+
+void SQLDatabase::recordQuery(const std::string& query, const std::vector<SQLParam>* params, std::chrono::microseconds duration)
+{
+    // statements run to explain a slow statement are not counted
+    static thread_local bool explaining = false;
+    if (!queryStats || explaining)
+        return;
+    if (!queryStats->record(query, duration))
+        return;
+
+    std::string plan;
+    auto verb = QueryStats::getVerb(query);
+    if (verb == "SELECT" || verb == "INSERT" || verb == "UPDATE" || verb == "DELETE" || verb == "WITH") {
+        explaining = true;
+        try {
+            plan = explain(query, params);
+        } catch (const std::runtime_error& e) {
+            plan = e.what();
+        }
+        explaining = false;
+    }
+    log_warning("Slow statement took {} ms: {}{}", duration.count() / 1000, query, plan.empty() ? "" : fmt::format("\n{}", plan));
+    queryStats->addSlowQuery(query, duration, std::move(plan));
+}
+
+std::vector<std::map<std::string, std::string>> SQLDatabase::getQueryStats(std::size_t count)
+{
+    std::vector<std::map<std::string, std::string>> result;
+    if (!queryStats)
+        return result;
+
+    for (auto&& stats : queryStats->getTop(count)) {
+        std::map<std::string, std::string> entry {
+            { "shape", stats.shape },
+            { "count", fmt::to_string(stats.count) },
+            { "total", fmt::to_string(stats.total.count() / 1000) },
+            { "avg", fmt::format("{:.3f}", static_cast<double>(stats.total.count()) / stats.count / 1000) },
+            { "max", fmt::to_string(stats.max.count() / 1000) },
+            { "histogram", fmt::format("{}", fmt::join(stats.histogram, " / ")) },
+        };
+        result.push_back(std::move(entry));
+    }
+    return result;
+}
+
+std::vector<std::map<std::string, std::string>> SQLDatabase::getSlowQueries()
+{
+    std::vector<std::map<std::string, std::string>> result;
+    if (!queryStats)
+        return result;
+
+    for (auto&& slow : queryStats->getSlowQueries()) {
+        std::map<std::string, std::string> entry {
+            { "time", fmt::format("{:%Y-%m-%d %H:%M:%S}", fmt::localtime(slow.time.count())) },
+            { "duration", fmt::to_string(slow.duration.count() / 1000) },
+            { "query", slow.query },
+            { "plan", slow.plan },
+        };
+        result.push_back(std::move(entry));
+    }
+    return result;
+}
+
 int SQLDatabase::insert(std::string_view tableName, const std::vector<SQLIdentifier>& fields, const std::vector<std::string>& values, bool getLastInsertId, bool warnOnly)
 {
     assert(fields.size() == values.size());
@@ -1574,18 +2361,41 @@ void SQLDatabase::insertMultipleRows(std::string_view tableName, const std::vect
 {
     if (valuesets.size() == 1) {
         insert(tableName, fields, valuesets.front());
-    } else if (!valuesets.empty()) {
+        return;
+    }
+    // split large sets to keep statements below the size limit of the database
+    for (std::size_t start = 0; start < valuesets.size(); start += MAX_INSERT_ROWS) {
+        auto end = std::min(start + MAX_INSERT_ROWS, valuesets.size());
         std::vector<std::string> tuples;
-        tuples.reserve(valuesets.size());
-        for (const auto& values : valuesets) {
-            assert(fields.size() == values.size());
-            tuples.push_back(fmt::format("({})", fmt::join(values, ",")));
+        tuples.reserve(end - start);
+        for (auto it = valuesets.begin() + start; it != valuesets.begin() + end; ++it) {
+            assert(fields.size() == it->size());
+            tuples.push_back(fmt::format("({})", fmt::join(*it, ",")));
         }
         auto sql = fmt::format("INSERT INTO {} ({}) VALUES {}", identifier(std::string(tableName)), fmt::join(fields, ","), fmt::join(tuples, ","));
         exec(tableName, sql, -1);
     }
 }
 
+std::vector<int> SQLDatabase::insertMultipleRowsGetIds(std::string_view tableName, const std::vector<SQLIdentifier>& fields, const std::vector<std::vector<std::string>>& valuesets)
+{
+    std::vector<int> ids;
+    ids.reserve(valuesets.size());
+    for (std::size_t start = 0; start < valuesets.size(); start += MAX_INSERT_ROWS) {
+        auto end = std::min(start + MAX_INSERT_ROWS, valuesets.size());
+        std::vector<std::string> tuples;
+        tuples.reserve(end - start);
+        for (auto it = valuesets.begin() + start; it != valuesets.begin() + end; ++it) {
+            assert(fields.size() == it->size());
+            tuples.push_back(fmt::format("({})", fmt::join(*it, ",")));
+        }
+        auto firstId = firstInsertId(exec(fmt::format("INSERT INTO {} ({}) VALUES {}", identifier(std::string(tableName)), fmt::join(fields, ","), fmt::join(tuples, ",")), true), tuples.size());
+        for (std::size_t i = 0; i < tuples.size(); i++)
+            ids.push_back(firstId + static_cast<int>(i));
+    }
+    return ids;
+}
+
 void SQLDatabase::deleteAll(std::string_view tableName)
 {
     del(tableName, "", {});
@@ -1673,7 +2483,7 @@ std::pair<fs::path, char> SQLDatabase::stripLocationPrefix(std::string_view dbLo
     return { dbLocation.substr(1), dbLocation.at(0) };
 }
 
-std::shared_ptr<CdsObject> SQLDatabase::createObjectFromRow(const std::string& group, const std::unique_ptr<SQLRow>& row)
+std::shared_ptr<CdsObject> SQLDatabase::createObjectFromRow(const std::string& group, const std::unique_ptr<SQLRow>& row, const ObjectDetails* details)
 {
     int objectType = std::stoi(getCol(row, BrowseCol::ObjectType));
     auto obj = CdsObject::createObject(objectType);
@@ -1689,11 +2499,11 @@ std::shared_ptr<CdsObject> SQLDatabase::createObjectFromRow(const std::string& g
     obj->setMTime(std::chrono::seconds(stoulString(getCol(row, BrowseCol::LastModified))));
     obj->setUTime(std::chrono::seconds(stoulString(getCol(row, BrowseCol::LastUpdated))));
 
-    auto metaData = retrieveMetaDataForObject(obj->getID());
+    auto metaData = details ? details->getMetaData(obj->getID()) : retrieveMetaDataForObject(obj->getID());
     if (!metaData.empty()) {
         obj->setMetaData(std::move(metaData));
     } else if (obj->getRefID() != CDS_ID_ROOT) {
-        metaData = retrieveMetaDataForObject(obj->getRefID());
+        metaData = details ? details->getMetaData(obj->getRefID()) : retrieveMetaDataForObject(obj->getRefID());
         if (!metaData.empty())
             obj->setMetaData(std::move(metaData));
     }
@@ -1703,12 +2513,12 @@ std::shared_ptr<CdsObject> SQLDatabase::createObjectFromRow(const std::string& g
     obj->setAuxData(aux);
 
     bool resourceZeroOk = false;
-    auto resources = retrieveResourcesForObject(obj->getID());
+    auto resources = details ? details->getResources(obj->getID()) : retrieveResourcesForObject(obj->getID());
     if (!resources.empty()) {
         resourceZeroOk = true;
         obj->setResources(std::move(resources));
     } else if (obj->getRefID() != CDS_ID_ROOT) {
-        resources = retrieveResourcesForObject(obj->getRefID());
+        resources = details ? details->getResources(obj->getRefID()) : retrieveResourcesForObject(obj->getRefID());
         if (!resources.empty()) {
             resourceZeroOk = true;
             obj->setResources(std::move(resources));
@@ -1760,7 +2570,7 @@ std::shared_ptr<CdsObject> SQLDatabase::createObjectFromRow(const std::string& g
             item->setServiceID(getCol(row, BrowseCol::ServiceId));
 
         if (!group.empty()) {
-            auto playStatus = getPlayStatus(group, obj->getID());
+            auto playStatus = details ? details->getPlayStatus(obj->getID()) : getPlayStatus(group, obj->getID());
             if (playStatus)
                 item->setPlayStatus(playStatus);
         }
@@ -1774,7 +2584,7 @@ std::shared_ptr<CdsObject> SQLDatabase::createObjectFromRow(const std::string& g
     return obj;
 }
 
-std::shared_ptr<CdsObject> SQLDatabase::createObjectFromSearchRow(const std::string& group, const std::unique_ptr<SQLRow>& row)
+std::shared_ptr<CdsObject> SQLDatabase::createObjectFromSearchRow(const std::string& group, const std::unique_ptr<SQLRow>& row, const ObjectDetails* details)
 {
     int objectType = std::stoi(getCol(row, SearchCol::ObjectType));
     auto obj = CdsObject::createObject(objectType);
@@ -1788,17 +2598,17 @@ std::shared_ptr<CdsObject> SQLDatabase::createObjectFromSearchRow(const std::str
     obj->setClass(getCol(row, SearchCol::UpnpClass));
     obj->setFlags(std::stoi(getCol(row, SearchCol::Flags)));
 
-    auto metaData = retrieveMetaDataForObject(obj->getID());
+    auto metaData = details ? details->getMetaData(obj->getID()) : retrieveMetaDataForObject(obj->getID());
     if (!metaData.empty())
         obj->setMetaData(std::move(metaData));
 
     bool resourceZeroOk = false;
-    auto resources = retrieveResourcesForObject(obj->getID());
+    auto resources = details ? details->getResources(obj->getID()) : retrieveResourcesForObject(obj->getID());
     if (!resources.empty()) {
         resourceZeroOk = true;
         obj->setResources(std::move(resources));
     } else if (obj->getRefID() != CDS_ID_ROOT) {
-        resources = retrieveResourcesForObject(obj->getRefID());
+        resources = details ? details->getResources(obj->getRefID()) : retrieveResourcesForObject(obj->getRefID());
         if (!resources.empty()) {
             resourceZeroOk = true;
             obj->setResources(std::move(resources));
@@ -1820,7 +2630,7 @@ std::shared_ptr<CdsObject> SQLDatabase::createObjectFromSearchRow(const std::str
         item->setPartNumber(stoiString(getCol(row, SearchCol::PartNumber)));
         item->setTrackNumber(stoiString(getCol(row, SearchCol::TrackNumber)));
 
-        auto playStatus = getPlayStatus(group, obj->getID());
+        auto playStatus = details ? details->getPlayStatus(obj->getID()) : getPlayStatus(group, obj->getID());
         if (playStatus)
             item->setPlayStatus(playStatus);
     } else if (obj->isContainer()) {
@@ -1835,9 +2645,7 @@ std::shared_ptr<CdsObject> SQLDatabase::createObjectFromSearchRow(const std::str
 
 std::vector<std::pair<std::string, std::string>> SQLDatabase::retrieveMetaDataForObject(int objectId)
 {
-    auto query = fmt::format("{} FROM {} WHERE {} = {}",
-        sql_meta_query, identifier(METADATA_TABLE), identifier("item_id"), objectId);
-    auto res = select(query);
+    auto res = selectPrepared(sql_meta_by_item_stmt, { objectId });
     if (!res)
         return {};
 
@@ -1851,6 +2659,82 @@ std::vector<std::pair<std::string, std::string>> SQLDatabase::retrieveMetaDataFo
     return metaData;
 }
 
+SQLDatabase::ObjectDetails SQLDatabase::retrieveObjectDetails(const std::string& group, std::vector<int> objectIds, const std::vector<int>& itemIds)
+{
+    ObjectDetails details;
+    std::sort(objectIds.begin(), objectIds.end());
+    objectIds.erase(std::unique(objectIds.begin(), objectIds.end()), objectIds.end());
+    if (objectIds.empty())
+        return details;
+
+    auto metaRes = select(fmt::format("{} FROM {} WHERE {} IN ({})",
+        sql_meta_query, identifier(METADATA_TABLE), identifier("item_id"), fmt::join(objectIds, ",")));
+    if (metaRes) {
+        std::unique_ptr<SQLRow> row;
+        while ((row = metaRes->nextRow())) {
+            details.metaData[getColInt(row, MetadataCol::ItemId, INVALID_OBJECT_ID)].emplace_back(getCol(row, MetadataCol::PropertyName), getCol(row, MetadataCol::PropertyValue));
+        }
+    }
+
+    auto resRes = select(fmt::format("{} FROM {} WHERE {} IN ({}) ORDER BY {}, {}",
+        sql_resource_query, identifier(RESOURCE_TABLE), identifier("item_id"), fmt::join(objectIds, ","), identifier("item_id"), identifier("res_id")));
+    if (resRes) {
+        std::unique_ptr<SQLRow> row;
+        while ((row = resRes->nextRow())) {
+            auto&& resources = details.resources[getColInt(row, ResourceCol::ItemId, INVALID_OBJECT_ID)];
+            resources.push_back(createResourceFromRow(row, resources.size()));
+        }
+    }
+
+    if (!itemIds.empty()) {
+        auto playRes = select(fmt::format("{} WHERE {} = {} AND {} IN ({})",
+            sql_playstatus_query, identifier("group"), quote(group), identifier("item_id"), fmt::join(itemIds, ",")));
+        if (playRes) {
+            std::unique_ptr<SQLRow> row;
+            while ((row = playRes->nextRow())) {
+                auto status = std::make_shared<ClientStatusDetail>(row->col(0), row->col_int(1, INVALID_OBJECT_ID), row->col_int(2, 0), row->col_int(3, 0), row->col_int(4, 0), row->col_int(5, 0));
+                details.playStatus[status->getItemId()] = std::move(status);
+            }
+        }
+    }
+    log_debug("Loaded details of {} objects", objectIds.size());
+
+    return details;
+}
+
+std::vector<std::pair<std::string, std::string>> SQLDatabase::ObjectDetails::getMetaData(int objectId) const
+{
+    auto it = metaData.find(objectId);
+    if (it == metaData.end())
+        return {};
+    return it->second;
+}
+
+std::vector<std::shared_ptr<CdsResource>> SQLDatabase::ObjectDetails::getResources(int objectId) const
+{
+    auto it = resources.find(objectId);
+    if (it == resources.end())
+        return {};
+
+    // referenced objects may appear several times on a page, each object gets its own copy
+    std::vector<std::shared_ptr<CdsResource>> result;
+    result.reserve(it->second.size());
+    for (auto&& resource : it->second) {
+        auto copy = resource->clone();
+        copy->setResId(resource->getResId());
+        result.push_back(std::move(copy));
+    }
+    return result;
+}
+
+std::shared_ptr<ClientStatusDetail> SQLDatabase::ObjectDetails::getPlayStatus(int objectId) const
+{
+    auto it = playStatus.find(objectId);
+    if (it == playStatus.end())
+        return {};
+    return it->second;
+}
+
 long long SQLDatabase::getFileStats(const StatsParam& stats)
 {
     auto where = std::vector {
@@ -1885,6 +2769,22 @@ long long SQLDatabase::getFileStats(const StatsParam& stats)
     return 0;
 }
 
+std::map<std::string, std::string> SQLDatabase::getStatus()
+{
+    auto result = Database::getStatus();
+    if (objectCache) {
+        result["objectCacheHits"] = fmt::to_string(objectCache->getHits());
+        result["objectCacheMisses"] = fmt::to_string(objectCache->getMisses());
+        result["objectCacheSize"] = fmt::to_string(objectCache->size());
+    }
+    if (searchCache) {
+        result["searchCacheHits"] = fmt::to_string(searchCache->getHits());
+        result["searchCacheMisses"] = fmt::to_string(searchCache->getMisses());
+        result["searchCacheSize"] = fmt::to_string(searchCache->size());
+    }
+    return result;
+}
+
 std::map<std::string, long long> SQLDatabase::getGroupStats(const StatsParam& stats)
 {
     auto where = std::vector {
@@ -1939,6 +2839,10 @@ std::string SQLDatabase::incrementUpdateIDs(const std::unordered_set<int>& ids)
         throw DatabaseException("Error while fetching update ids", LINE_MESSAGE);
     }
     commit("incrementUpdateIDs 2");
+    if (objectCache) {
+        for (auto&& id : ids)
+            objectCache->erase(id);
+    }
 
     std::unique_ptr<SQLRow> row;
     std::vector<std::string> rows;
@@ -2092,9 +2996,28 @@ void SQLDatabase::_removeObjects(const std::vector<std::int32_t>& objectIDs)
         }
     }
 
+    // count removed children of parents that are not removed
+    auto parentRes = select(fmt::format("SELECT {0}, {1}, COUNT(*) FROM {2} WHERE {3} IN ({4}) AND {0} NOT IN ({4}) GROUP BY {0}, {1}",
+        identifier("parent_id"), identifier("object_type"), identifier(CDS_OBJECT_TABLE), identifier("id"), fmt::join(objectIDs, ",")));
+    std::map<int, ChildCounts> childCounts;
+    if (parentRes) {
+        std::unique_ptr<SQLRow> row;
+        while ((row = parentRes->nextRow())) {
+            addChildCount(childCounts[row->col_int(0, INVALID_OBJECT_ID)], row->col_int(1, 0), -row->col_int(2, 0));
+        }
+    }
+
+    del(ANCESTOR_TABLE, fmt::format("{0} IN ({2}) OR {1} IN ({2})", identifier("object_id"), identifier("ancestor_id"), fmt::join(objectIDs, ",")), {});
     deleteRows(CDS_OBJECT_TABLE, "id", objectIDs);
+    changeChildCounts(childCounts);
     del(RESOURCE_TABLE, fmt::format("{} IN ('{}')", identifier(EnumMapper::getAttributeName(ResourceAttribute::FANART_OBJ_ID)), fmt::join(objectIDs, "','")), objectIDs);
     commit("_removeObjects");
+    // resources of remaining objects may refer to removed objects
+    if (objectCache)
+        objectCache->clear();
+    // cached searches would report removed objects in total matches
+    if (searchCache)
+        searchCache->clear();
 }
 
 std::unique_ptr<Database::ChangedContainers> SQLDatabase::removeObject(int objectID, const fs::path& path, bool all)
@@ -2128,8 +3051,11 @@ std::unique_ptr<Database::ChangedContainers> SQLDatabase::removeObject(int objec
         itemIds.push_back(objectID);
     }
     auto changedContainers = _recursiveRemove(itemIds, containerIds, all);
-    if (!path.empty())
+    if (!path.empty()) {
         del(RESOURCE_TABLE, fmt::format("{} = {}", identifier(EnumMapper::getAttributeName(ResourceAttribute::RESOURCE_FILE)), quote(path.string())), {});
+        if (objectCache)
+            objectCache->clear();
+    }
     return _purgeEmptyContainers(std::move(changedContainers));
 }
 
@@ -2153,9 +3079,10 @@ Database::ChangedContainers SQLDatabase::_recursiveRemove(
     // select statements
     auto parentSql = fmt::format("SELECT DISTINCT {0}parent_id{1} FROM {0}{2}{1} WHERE {0}id{1} IN", table_quote_begin, table_quote_end, CDS_OBJECT_TABLE);
     auto itemSql = fmt::format("SELECT DISTINCT {0}id{1}, {0}parent_id{1} FROM {0}{2}{1} WHERE {0}ref_id{1} IN", table_quote_begin, table_quote_end, CDS_OBJECT_TABLE);
+    // all descendants of the containers are found in the ancestor table
     auto containersSql = all //
-        ? fmt::format("SELECT DISTINCT {0}id{1}, {0}object_type{1}, {0}ref_id{1} FROM {0}{2}{1} WHERE {0}parent_id{1} IN", table_quote_begin, table_quote_end, CDS_OBJECT_TABLE) //
-        : fmt::format("SELECT DISTINCT {0}id{1}, {0}object_type{1} FROM {0}{2}{1} WHERE {0}parent_id{1} IN", table_quote_begin, table_quote_end, CDS_OBJECT_TABLE);
+        ? fmt::format("SELECT DISTINCT {0}id{1}, {0}object_type{1}, {0}ref_id{1} FROM {0}{2}{1} JOIN {0}{3}{1} ON {0}object_id{1} = {0}id{1} WHERE {0}ancestor_id{1} IN", table_quote_begin, table_quote_end, CDS_OBJECT_TABLE, ANCESTOR_TABLE) //
+        : fmt::format("SELECT DISTINCT {0}id{1}, {0}object_type{1} FROM {0}{2}{1} JOIN {0}{3}{1} ON {0}object_id{1} = {0}id{1} WHERE {0}ancestor_id{1} IN", table_quote_begin, table_quote_end, CDS_OBJECT_TABLE, ANCESTOR_TABLE);
 
     // collect container for update signals
     if (!containers.empty()) {
@@ -2199,7 +3126,7 @@ Database::ChangedContainers SQLDatabase::_recursiveRemove(
             }
         }
 
-        // collect entries in container
+        // collect entries in containers and their subcontainers
         if (!containerIds.empty()) {
             auto sql = fmt::format("{} ({})", containersSql, fmt::join(containerIds, ","));
             res = select(sql);
@@ -2210,7 +3137,6 @@ Database::ChangedContainers SQLDatabase::_recursiveRemove(
                 const int objId = row->col_int(0, INVALID_OBJECT_ID);
                 const int objType = row->col_int(1, 0);
                 if (IS_CDS_CONTAINER(objType)) {
-                    containerIds.push_back(objId);
                     removeIds.push_back(objId);
                 } else {
                     if (all) {
@@ -2459,7 +3385,7 @@ std::vector<ClientObservation> SQLDatabase::getClients()
 
 void SQLDatabase::saveClients(const std::vector<ClientObservation>& cache)
 {
-    deleteAll(CLIENTS_TABLE);
+    execAsync(fmt::format("DELETE FROM {}", identifier(CLIENTS_TABLE)));
     auto fields = std::vector {
         identifier("addr"),
         identifier("port"),
@@ -2477,23 +3403,13 @@ void SQLDatabase::saveClients(const std::vector<ClientObservation>& cache)
             quote(client.last.count()),
             quote(client.age.count()),
         };
-        insert(CLIENTS_TABLE, fields, values, false, true);
+        execAsync(fmt::format("INSERT INTO {} ({}) VALUES ({})", identifier(CLIENTS_TABLE), fmt::join(fields, ","), fmt::join(values, ",")));
     }
 }
 
 std::shared_ptr<ClientStatusDetail> SQLDatabase::getPlayStatus(const std::string& group, int objectId)
 {
-    auto fields = std::vector {
-        identifier("group"),
-        identifier("item_id"),
-        identifier("playCount"),
-        identifier("lastPlayed"),
-        identifier("lastPlayedPosition"),
-        identifier("bookMarkPos"),
-    };
-    auto res = select(fmt::format("SELECT {} FROM {} WHERE {} = {} AND {} = {}",
-        fmt::join(fields, ", "), identifier(PLAYSTATUS_TABLE),
-        identifier("group"), quote(group), identifier("item_id"), quote(objectId)));
+    auto res = selectPrepared(sql_playstatus_stmt, { group, objectId });
     if (!res)
         return {};
 
@@ -2508,17 +3424,7 @@ std::shared_ptr<ClientStatusDetail> SQLDatabase::getPlayStatus(const std::string
 
 std::vector<std::shared_ptr<ClientStatusDetail>> SQLDatabase::getPlayStatusList(int objectId)
 {
-    auto fields = std::vector {
-        identifier("group"),
-        identifier("item_id"),
-        identifier("playCount"),
-        identifier("lastPlayed"),
-        identifier("lastPlayedPosition"),
-        identifier("bookMarkPos"),
-    };
-    auto res = select(fmt::format("SELECT {} FROM {} WHERE {} = {}",
-        fmt::join(fields, ", "), identifier(PLAYSTATUS_TABLE),
-        identifier("item_id"), quote(objectId)));
+    auto res = select(fmt::format("{} WHERE {} = {}", sql_playstatus_query, identifier("item_id"), quote(objectId)));
     if (!res)
         return {};
 
@@ -2535,50 +3441,24 @@ std::vector<std::shared_ptr<ClientStatusDetail>> SQLDatabase::getPlayStatusList(
 
 void SQLDatabase::savePlayStatus(const std::shared_ptr<ClientStatusDetail>& detail)
 {
-    beginTransaction("savePlayStatus");
-
-    std::vector<std::string> where {
-        fmt::format("{} = {}", identifier("group"), quote(detail->getGroup())),
-        fmt::format("{} = {}", identifier("item_id"), quote(detail->getItemId())),
+    auto fields = std::vector {
+        identifier("group"),
+        identifier("item_id"),
+        identifier("playCount"),
+        identifier("lastPlayed"),
+        identifier("lastPlayedPosition"),
+        identifier("bookMarkPos"),
     };
-    auto res = select(fmt::format("SELECT 1 FROM {} WHERE {} LIMIT 1",
-        identifier(PLAYSTATUS_TABLE),
-        fmt::join(where, " AND ")));
-    auto doUpdate = res && res->getNumRows() > 0;
-
-    if (doUpdate) {
-        std::vector<std::string> fields {
-            fmt::format("{} = {}", identifier("playCount"), quote(detail->getPlayCount())),
-            fmt::format("{} = {}", identifier("lastPlayed"), quote(detail->getLastPlayed().count())),
-            fmt::format("{} = {}", identifier("lastPlayedPosition"), quote(detail->getLastPlayedPosition().count())),
-            fmt::format("{} = {}", identifier("bookMarkPos"), quote(detail->getBookMarkPosition().count())),
-        };
-
-        exec(fmt::format("UPDATE {} SET {} WHERE {}",
-            identifier(PLAYSTATUS_TABLE),
-            fmt::join(fields, ", "),
-            fmt::join(where, " AND ")));
-    } else {
-        auto fields = std::vector {
-            identifier("group"),
-            identifier("item_id"),
-            identifier("playCount"),
-            identifier("lastPlayed"),
-            identifier("lastPlayedPosition"),
-            identifier("bookMarkPos"),
-        };
-        auto values = std::vector {
-            quote(detail->getGroup()),
-            quote(detail->getItemId()),
-            quote(detail->getPlayCount()),
-            quote(detail->getLastPlayed().count()),
-            quote(detail->getLastPlayedPosition().count()),
-            quote(detail->getBookMarkPosition().count()),
-        };
-        insert(PLAYSTATUS_TABLE, fields, values, false, true);
-    }
-
-    commit("savePlayStatus");
+    auto values = std::vector {
+        quote(detail->getGroup()),
+        quote(detail->getItemId()),
+        quote(detail->getPlayCount()),
+        quote(detail->getLastPlayed().count()),
+        quote(detail->getLastPlayedPosition().count()),
+        quote(detail->getBookMarkPosition().count()),
+    };
+    // all columns are set, so replacing the row of group and item is the same as an update
+    execAsync(fmt::format("REPLACE INTO {} ({}) VALUES ({})", identifier(PLAYSTATUS_TABLE), fmt::join(fields, ","), fmt::join(values, ",")));
 }
 
 std::vector<std::map<std::string, std::string>> SQLDatabase::getClientGroupStats()
@@ -2794,6 +3674,8 @@ void SQLDatabase::addAutoscanDirectory(const std::shared_ptr<AutoscanDirectory>&
         pathIds.empty() ? SQL_NULL : quote(fmt::format(",{},", fmt::join(pathIds, ","))),
     };
     adir->setDatabaseID(insert(AUTOSCAN_TABLE, fields, values, true));
+    if (objectCache)
+        objectCache->erase(objectID);
 }
 
 void SQLDatabase::updateAutoscanDirectory(const std::shared_ptr<AutoscanDirectory>& adir)
@@ -2834,6 +3716,8 @@ void SQLDatabase::updateAutoscanDirectory(const std::shared_ptr<AutoscanDirector
         fields.emplace_back(identifier("last_modified"), quote(adir->getPreviousLMT().count()));
     }
     updateRow(AUTOSCAN_TABLE, fields, "id", adir->getDatabaseID());
+    if (objectCache)
+        objectCache->erase(objectID);
 }
 
 void SQLDatabase::removeAutoscanDirectory(const std::shared_ptr<AutoscanDirectory>& adir)
@@ -2873,6 +3757,8 @@ void SQLDatabase::_autoscanChangePersistentFlag(int objectID, bool persistent)
         return;
     }
     exec(fmt::format("UPDATE {0}{2}{1} SET {0}flags{1} = ({0}flags{1} {3}{4}) WHERE {0}id{1} = {5}", table_quote_begin, table_quote_end, CDS_OBJECT_TABLE, (persistent ? " | " : " & ~"), OBJECT_FLAG_PERSISTENT_CONTAINER, objectID));
+    if (objectCache)
+        objectCache->erase(objectID);
 }
 
 void SQLDatabase::checkOverlappingAutoscans(const std::shared_ptr<AutoscanDirectory>& adir)
@@ -3005,10 +3891,8 @@ void SQLDatabase::generateMetaDataDBOperations(const std::shared_ptr<CdsObject>&
 
 std::vector<std::shared_ptr<CdsResource>> SQLDatabase::retrieveResourcesForObject(int objectId)
 {
-    auto rsql = fmt::format("{} FROM {} WHERE {} = {} ORDER BY {}",
-        sql_resource_query, identifier(RESOURCE_TABLE), identifier("item_id"), objectId, identifier("res_id"));
-    log_debug("SQLDatabase::retrieveResourcesForObject {}", rsql);
-    auto&& res = select(rsql);
+    log_debug("SQLDatabase::retrieveResourcesForObject {} [{}]", sql_resource_by_item_stmt, objectId);
+    auto&& res = selectPrepared(sql_resource_by_item_stmt, { objectId });
 
     if (!res)
         return {};
@@ -3017,25 +3901,30 @@ std::vector<std::shared_ptr<CdsResource>> SQLDatabase::retrieveResourcesForObjec
     resources.reserve(res->getNumRows());
     std::unique_ptr<SQLRow> row;
     while ((row = res->nextRow())) {
-        auto resource = std::make_shared<CdsResource>(
-            EnumMapper::remapContentHandler(std::stoi(getCol(row, ResourceCol::HandlerType))),
-            EnumMapper::remapPurpose(std::stoi(getCol(row, ResourceCol::Purpose))),
-            getCol(row, ResourceCol::Options),
-            getCol(row, ResourceCol::Parameters));
-        resource->setResId(resources.size());
-        for (auto&& resAttrId : ResourceAttributeIterator()) {
-            auto index = to_underlying(ResourceCol::Attributes) + to_underlying(resAttrId);
-            auto value = row->col_c_str(index);
-            if (value) {
-                resource->addAttribute(resAttrId, value);
-            }
-        }
-        resources.push_back(std::move(resource));
+        resources.push_back(createResourceFromRow(row, resources.size()));
     }
 
     return resources;
 }
 
+std::shared_ptr<CdsResource> SQLDatabase::createResourceFromRow(const std::unique_ptr<SQLRow>& row, std::size_t resId)
+{
+    auto resource = std::make_shared<CdsResource>(
+        EnumMapper::remapContentHandler(std::stoi(getCol(row, ResourceCol::HandlerType))),
+        EnumMapper::remapPurpose(std::stoi(getCol(row, ResourceCol::Purpose))),
+        getCol(row, ResourceCol::Options),
+        getCol(row, ResourceCol::Parameters));
+    resource->setResId(resId);
+    for (auto&& resAttrId : ResourceAttributeIterator()) {
+        auto index = to_underlying(ResourceCol::Attributes) + to_underlying(resAttrId);
+        auto value = row->col_c_str(index);
+        if (value) {
+            resource->addAttribute(resAttrId, value);
+        }
+    }
+    return resource;
+}
+
 void SQLDatabase::generateResourceDBOperations(const std::shared_ptr<CdsObject>& obj, Operation op,
     std::vector<AddUpdateTable>& operations)
 {
@@ -3098,7 +3987,7 @@ void SQLDatabase::generateResourceDBOperations(const std::shared_ptr<CdsObject>&
     }
 }
 
-std::string SQLDatabase::sqlForInsert(const std::shared_ptr<CdsObject>& obj, const AddUpdateTable& addUpdateTable) const
+std::pair<std::vector<std::string>, std::vector<std::string>> SQLDatabase::rowForInsert(const std::shared_ptr<CdsObject>& obj, const AddUpdateTable& addUpdateTable) const
 {
     const std::string& tableName = addUpdateTable.getTableName();
 
@@ -3108,23 +3997,33 @@ std::string SQLDatabase::sqlForInsert(const std::shared_ptr<CdsObject>& obj, con
 
     const auto& dict = addUpdateTable.getDict();
 
-    std::vector<SQLIdentifier> fields;
+    std::vector<std::string> fields;
     std::vector<std::string> values;
     fields.reserve(dict.size() + 1); // extra only used for METADATA_TABLE and RESOURCE_TABLE
     values.reserve(dict.size() + 1); // extra only used for METADATA_TABLE and RESOURCE_TABLE
 
     if (tableName == METADATA_TABLE || tableName == RESOURCE_TABLE) {
-        fields.push_back(identifier("item_id"));
+        fields.emplace_back("item_id");
         values.push_back(fmt::to_string(obj->getID()));
     }
     for (auto&& field : tableColumnOrder.at(tableName)) {
         if (dict.find(field) != dict.end()) {
-            fields.push_back(identifier(field));
+            fields.push_back(field);
             values.push_back(dict.at(field));
         }
     }
 
-    return fmt::format("INSERT INTO {} ({}) VALUES ({})", identifier(tableName), fmt::join(fields, ", "), fmt::join(values, ", "));
+    return { std::move(fields), std::move(values) };
+}
+
+std::string SQLDatabase::sqlForInsert(const std::shared_ptr<CdsObject>& obj, const AddUpdateTable& addUpdateTable) const
+{
+    auto [fieldNames, values] = rowForInsert(obj, addUpdateTable);
+    std::vector<SQLIdentifier> fields;
+    fields.reserve(fieldNames.size());
+    std::transform(fieldNames.begin(), fieldNames.end(), std::back_inserter(fields), [this](auto&& name) { return identifier(name); });
+
+    return fmt::format("INSERT INTO {} ({}) VALUES ({})", identifier(addUpdateTable.getTableName()), fmt::join(fields, ", "), fmt::join(values, ", "));
 }
 
 std::string SQLDatabase::sqlForUpdate(const std::shared_ptr<CdsObject>& obj, const AddUpdateTable& addUpdateTable) const
@@ -3239,6 +4138,43 @@ void SQLDatabase::migrateMetadata(int objectId, const std::string& metadataStr)
     }
 }
 
+// table grb_cds_ancestor is added in DBVERSION 25
+bool SQLDatabase::doAncestorMigration()
+{
+    log_info("About to fill ancestor table from parent ids");
+    auto res = select(fmt::format("SELECT {0}, {1} FROM {2} WHERE {0} > {3}",
+        identifier("id"), identifier("parent_id"), identifier(CDS_OBJECT_TABLE), CDS_ID_ROOT));
+    if (!res)
+        return false;
+
+    std::unordered_map<int, int> parents;
+    std::unique_ptr<SQLRow> row;
+    while ((row = res->nextRow())) {
+        parents.emplace(row->col_int(0, INVALID_OBJECT_ID), row->col_int(1, INVALID_OBJECT_ID));
+    }
+
+    deleteAll(ANCESTOR_TABLE);
+    std::vector<std::vector<std::string>> valuesets;
+    for (auto&& [objectId, parentId] : parents) {
+        const auto id = fmt::to_string(objectId);
+        int ancestorId = parentId;
+        int depth = 0;
+        while (ancestorId >= CDS_ID_ROOT && depth++ < MAX_REMOVE_RECURSION) {
+            valuesets.push_back({ fmt::to_string(ancestorId), id });
+            auto parent = parents.find(ancestorId);
+            ancestorId = (parent != parents.end()) ? parent->second : INVALID_OBJECT_ID;
+        }
+        if (valuesets.size() >= MAX_INSERT_ROWS) {
+            insertMultipleRows(ANCESTOR_TABLE, { identifier("ancestor_id"), identifier("object_id") }, valuesets);
+            valuesets.clear();
+        }
+    }
+    if (!valuesets.empty())
+        insertMultipleRows(ANCESTOR_TABLE, { identifier("ancestor_id"), identifier("object_id") }, valuesets);
+    log_info("Filled ancestor table - object count: {}", parents.size());
+    return true;
+}
+
 void SQLDatabase::prepareResourceTable(std::string_view addColumnCmd)
 {
     auto resourceAttributes = splitString(getInternalSetting("resource_attribute"), ',');
@@ -3256,6 +4192,91 @@ void SQLDatabase::prepareResourceTable(std::string_view addColumnCmd)
         storeInternalSetting("resource_attribute", fmt::format("{}", fmt::join(resourceAttributes, ",")));
 }
 
+void SQLDatabase::initPromotedMetadata()
+{
+    promotedMetadata.clear();
+    for (auto&& tag : config->getArrayOption(ConfigVal::SERVER_STORAGE_PROMOTED_METADATA)) {
+        auto metaId = MetaEnumMapper::remapMetaDataField(tag);
+        if (metaId == MetadataFields::M_MAX || metaId == MetadataFields::M_TITLE || metaId == MetadataFields::M_TRACKNUMBER || metaId == MetadataFields::M_PARTNUMBER) {
+            log_warning("Metadata '{}' cannot be promoted to a column", tag);
+            continue;
+        }
+        auto field = MetaEnumMapper::getMetaFieldName(metaId);
+        auto column = fmt::format("meta_{}", field);
+        std::replace_if(column.begin(), column.end(), [](auto ch) { return !std::isalnum(ch); }, '_');
+        if (std::none_of(promotedMetadata.begin(), promotedMetadata.end(), [&](auto&& promoted) { return promoted.first == field; }))
+            promotedMetadata.emplace_back(std::move(field), std::move(column));
+    }
+}
+
+void SQLDatabase::preparePromotedColumns(std::string_view addColumnCmd, std::string_view addIndexCmd)
+{
+    auto columns = splitString(getInternalSetting("promoted_column"), ',');
+    auto activeColumns = splitString(getInternalSetting("promoted_metadata"), ',');
+    bool addedColumn = false;
+    std::vector<std::string> promotedColumns;
+    for (auto&& [field, column] : promotedMetadata) {
+        if (std::find(columns.begin(), columns.end(), column) == columns.end()) {
+            _exec(fmt::format(addColumnCmd, column));
+            _exec(fmt::format(addIndexCmd, column));
+            log_info("'{}': Adding column '{}'", CDS_OBJECT_TABLE, column);
+            columns.push_back(column);
+            addedColumn = true;
+        }
+        if (std::find(activeColumns.begin(), activeColumns.end(), column) == activeColumns.end()) {
+            log_info("'{}': Filling column '{}' from {}", CDS_OBJECT_TABLE, column, METADATA_TABLE);
+            // first value of own metadata, virtual objects without metadata use the referenced object
+            auto valueQuery = [&](const std::string& idColumn) {
+                return fmt::format("SELECT {0}.{1} FROM {2} {0} WHERE {0}.{3} = {4}.{5} AND {0}.{6} = {7} ORDER BY {0}.{8} LIMIT 1",
+                    identifier(MTA_ALIAS), identifier("property_value"), identifier(METADATA_TABLE), identifier("item_id"),
+                    identifier(CDS_OBJECT_TABLE), identifier(idColumn), identifier("property_name"), quote(field), identifier("id"));
+            };
+            _exec(fmt::format("UPDATE {} SET {} = ({})", identifier(CDS_OBJECT_TABLE), identifier(column), valueQuery("id")));
+            _exec(fmt::format("UPDATE {0} SET {1} = ({2}) WHERE {3} IS NOT NULL AND NOT EXISTS (SELECT 1 FROM {4} WHERE {4}.{5} = {0}.{6})",
+                identifier(CDS_OBJECT_TABLE), identifier(column), valueQuery("ref_id"), identifier("ref_id"),
+                identifier(METADATA_TABLE), identifier("item_id"), identifier("id")));
+        }
+        promotedColumns.push_back(column);
+    }
+    if (addedColumn)
+        storeInternalSetting("promoted_column", fmt::format("{}", fmt::join(columns, ",")));
+    if (promotedColumns != activeColumns)
+        storeInternalSetting("promoted_metadata", fmt::format("{}", fmt::join(promotedColumns, ",")));
+}
+
+void SQLDatabase::prepareSortKeys()
+{
+    // changes of the key computation need a new version
+    auto keySetting = fmt::format("1:{}", fmt::join(sortArticles, ","));
+    if (getInternalSetting("sort_key") == keySetting)
+        return;
+
+    log_info("'{}': Filling column '{}'", CDS_OBJECT_TABLE, "sort_key");
+    std::vector<std::pair<int, std::string>> titles;
+    {
+        auto res = select(fmt::format("SELECT {}, {} FROM {}", identifier("id"), identifier("dc_title"), identifier(CDS_OBJECT_TABLE)));
+        if (!res)
+            throw DatabaseException(fmt::format("error selecting form {}", CDS_OBJECT_TABLE), LINE_MESSAGE);
+        std::unique_ptr<SQLRow> row;
+        while ((row = res->nextRow())) {
+            titles.emplace_back(row->col_int(0, INVALID_OBJECT_ID), row->col(1));
+        }
+    }
+    for (std::size_t start = 0; start < titles.size(); start += MAX_INSERT_ROWS) {
+        auto end = std::min(titles.size(), start + MAX_INSERT_ROWS);
+        std::vector<std::string> cases;
+        std::vector<int> ids;
+        for (auto i = start; i < end; i++) {
+            cases.push_back(fmt::format("WHEN {} THEN {}", titles.at(i).first, quote(makeSortKey(titles.at(i).second, sortArticles))));
+            ids.push_back(titles.at(i).first);
+        }
+        _exec(fmt::format("UPDATE {0} SET {1} = CASE {2} {3} END WHERE {2} IN ({4})",
+            identifier(CDS_OBJECT_TABLE), identifier("sort_key"), identifier("id"), fmt::join(cases, " "), fmt::join(ids, ",")));
+    }
+    storeInternalSetting("sort_key", keySetting);
+    log_info("'{}': Computed {} sort keys", CDS_OBJECT_TABLE, titles.size());
+}
+
 // column resources is dropped in DBVERSION 13
 bool SQLDatabase::doResourceMigration()
 {
@@ -40,17 +40,27 @@
 #include "sql_format.h"
 
 #include <array>
+#include <atomic>
+#include <chrono>
+#include <future>
 #include <mutex>
+#include <optional>
+#include <set>
+#include <unordered_map>
 #include <unordered_set>
 #include <utility>
 
 // forward declarations
 class CdsContainer;
 class CdsResource;
+class ObjectCache;
+class QueryStats;
+class SearchCache;
 class SQLResult;
 class SQLEmitter;
+struct SearchIndex;
 
-#define DBVERSION 23
+#define DBVERSION 26
 
 #define CDS_OBJECT_TABLE "mt_cds_object"
 #define INTERNAL_SETTINGS_TABLE "mt_internal_setting"
@@ -60,26 +70,39 @@ class SQLEmitter;
 #define CONFIG_VALUE_TABLE "grb_config_value"
 #define CLIENTS_TABLE "grb_client"
 #define PLAYSTATUS_TABLE "grb_playstatus"
+#define ANCESTOR_TABLE "grb_cds_ancestor"
+#define SEARCH_INDEX_META_TABLE "grb_search_metadata"
+#define SEARCH_INDEX_TITLE_TABLE "grb_search_title"
 
 class SQLRow {
 public:
     virtual ~SQLRow() = default;
     /// \brief Returns true if the column index contains the value NULL
-    bool isNullOrEmpty(int index) const
+    virtual bool isNullOrEmpty(int index) const
     {
         const char* c = col_c_str(index);
         return c == nullptr || *c == '\0';
     }
     /// \brief Return the value of column index as a string value
     std::string col(int index) const
+    {
+        return std::string(col_view(index));
+    }
+    /// \brief Return the text of column index, only valid as long as the row exists
+    virtual std::string_view col_view(int index) const
     {
         const char* c = col_c_str(index);
         if (!c)
             return {};
         return { c };
     }
+    /// \brief Return the bytes of blob column index including zero bytes, only valid as long as the row exists
+    virtual std::string_view col_blob(int index) const
+    {
+        return col_view(index);
+    }
     /// \brief Return the value of column index as an integer value
-    int col_int(int index, int null_value) const
+    virtual int col_int(int index, int null_value) const
     {
         const char* c = col_c_str(index);
         if (!c || *c == '\0')
@@ -87,7 +110,7 @@ public:
         return std::atoi(c);
     }
     /// \brief Return the value of column index as an integer value
-    long long col_long(int index, long long null_value) const
+    virtual long long col_long(int index, long long null_value) const
     {
         const char* c = col_c_str(index);
         if (!c || *c == '\0')
@@ -101,6 +124,11 @@ class SQLResult {
 public:
     virtual ~SQLResult() = default;
     virtual std::unique_ptr<SQLRow> nextRow() = 0;
+    /// \brief Number of rows available
+    ///
+    /// Results read on demand (sqlite3 read connections) report the rows read so far. The first batch
+    /// is read with the select, so the value is 0 only for empty results. Use it to test for rows
+    /// or as size hint, not as total.
     virtual unsigned long long getNumRows() const = 0;
 };
 
@@ -123,14 +151,28 @@ public:
     virtual void beginTransaction(std::string_view tName) { }
     virtual void rollback(std::string_view tName) { }
     virtual void commit(std::string_view tName) { }
+    // hooks for transactions of methods that only read, backends with snapshot reads may skip them
+    virtual void beginReadTransaction(std::string_view tName) { beginTransaction(tName); }
+    virtual void commitReadTransaction(std::string_view tName) { commit(tName); }
 
     virtual void del(std::string_view tableName, const std::string& clause, const std::vector<int>& ids) = 0;
     virtual void exec(std::string_view tableName, const std::string& query, int objId) = 0;
     virtual int exec(const std::string& query, bool getLastInsertId = false) = 0;
     virtual void execOnly(const std::string& query) = 0;
+    /// \brief Queue a statement whose result the caller does not need to wait for
+    ///
+    /// The statement runs after all statements queued before. Backends may commit
+    /// several queued statements together. The default implementation runs it immediately.
+    virtual std::future<void> execAsync(const std::string& query);
     virtual std::shared_ptr<SQLResult> select(const std::string& query) = 0;
+    /// \brief Run a select statement with positional placeholders (?) bound to params
+    ///
+    /// Backends may keep the compiled statement for the query string, so the query text
+    /// must not contain any values. The default implementation falls back to quoting.
+    virtual std::shared_ptr<SQLResult> selectPrepared(const std::string& query, const std::vector<SQLParam>& params);
 
     void addObject(const std::shared_ptr<CdsObject>& obj, int* changedContainer) override;
+    void addObjects(const std::vector<std::shared_ptr<CdsObject>>& objects) override;
     void updateObject(const std::shared_ptr<CdsObject>& obj, int* changedContainer) override;
 
     std::shared_ptr<CdsObject> loadObject(int objectID) override;
@@ -151,6 +193,9 @@ public:
     /* accounting methods */
     long long getFileStats(const StatsParam& stats) override;
     std::map<std::string, long long> getGroupStats(const StatsParam& stats) override;
+    std::map<std::string, std::string> getStatus() override;
+    std::vector<std::map<std::string, std::string>> getQueryStats(std::size_t count) override;
+    std::vector<std::map<std::string, std::string>> getSlowQueries() override;
 
     std::vector<std::shared_ptr<CdsObject>> browse(BrowseParam& param) override;
     std::vector<std::shared_ptr<CdsObject>> search(SearchParam& param) override;
@@ -161,6 +206,7 @@ public:
     std::vector<std::shared_ptr<CdsObject>> findObjectByContentClass(const std::string& contentClass, const std::string& group) override;
     std::shared_ptr<CdsObject> findObjectByPath(const fs::path& fullpath, const std::string& group, DbFileType fileType = DbFileType::Auto) override;
     int findObjectIDByPath(const fs::path& fullpath, DbFileType fileType = DbFileType::Auto) override;
+    std::unordered_map<std::string, FileState> getFileStates(int containerId) override;
     std::string incrementUpdateIDs(const std::unordered_set<int>& ids) override;
 
     fs::path buildContainerPath(int parentID, const std::string& title) override;
@@ -204,6 +250,12 @@ public:
 
     int insert(std::string_view tableName, const std::vector<SQLIdentifier>& fields, const std::vector<std::string>& values, bool getLastInsertId = false, bool warnOnly = false);
     void insertMultipleRows(std::string_view tableName, const std::vector<SQLIdentifier>& fields, const std::vector<std::vector<std::string>>& valuesets);
+    /// \brief insert rows with multi row statements and return the generated ids in the order of valuesets
+    std::vector<int> insertMultipleRowsGetIds(std::string_view tableName, const std::vector<SQLIdentifier>& fields, const std::vector<std::vector<std::string>>& valuesets);
+    /// \brief id of the first row of a multi row insert, insertId is the value returned by exec
+    ///
+    /// Sqlite reports the id of the last row, the rows of one statement get consecutive ids.
+    virtual int firstInsertId(int insertId, std::size_t rowCount) const { return insertId - static_cast<int>(rowCount) + 1; }
     template <typename T>
     void updateRow(std::string_view tableName, const std::vector<ColumnUpdate>& values, std::string_view key, const T& value);
     void deleteAll(std::string_view tableName);
@@ -223,27 +275,83 @@ protected:
     /// \brief Add a column to resource table for each defined resource attribute
     void prepareResourceTable(std::string_view addColumnCmd);
 
+    /// \brief read metadata fields to store in columns of the object table from config
+    void initPromotedMetadata();
+    /// \brief Add and fill a column of the object table for each promoted metadata field
+    void preparePromotedColumns(std::string_view addColumnCmd, std::string_view addIndexCmd);
+    /// \brief compute sort keys of all objects if the articles changed or after the upgrade (DBVERSION 26)
+    void prepareSortKeys();
+
+    /// \brief recompute stored child counts of all containers and correct deviations (DBVERSION 24)
+    void checkChildCounts();
+
     /// \brief migrate resources from mt_cds_objects to grb_resource before removing the column (DBVERSION 13)
     bool doResourceMigration();
     void migrateResources(int objectId, const std::string& resourcesStr);
 
+    /// \brief fill grb_cds_ancestor from the parent ids of all objects (DBVERSION 25)
+    bool doAncestorMigration();
+
     /// \brief returns a fmt-printable identifier name
     SQLIdentifier identifier(const std::string& name) const { return { name, table_quote_begin, table_quote_end }; }
 
+    /// \brief select list returning the sort keys of orderTerms as SQL literals
+    static std::string getSortKeyColumns(const std::vector<std::string>& orderTerms);
+    /// \brief condition for rows sorted after the keys of the cursor
+    static std::string getSeekCondition(const std::vector<std::string>& orderTerms, const std::vector<std::string>& keys);
+    static std::vector<std::string> getSortKeys(const std::unique_ptr<SQLRow>& row, std::size_t index, std::size_t count);
+
     std::shared_ptr<Mime> mime;
     std::shared_ptr<ConverterManager> converterManager;
 
     char table_quote_begin { '\0' };
     char table_quote_end { '\0' };
     std::array<unsigned int, DBVERSION> hashies;
+    /// \brief server supports COUNT(*) OVER (), set by the driver
+    bool windowFunctions {};
 
     mutable std::recursive_mutex sqlMutex;
     using SqlAutoLock = std::scoped_lock<decltype(sqlMutex)>;
     std::map<int, std::shared_ptr<CdsContainer>> dynamicContainers;
 
-    void upgradeDatabase(unsigned int dbVersion, const std::array<unsigned int, DBVERSION>& hashies, ConfigVal upgradeOption, std::string_view updateVersionCommand, std::string_view addResourceColumnCmd);
+    /// \brief replace placeholders (?) in query by the quoted params
+    std::string bindParams(const std::string& query, const std::vector<SQLParam>& params) const;
+
+    /// \brief Measures the run time of a statement for the query statistics
+    ///
+    /// Create at the start of select and exec of the driver, the statement is recorded when it goes out of scope.
+    class QueryTimer {
+    public:
+        QueryTimer(SQLDatabase* db, const std::string& query, const std::vector<SQLParam>* params = nullptr);
+        ~QueryTimer();
+
+        QueryTimer(const QueryTimer&) = delete;
+        QueryTimer& operator=(const QueryTimer&) = delete;
+
+        /// \brief record duration instead of the time since construction, used by drivers that queue statements
+        void setDuration(std::chrono::microseconds duration) { this->duration = duration; }
+
+    private:
+        SQLDatabase* db;
+        const std::string& query;
+        const std::vector<SQLParam>* params;
+        std::chrono::steady_clock::time_point start;
+        std::optional<std::chrono::microseconds> duration;
+        /// \brief statements failing with an exception are not recorded
+        int exceptions;
+    };
+
+    /// \brief plan of a statement as text, empty if the driver cannot explain statements
+    virtual std::string explain(const std::string& query, const std::vector<SQLParam>* params) { return {}; }
+
+    void upgradeDatabase(unsigned int dbVersion, const std::array<unsigned int, DBVERSION>& hashies, ConfigVal upgradeOption, std::string_view updateVersionCommand, std::string_view addResourceColumnCmd, std::string_view addPromotedColumnCmd, std::string_view addPromotedIndexCmd);
     virtual void _exec(const std::string& query) = 0;
 
+    /// \brief properties that can be stored in a full text index
+    static std::vector<std::string> getSearchIndexProperties();
+    /// \brief use full text index for search, nullptr resets to plain LIKE conditions
+    void setSearchIndex(std::shared_ptr<SearchIndex> searchIndex);
+
 private:
     std::string sql_browse_columns;
     std::string sql_browse_query;
@@ -253,19 +361,59 @@ private:
     std::string sql_meta_query;
     std::string sql_autoscan_query;
     std::string sql_resource_query;
+    /// \brief Prepared statements for the most frequent lookups
+    std::string sql_object_by_id_stmt;
+    std::string sql_object_by_service_id_stmt;
+    std::string sql_object_by_location_stmt;
+    std::string sql_meta_by_item_stmt;
+    std::string sql_resource_by_item_stmt;
+    std::string sql_playstatus_stmt;
+    std::string sql_playstatus_query;
     std::string addResourceColumnCmd;
     /// \brief List of column names to be used in insert and update to ensure correct order of columns
     // only columns listed here are added to the insert and update statements
     std::map<std::string, std::vector<std::string>> tableColumnOrder;
+    /// \brief metadata fields stored in columns of the object table with their column name
+    std::vector<std::pair<std::string, std::string>> promotedMetadata;
+    /// \brief leading words ignored by the sort key of titles
+    std::vector<std::string> sortArticles;
+    /// \brief recently loaded objects, nullptr if disabled
+    std::shared_ptr<ObjectCache> objectCache;
+    /// \brief ordered ids of recent searches, nullptr if disabled
+    std::shared_ptr<SearchCache> searchCache;
+    /// \brief latency of statements by shape and recent slow statements, nullptr before init
+    std::shared_ptr<QueryStats> queryStats;
+
+    /// \brief count run time of statement and log it with its plan if it is slow
+    void recordQuery(const std::string& query, const std::vector<SQLParam>* params, std::chrono::microseconds duration);
 
     /// \brief Configuration content for dynamic folders
     std::shared_ptr<DynamicContentList> dynamicContentList;
     bool dynamicContentEnabled;
 
-    std::shared_ptr<CdsObject> createObjectFromRow(const std::string& group, const std::unique_ptr<SQLRow>& row);
-    std::shared_ptr<CdsObject> createObjectFromSearchRow(const std::string& group, const std::unique_ptr<SQLRow>& row);
+    /// \brief Metadata, resources and play status of a page of objects, loaded with one query per table
+    class ObjectDetails {
+    public:
+        std::vector<std::pair<std::string, std::string>> getMetaData(int objectId) const;
+        std::vector<std::shared_ptr<CdsResource>> getResources(int objectId) const;
+        std::shared_ptr<ClientStatusDetail> getPlayStatus(int objectId) const;
+
+    private:
+        std::unordered_map<int, std::vector<std::pair<std::string, std::string>>> metaData;
+        std::unordered_map<int, std::vector<std::shared_ptr<CdsResource>>> resources;
+        std::unordered_map<int, std::shared_ptr<ClientStatusDetail>> playStatus;
+
+        friend class SQLDatabase;
+    };
+
+    /// \brief Create object from browse row, details are loaded by object if not supplied
+    std::shared_ptr<CdsObject> createObjectFromRow(const std::string& group, const std::unique_ptr<SQLRow>& row, const ObjectDetails* details = nullptr);
+    std::shared_ptr<CdsObject> createObjectFromSearchRow(const std::string& group, const std::unique_ptr<SQLRow>& row, const ObjectDetails* details = nullptr);
     std::vector<std::pair<std::string, std::string>> retrieveMetaDataForObject(int objectId);
     std::vector<std::shared_ptr<CdsResource>> retrieveResourcesForObject(int objectId);
+    /// \brief Load metadata and resources of objectIds and play status of itemIds in group
+    ObjectDetails retrieveObjectDetails(const std::string& group, std::vector<int> objectIds, const std::vector<int>& itemIds);
+    std::shared_ptr<CdsResource> createResourceFromRow(const std::unique_ptr<SQLRow>& row, std::size_t resId);
 
     enum class Operation {
         Insert,
@@ -297,10 +445,32 @@ private:
     void generateMetaDataDBOperations(const std::shared_ptr<CdsObject>& obj, Operation op, std::vector<AddUpdateTable>& operations) const;
     void generateResourceDBOperations(const std::shared_ptr<CdsObject>& obj, Operation op, std::vector<AddUpdateTable>& operations);
 
+    /// \brief column names and quoted values of the row to insert
+    std::pair<std::vector<std::string>, std::vector<std::string>> rowForInsert(const std::shared_ptr<CdsObject>& obj, const AddUpdateTable& addUpdateTable) const;
     std::string sqlForInsert(const std::shared_ptr<CdsObject>& obj, const AddUpdateTable& addUpdateTable) const;
     std::string sqlForUpdate(const std::shared_ptr<CdsObject>& obj, const AddUpdateTable& addUpdateTable) const;
     std::string sqlForDelete(const std::shared_ptr<CdsObject>& obj, const AddUpdateTable& addUpdateTable) const;
 
+    /// \brief number of child containers and items of a container
+    struct ChildCounts {
+        int containers {};
+        int items {};
+    };
+    static void addChildCount(ChildCounts& counts, int objectType, int count);
+    /// \brief recompute the stored child counts of the parent containers from their children, used to repair the counts
+    void updateChildCounts(const std::set<int>& parentIds);
+    /// \brief add the changes of child counts to the stored counts of the parent containers
+    ///
+    /// Each parent is updated by one statement, so the counts stay right without a transaction around the change of the children.
+    void changeChildCounts(const std::map<int, ChildCounts>& changes);
+
+    /// \brief ancestors of the objects from the ancestor table
+    std::map<int, std::vector<int>> getAncestors(const std::vector<int>& objectIds);
+    /// \brief add rows of a new object to the ancestor table
+    void addAncestors(int objectId, int parentId);
+    /// \brief replace the ancestors of an object and its descendants after it was moved to parentId
+    void moveAncestors(int objectId, int parentId);
+
     /* helper for removeObject(s) */
     void _removeObjects(const std::vector<std::int32_t>& objectIDs);
 
@@ -354,7 +524,8 @@ protected:
     }
 
     bool use_transaction;
-    bool inTransaction {};
+    /// \brief set by the thread that runs the transaction, read by all threads
+    std::atomic<bool> inTransaction {};
 };
 
 #endif // __SQL_STORAGE_H__
@@ -30,6 +30,9 @@
 #include <fmt/ranges.h>
 #endif
 
+#include <string>
+#include <variant>
+
 struct SQLIdentifier {
     SQLIdentifier(std::string name, char quote_begin, char quote_end)
         : name(std::move(name))
@@ -52,6 +55,9 @@ struct ColumnUpdate {
     std::string value;
 };
 
+/// \brief Value bound to a positional placeholder (?) of a prepared statement
+using SQLParam = std::variant<std::nullptr_t, long long, std::string>;
+
 namespace fmt {
 
 template <>
@@ -76,7 +76,7 @@ void SLInitTask::run(sqlite3*& db, Sqlite3Database* sl, bool throwOnError)
     log_debug("Running: init");
     std::string dbFilePath = config->getOption(ConfigVal::SERVER_STORAGE_SQLITE_DATABASE_FILE);
 
-    sqlite3_close(db);
+    sl->closeDatabase(db);
 
     int res = sqlite3_open(dbFilePath.c_str(), &db);
     if (res != SQLITE_OK)
@@ -120,28 +120,35 @@ SLSelectTask::SLSelectTask(const std::string& query)
 void SLSelectTask::run(sqlite3*& db, Sqlite3Database* sl, bool throwOnError)
 {
     log_debug("Running: {}", query);
-    pres = std::make_shared<Sqlite3Result>();
 
-    char* err = nullptr;
-    int ret = sqlite3_get_table(
-        db,
-        query,
-        &pres->table,
-        &pres->nrow,
-        &pres->ncolumn,
-        &err);
-    std::string error;
-    if (err) {
-        log_debug(err);
-        error = err;
-        sqlite3_free(err);
-    }
+    sqlite3_stmt* stmt = nullptr;
+    int ret = sqlite3_prepare_v2(db, query, -1, &stmt, nullptr);
     if (ret != SQLITE_OK) {
-        throw DatabaseException("", sl->handleError(query, error, db, ret));
+        sqlite3_finalize(stmt);
+        throw DatabaseException("", sl->handleError(query, "prepare failed", db, ret));
     }
 
-    pres->row = pres->table;
-    pres->cur_row = 0;
+    // no statement may stay open while the following tasks write
+    pres = std::make_shared<Sqlite3Result>(sl, stmt, false);
+    pres->fetchAll(db);
+}
+
+/* SLStatementTask */
+SLStatementTask::SLStatementTask(std::string query, std::vector<SQLParam> params)
+    : query(std::move(query))
+    , params(std::move(params))
+{
+}
+
+void SLStatementTask::run(sqlite3*& db, Sqlite3Database* sl, bool throwOnError)
+{
+    log_debug("Running: {}", query);
+    auto stmt = sl->getStatement(db, query);
+    sl->bindStatement(db, stmt, query, params);
+
+    // cached statements are read completely, they may be used again while this result is in use
+    pres = std::make_shared<Sqlite3Result>(sl, stmt, true);
+    pres->fetchAll(db);
 }
 
 /* SLExecTask */
@@ -185,6 +192,45 @@ void SLExecTask::run(sqlite3*& db, Sqlite3Database* sl, bool throwOnError)
     contamination = true;
 }
 
+/* SLWriteTask */
+SLWriteTask::SLWriteTask(std::string query)
+    : query(std::move(query))
+{
+}
+
+void SLWriteTask::run(sqlite3*& db, Sqlite3Database* sl, bool throwOnError)
+{
+    log_debug("Running: {}", query);
+    char* err;
+    int ret = sqlite3_exec(
+        db,
+        query.c_str(),
+        nullptr,
+        nullptr,
+        &err);
+    std::string error;
+    if (err) {
+        error = err;
+        sqlite3_free(err);
+    }
+    contamination = true;
+    if (ret != SQLITE_OK)
+        throw DatabaseException("", sl->handleError(query, error, db, ret));
+}
+
+void SLWriteTask::sendSignal()
+{
+    if (!is_running())
+        return;
+    if (error.empty()) {
+        done.set_value();
+    } else {
+        log_warning("Failed to execute queued write\n{}", error);
+        done.set_exception(std::make_exception_ptr(DatabaseException("", error)));
+    }
+    SLTask::sendSignal();
+}
+
 /* SLBackupTask */
 SLBackupTask::SLBackupTask(std::shared_ptr<Config> config, bool restore)
     : config(std::move(config))
@@ -194,25 +240,65 @@ SLBackupTask::SLBackupTask(std::shared_ptr<Config> config, bool restore)
 {
 }
 
+SLBackupTask::~SLBackupTask()
+{
+    finish();
+}
+
+void SLBackupTask::finish()
+{
+    if (backup) {
+        sqlite3_backup_finish(backup);
+        backup = nullptr;
+    }
+    if (backupDb) {
+        sqlite3_close(backupDb);
+        backupDb = nullptr;
+    }
+}
+
 void SLBackupTask::run(sqlite3*& db, Sqlite3Database* sl, bool throwOnError)
 {
     log_debug("Running: backup");
 
     if (!restore) {
-        try {
-            fs::copy(
-                dbFile.getPath(),
-                dbBackupFile.getPath(),
-                fs::copy_options::overwrite_existing);
+        if (!backup) {
+            if (sqlite3_open(dbBackupFile.getPath().c_str(), &backupDb) != SQLITE_OK) {
+                log_error("error while making sqlite3 backup: could not open {}: {}", dbBackupFile.getPath().c_str(), sqlite3_errmsg(backupDb));
+                finish();
+                return;
+            }
+            backup = sqlite3_backup_init(backupDb, "main", db, "main");
+            if (!backup) {
+                log_error("error while making sqlite3 backup: {}", sqlite3_errmsg(backupDb));
+                finish();
+                return;
+            }
+        }
+        // changes made through db while the backup is in progress are copied by the next steps
+        int res = sqlite3_backup_step(backup, SQLITE3_BACKUP_STEP_PAGES);
+        pageCount = sqlite3_backup_pagecount(backup);
+        remaining = sqlite3_backup_remaining(backup);
+        busySteps = (res == SQLITE_BUSY || res == SQLITE_LOCKED) ? busySteps + 1 : 0;
+        if (res == SQLITE_OK || (busySteps > 0 && busySteps < SQLITE3_BACKUP_MAX_BUSY)) {
+            log_debug("sqlite3 backup {} of {} pages remaining", remaining, pageCount);
+            return;
+        }
+        finish();
+        if (res == SQLITE_DONE) {
             log_debug("sqlite3 backup successful");
-            dbBackupFile.setPermissions();
+            try {
+                dbBackupFile.setPermissions();
+            } catch (const std::runtime_error& e) {
+                log_error("error while making sqlite3 backup: {}", e.what());
+            }
             decontamination = true;
-        } catch (const std::runtime_error& e) {
-            log_error("error while making sqlite3 backup: {}", e.what());
+        } else {
+            log_error("error while making sqlite3 backup: {}", sqlite3_errstr(res));
         }
     } else {
         log_info("trying to restore sqlite3 database from backup...");
-        sqlite3_close(db);
+        sl->closeDatabase(db);
         try {
             fs::copy(
                 dbBackupFile.getPath(),
@@ -229,3 +315,45 @@ void SLBackupTask::run(sqlite3*& db, Sqlite3Database* sl, bool throwOnError)
         log_info("sqlite3 database successfully restored from backup.");
     }
 }
+
+bool SLBackupTask::copyOnOwnConnection()
+{
+    log_debug("Running: backup on own connection");
+
+    sqlite3* source = nullptr;
+    if (sqlite3_open_v2(dbFile.getPath().c_str(), &source, SQLITE_OPEN_READONLY, nullptr) != SQLITE_OK) {
+        log_error("error while making sqlite3 backup: could not open {}: {}", dbFile.getPath().c_str(), sqlite3_errmsg(source));
+        sqlite3_close(source);
+        return false;
+    }
+    if (sqlite3_open(dbBackupFile.getPath().c_str(), &backupDb) != SQLITE_OK) {
+        log_error("error while making sqlite3 backup: could not open {}: {}", dbBackupFile.getPath().c_str(), sqlite3_errmsg(backupDb));
+        finish();
+        sqlite3_close(source);
+        return false;
+    }
+    backup = sqlite3_backup_init(backupDb, "main", source, "main");
+    int res = backup ? SQLITE_OK : sqlite3_errcode(backupDb);
+    while (backup) {
+        // a backup in several steps restarts whenever the main connection writes in between
+        res = sqlite3_backup_step(backup, -1);
+        if ((res != SQLITE_BUSY && res != SQLITE_LOCKED) || ++busySteps >= SQLITE3_BACKUP_MAX_BUSY)
+            break;
+        log_debug("sqlite3 backup waiting for locked database");
+        sqlite3_sleep(SQLITE3_BACKUP_BUSY_SLEEP);
+    }
+    finish();
+    sqlite3_close(source);
+
+    if (res != SQLITE_DONE) {
+        log_error("error while making sqlite3 backup: {}", sqlite3_errstr(res));
+        return false;
+    }
+    log_debug("sqlite3 backup successful");
+    try {
+        dbBackupFile.setPermissions();
+    } catch (const std::runtime_error& e) {
+        log_error("error while making sqlite3 backup: {}", e.what());
+    }
+    return true;
+}
@@ -24,18 +24,27 @@
 #ifndef __SQLITE3_TASK_H__
 #define __SQLITE3_TASK_H__
 
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <future>
 #include <mutex>
 
 #include <sqlite3.h>
 
+#include "database/sql_format.h"
 #include "util/grb_fs.h"
 
+#include <vector>
+
 class Config;
 class Sqlite3Database;
 class Sqlite3Result;
 
 #define SQLITE3_BACKUP_FORMAT "{}.backup"
+#define SQLITE3_BACKUP_STEP_PAGES 256 // number of pages copied by a backup task before other tasks run
+#define SQLITE3_BACKUP_MAX_BUSY 100 // number of consecutive backup steps finding the database locked before the backup fails
+#define SQLITE3_BACKUP_BUSY_SLEEP 50 // milliseconds a backup on its own connection waits for a locked database
 #define SQLITE3_SET_VERSION "INSERT INTO \"mt_internal_setting\" VALUES('db_version', '{}')"
 
 /// \brief A virtual class that represents a task to be done by the sqlite3 thread.
@@ -59,7 +68,7 @@ public:
     bool is_running() const;
 
     /// \brief notify the creator of the task using the supplied pthread_mutex and pthread_cond, that the task is finished
-    void sendSignal();
+    virtual void sendSignal();
 
     void sendSignal(std::string error);
 
@@ -75,6 +84,13 @@ public:
 
     virtual bool checkKey(const std::string& key) const { return true; }
 
+    /// \brief returns true if the task has to be queued again to continue its work
+    virtual bool hasMoreSteps() const { return false; }
+
+    /// \brief time the sqlite3 thread spent running the task, without the wait in the queue
+    std::chrono::microseconds getRunTime() const { return runTime; }
+    void addRunTime(std::chrono::microseconds time) { runTime += time; }
+
 protected:
     /// \brief true as long as the task is not finished
     ///
@@ -88,6 +104,8 @@ protected:
     /// \brief true if this task has backuped the db
     bool decontamination {};
 
+    std::chrono::microseconds runTime {};
+
     std::condition_variable cond;
     mutable std::mutex mutex;
 
@@ -128,6 +146,27 @@ protected:
     std::shared_ptr<Sqlite3Result> pres;
 };
 
+/// \brief A task for the sqlite3 thread to run a cached prepared statement.
+class SLStatementTask : public SLTask {
+public:
+    /// \brief Constructor for the sqlite3 statement task
+    /// \param query The SQL query string with placeholders
+    /// \param params The values to bind to the placeholders, copied as the task may outlive the caller's values
+    SLStatementTask(std::string query, std::vector<SQLParam> params);
+
+    void run(sqlite3*& db, Sqlite3Database* sl, bool throwOnError = true) override;
+    [[nodiscard]] std::shared_ptr<Sqlite3Result> getResult() const { return pres; }
+
+    std::string_view taskType() const override { return "StatementTask"; }
+
+protected:
+    /// \brief The SQL query string, also the key for the statement cache
+    std::string query;
+    std::vector<SQLParam> params;
+    /// \brief The Sqlite3Result
+    std::shared_ptr<Sqlite3Result> pres;
+};
+
 /// \brief A task for the sqlite3 thread to do a SQL exec.
 class SLExecTask : public SLTask {
 public:
@@ -153,21 +192,72 @@ protected:
     std::string eKey;
 };
 
+/// \brief A task for the sqlite3 thread to do a SQL exec without a waiting caller.
+///
+/// Consecutive write tasks in the queue are run in one transaction.
+class SLWriteTask : public SLTask {
+public:
+    /// \brief Constructor for the sqlite3 write task
+    /// \param query The SQL query string, copied as the caller does not wait
+    explicit SLWriteTask(std::string query);
+
+    void run(sqlite3*& db, Sqlite3Database* sl, bool throwOnError = true) override;
+    /// \brief complete the future of the caller, failures are logged as nobody may wait for the result
+    void sendSignal() override;
+    using SLTask::sendSignal;
+    std::future<void> getFuture() { return done.get_future(); }
+
+    std::string_view taskType() const override { return "WriteTask"; }
+
+protected:
+    /// \brief The SQL query string
+    std::string query;
+    std::promise<void> done;
+};
+
 /// \brief A task for the sqlite3 thread to do a SQLite backup.
+///
+/// The backup is copied in steps of SQLITE3_BACKUP_STEP_PAGES pages by the online backup api,
+/// the task is queued again after each step so that other tasks are served in between.
 class SLBackupTask : public SLTask {
 public:
     /// \brief Constructor for the sqlite3 backup task
     SLBackupTask(std::shared_ptr<Config> config, bool restore);
+    ~SLBackupTask() override;
+
+    SLBackupTask(const SLBackupTask&) = delete;
+    SLBackupTask& operator=(const SLBackupTask&) = delete;
 
     void run(sqlite3*& db, Sqlite3Database* sl, bool throwOnError = true) override;
+    bool hasMoreSteps() const override { return backup != nullptr; }
+    /// \brief copy the database on an own connection in the calling thread instead of the sqlite3 thread
+    ///
+    /// All pages are copied in one step from a snapshot of the WAL journal, so writers are not blocked.
+    /// \return true if the backup is complete
+    bool copyOnOwnConnection();
 
     std::string_view taskType() const override { return "BackupTask"; }
 
+    /// \brief number of pages to copy and pages still remaining after the last step, not set by copyOnOwnConnection
+    std::pair<int, int> getProgress() const { return { pageCount, remaining }; }
+
 protected:
+    /// \brief release backup handle and destination database
+    void finish();
+
     std::shared_ptr<Config> config;
     bool restore;
     GrbFile dbFile;
     GrbFile dbBackupFile;
+
+    /// \brief destination database, open while the backup is in progress
+    sqlite3* backupDb {};
+    sqlite3_backup* backup {};
+    /// \brief consecutive steps that found a database locked, the backup fails after SQLITE3_BACKUP_MAX_BUSY
+    int busySteps {};
+    /// \brief progress of the last step, read by other threads
+    std::atomic<int> pageCount {};
+    std::atomic<int> remaining {};
 };
 
 #endif // __SQLITE3_TASK_H__
@@ -17,6 +17,9 @@ CREATE TABLE "mt_cds_object" (
   "service_id" varchar(255) default NULL,
   "last_modified" integer unsigned default NULL,
   "last_updated" integer unsigned default 0,
+  "child_containers" integer NOT NULL default 0,
+  "child_items" integer NOT NULL default 0,
+  "sort_key" varchar(255) default NULL,
   CONSTRAINT "cds_object_ibfk_1" FOREIGN KEY ("ref_id") REFERENCES "mt_cds_object" ("id") ON DELETE CASCADE ON UPDATE CASCADE,
   CONSTRAINT "cds_object_ibfk_2" FOREIGN KEY ("parent_id") REFERENCES "mt_cds_object" ("id") ON DELETE CASCADE ON UPDATE CASCADE
 );
@@ -24,8 +27,8 @@ INSERT INTO "mt_cds_object" (
     id, ref_id, parent_id, object_type, upnp_class, dc_title, flags
 ) VALUES (-1, NULL, -1, 0, NULL, NULL, 9);
 INSERT INTO "mt_cds_object" (
-    id, ref_id, parent_id, object_type, upnp_class, dc_title, flags
-) VALUES (0, NULL, -1, 1, 'object.container', 'Root', 9);
+    id, ref_id, parent_id, object_type, upnp_class, dc_title, flags, child_containers
+) VALUES (0, NULL, -1, 1, 'object.container', 'Root', 9, 1);
 INSERT INTO "mt_cds_object" (
     id, ref_id, parent_id, object_type, upnp_class, dc_title, flags
 ) VALUES (1, NULL, 0, 1, 'object.container', 'PC Directory', 9);
@@ -100,6 +103,16 @@ CREATE TABLE "grb_playstatus" (
   PRIMARY KEY ("group", "item_id"),
   CONSTRAINT "grb_played_item" FOREIGN KEY ("item_id") REFERENCES "mt_cds_object" ("id") ON DELETE CASCADE ON UPDATE CASCADE
 );
+CREATE TABLE "grb_cds_ancestor" (
+  "ancestor_id" integer NOT NULL,
+  "object_id" integer NOT NULL,
+  PRIMARY KEY ("ancestor_id", "object_id"),
+  CONSTRAINT "grb_cds_ancestor_fk1" FOREIGN KEY ("ancestor_id") REFERENCES "mt_cds_object" ("id") ON DELETE CASCADE ON UPDATE CASCADE,
+  CONSTRAINT "grb_cds_ancestor_fk2" FOREIGN KEY ("object_id") REFERENCES "mt_cds_object" ("id") ON DELETE CASCADE ON UPDATE CASCADE
+);
+INSERT INTO "grb_cds_ancestor" (
+  "ancestor_id", "object_id"
+) VALUES (0, 1);
 INSERT INTO "mt_internal_setting" VALUES('resource_attribute', '');
 CREATE INDEX "mt_cds_object_ref_id" ON mt_cds_object(ref_id);
 CREATE INDEX "mt_cds_object_parent_id" ON mt_cds_object(parent_id,object_type,dc_title);
@@ -110,4 +123,6 @@ CREATE INDEX "mt_internal_setting_key" ON mt_internal_setting(key);
 CREATE UNIQUE INDEX "mt_autoscan_obj_id" ON mt_autoscan(obj_id);
 CREATE INDEX "mt_cds_object_service_id" ON mt_cds_object(service_id);
 CREATE INDEX "mt_metadata_item_id" ON mt_metadata(item_id);
+CREATE INDEX "grb_cds_ancestor_object_id" ON grb_cds_ancestor(object_id);
+CREATE INDEX "grb_cds_object_sort_key" ON mt_cds_object(parent_id,sort_key);
 COMMIT;
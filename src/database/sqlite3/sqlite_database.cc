@@ -36,11 +36,59 @@
 
 #include "config/config.h"
 #include "config/config_val.h"
+#include "database/search_handler.h"
 #include "exceptions.h"
 #include "sl_task.h"
+#include "util/grb_time.h"
+#include "util/tools.h"
+
+#include <fmt/chrono.h>
+#include <limits>
 
 static constexpr auto sqlite3UpdateVersion = std::string_view(R"(UPDATE "mt_internal_setting" SET "value"='{}' WHERE "key"='db_version' AND "value"='{}')");
 static constexpr auto sqlite3AddResourceAttr = std::string_view(R"(ALTER TABLE "grb_cds_resource" ADD COLUMN "{}" varchar(255) default NULL)");
+static constexpr auto sqlite3AddPromotedMeta = std::string_view(R"(ALTER TABLE "mt_cds_object" ADD COLUMN "{}" text default NULL)");
+static constexpr auto sqlite3AddPromotedIndex = std::string_view(R"(CREATE INDEX "grb_cds_object_{0}" ON "mt_cds_object"("{0}"))");
+
+// full text index with trigram tokenizer answers LIKE '%...%', tables are kept in sync by triggers, format index 0: list of indexed properties
+static constexpr auto sqlite3CreateSearchIndex = std::string_view(R"(
+CREATE VIRTUAL TABLE "grb_search_metadata" USING fts5("property_value", content='mt_metadata', content_rowid='id', tokenize='trigram');
+CREATE VIRTUAL TABLE "grb_search_title" USING fts5("dc_title", content='mt_cds_object', content_rowid='id', tokenize='trigram');
+CREATE TRIGGER "grb_search_metadata_ai" AFTER INSERT ON "mt_metadata" WHEN new."property_name" IN ({0}) BEGIN
+  INSERT INTO "grb_search_metadata"(rowid, "property_value") VALUES (new."id", new."property_value");
+END;
+CREATE TRIGGER "grb_search_metadata_ad" AFTER DELETE ON "mt_metadata" WHEN old."property_name" IN ({0}) BEGIN
+  INSERT INTO "grb_search_metadata"("grb_search_metadata", rowid, "property_value") VALUES ('delete', old."id", old."property_value");
+END;
+CREATE TRIGGER "grb_search_metadata_au" AFTER UPDATE ON "mt_metadata" BEGIN
+  INSERT INTO "grb_search_metadata"("grb_search_metadata", rowid, "property_value") SELECT 'delete', old."id", old."property_value" WHERE old."property_name" IN ({0});
+  INSERT INTO "grb_search_metadata"(rowid, "property_value") SELECT new."id", new."property_value" WHERE new."property_name" IN ({0});
+END;
+CREATE TRIGGER "grb_search_title_ai" AFTER INSERT ON "mt_cds_object" BEGIN
+  INSERT INTO "grb_search_title"(rowid, "dc_title") VALUES (new."id", new."dc_title");
+END;
+CREATE TRIGGER "grb_search_title_ad" AFTER DELETE ON "mt_cds_object" BEGIN
+  INSERT INTO "grb_search_title"("grb_search_title", rowid, "dc_title") VALUES ('delete', old."id", old."dc_title");
+END;
+CREATE TRIGGER "grb_search_title_au" AFTER UPDATE OF "dc_title" ON "mt_cds_object" BEGIN
+  INSERT INTO "grb_search_title"("grb_search_title", rowid, "dc_title") VALUES ('delete', old."id", old."dc_title");
+  INSERT INTO "grb_search_title"(rowid, "dc_title") VALUES (new."id", new."dc_title");
+END;
+INSERT INTO "grb_search_metadata"(rowid, "property_value") SELECT "id", "property_value" FROM "mt_metadata" WHERE "property_name" IN ({0});
+INSERT INTO "grb_search_title"(rowid, "dc_title") SELECT "id", "dc_title" FROM "mt_cds_object";
+)");
+static constexpr auto sqlite3DropSearchIndex = std::string_view(R"(
+DROP TRIGGER IF EXISTS "grb_search_metadata_ai";
+DROP TRIGGER IF EXISTS "grb_search_metadata_ad";
+DROP TRIGGER IF EXISTS "grb_search_metadata_au";
+DROP TRIGGER IF EXISTS "grb_search_title_ai";
+DROP TRIGGER IF EXISTS "grb_search_title_ad";
+DROP TRIGGER IF EXISTS "grb_search_title_au";
+DROP TABLE IF EXISTS "grb_search_metadata";
+DROP TABLE IF EXISTS "grb_search_title";
+)");
+static constexpr auto sqlite3SearchIndexMeta = std::string_view(R"(SELECT "item_id" FROM "mt_metadata" WHERE "property_name" = '{0}' AND "id" IN (SELECT rowid FROM "grb_search_metadata" WHERE "property_value" LIKE {1}))");
+static constexpr auto sqlite3SearchIndexTitle = std::string_view(R"(SELECT rowid FROM "grb_search_title" WHERE "dc_title" LIKE {0})");
 
 #define DELETE_CACHE_MAX_TIME 60 // drop cache if last delete was more than 60 secs ago
 #define DELETE_CACHE_RED_SIZE 0.2 // reduce cache to 80% of max entries
@@ -50,19 +98,29 @@ Sqlite3Database::Sqlite3Database(const std::shared_ptr<Config>& config, const st
     , timer(std::move(timer))
     , shutdownAttempts(this->config->getIntOption(ConfigVal::SERVER_STORAGE_SQLITE_SHUTDOWN_ATTEMPTS))
 {
+    // read connections and backups on an own connection require WAL journal, other journals would block the writer
+    if (toLower(this->config->getOption(ConfigVal::SERVER_STORAGE_SQLITE_JOURNALMODE)) == "wal") {
+        readConnectionCount = this->config->getIntOption(ConfigVal::SERVER_STORAGE_SQLITE_READ_CONNECTIONS);
+        // without read connections the database is locked exclusively, so no other connection can read it
+        backupOnOwnConnection = readConnectionCount > 0;
+    }
+
     table_quote_begin = '"';
     table_quote_end = '"';
+    // window functions were added in sqlite 3.25
+    windowFunctions = sqlite3_libversion_number() >= 3025000;
 
     // if sqlite3.sql or sqlite3-upgrade.xml is changed hashies have to be updated
-    hashies = { 2195679403, // index 0 is used for create script sqlite3.sql = Version 1
+    hashies = { 544501875, // index 0 is used for create script sqlite3.sql = Version 1
         778996897, 3362507034, 853149842, 4035419264, 3497064885, 974692115, 119767663, 3167732653, 2427825904, 3305506356, // upgrade 2-11
         43189396, 2767540493, 2512852146, 1273710965, 319062951, 3593597366, 1028160353, 881071639, 1989518047, 3743992560, // upgrade 12-21
-        3135921396, 3108208 };
+        3135921396, 3108208, 2968675623, 2659403917, 406894767 };
 }
 
 void Sqlite3Database::prepare()
 {
-    _exec("PRAGMA locking_mode = EXCLUSIVE");
+    // exclusive locking prevents a second server on the same file but also shared access by read connections
+    _exec(fmt::format("PRAGMA locking_mode = {}", readConnectionCount > 0 ? "NORMAL" : "EXCLUSIVE"));
     _exec("PRAGMA foreign_keys = ON");
     _exec(fmt::format("PRAGMA journal_mode = {}", config->getOption(ConfigVal::SERVER_STORAGE_SQLITE_JOURNALMODE)));
     exec(fmt::format("PRAGMA synchronous = {}", config->getIntOption(ConfigVal::SERVER_STORAGE_SQLITE_SYNCHRONOUS)));
@@ -163,10 +221,12 @@ void Sqlite3Database::init()
     std::string dbVersion = prepareDatabase(dbFilePath, dbFile);
 
     try {
-        upgradeDatabase(std::stoul(dbVersion), hashies, ConfigVal::SERVER_STORAGE_SQLITE_UPGRADE_FILE, sqlite3UpdateVersion, sqlite3AddResourceAttr);
+        upgradeDatabase(std::stoul(dbVersion), hashies, ConfigVal::SERVER_STORAGE_SQLITE_UPGRADE_FILE, sqlite3UpdateVersion, sqlite3AddResourceAttr, sqlite3AddPromotedMeta, sqlite3AddPromotedIndex);
+        checkChildCounts();
         if (config->getBoolOption(ConfigVal::SERVER_STORAGE_SQLITE_BACKUP_ENABLED) && timer) {
             // do a backup now
             auto btask = std::make_shared<SLBackupTask>(config, false);
+            backupTask = btask;
             this->addTask(btask);
             btask->waitForTask();
 
@@ -175,7 +235,9 @@ void Sqlite3Database::init()
             timer->addTimerSubscriber(this, backupInterval, nullptr);
             hasBackupTimer = true;
         }
+        initSearchIndex();
         dbInitDone = true;
+        openReadConnections();
     } catch (const std::runtime_error& e) {
         log_error("prematurely shutting down.");
         shutdown();
@@ -185,6 +247,43 @@ void Sqlite3Database::init()
     initDynContainers();
 }
 
+void Sqlite3Database::initSearchIndex()
+{
+    auto res = select(fmt::format("SELECT COUNT(*) FROM sqlite_master WHERE type = 'table' AND name = {}", quote(SEARCH_INDEX_META_TABLE)));
+    auto row = res ? res->nextRow() : nullptr;
+    bool indexExists = row && row->col_int(0, 0) > 0;
+
+    if (!config->getBoolOption(ConfigVal::SERVER_STORAGE_SQLITE_SEARCH_INDEX)) {
+        // triggers would keep updating an index that is not used
+        if (indexExists) {
+            log_info("Removing full text search index");
+            exec(std::string(sqlite3DropSearchIndex));
+        }
+        return;
+    }
+
+    auto properties = getSearchIndexProperties();
+    if (!indexExists) {
+        std::vector<std::string> quotedProperties;
+        quotedProperties.reserve(properties.size());
+        std::transform(properties.begin(), properties.end(), std::back_inserter(quotedProperties), [this](auto&& property) { return quote(property); });
+        try {
+            log_info("Creating full text search index, this may take a while...");
+            exec(fmt::format(sqlite3CreateSearchIndex, fmt::join(quotedProperties, ", ")));
+        } catch (const std::runtime_error& e) {
+            log_warning("Full text search index requires sqlite3 with FTS5 and trigram tokenizer: {}", e.what());
+            execOnly(std::string(sqlite3DropSearchIndex));
+            return;
+        }
+    }
+
+    auto searchIndex = std::make_shared<SearchIndex>();
+    searchIndex->properties = std::move(properties);
+    searchIndex->metaQuery = sqlite3SearchIndexMeta;
+    searchIndex->titleQuery = sqlite3SearchIndexTitle;
+    setSearchIndex(std::move(searchIndex));
+}
+
 std::shared_ptr<Database> Sqlite3Database::getSelf()
 {
     return shared_from_this();
@@ -221,33 +320,49 @@ Sqlite3DatabaseWithTransactions::Sqlite3DatabaseWithTransactions(const std::shar
 void Sqlite3DatabaseWithTransactions::beginTransaction(std::string_view tName)
 {
     if (use_transaction) {
-        log_debug("BEGIN TRANSACTION {} {}", tName, inTransaction);
+        log_debug("BEGIN TRANSACTION {} {}", tName, inTransaction.load());
         SqlAutoLock lock(sqlMutex);
         StdThreadRunner::waitFor(
             fmt::format("SqliteDatabase.begin {}", tName), [this] { return !inTransaction; }, 100);
         inTransaction = true;
+        transactionOwner = std::this_thread::get_id();
         _exec("BEGIN TRANSACTION");
     }
 }
 
 void Sqlite3DatabaseWithTransactions::rollback(std::string_view tName)
 {
-    if (use_transaction && inTransaction) {
-        log_debug("ROLLBACK {} {}", tName, inTransaction);
+    if (use_transaction && inTransaction && ownsTransaction()) {
+        log_debug("ROLLBACK {} {}", tName, inTransaction.load());
         _exec("ROLLBACK");
+        transactionOwner = std::thread::id();
         inTransaction = false;
     }
 }
 
 void Sqlite3DatabaseWithTransactions::commit(std::string_view tName)
 {
-    if (use_transaction && inTransaction) {
-        log_debug("COMMIT {} {}", tName, inTransaction);
+    if (use_transaction && inTransaction && ownsTransaction()) {
+        log_debug("COMMIT {} {}", tName, inTransaction.load());
         _exec("COMMIT");
+        transactionOwner = std::thread::id();
         inTransaction = false;
     }
 }
 
+void Sqlite3DatabaseWithTransactions::beginReadTransaction(std::string_view tName)
+{
+    // a single select on a read connection sees a consistent snapshot without the write transaction
+    if (!hasReadConnections())
+        beginTransaction(tName);
+}
+
+void Sqlite3DatabaseWithTransactions::commitReadTransaction(std::string_view tName)
+{
+    if (!hasReadConnections())
+        commit(tName);
+}
+
 void Sqlite3Database::handleException(const std::runtime_error& exc, const std::string& lineMessage)
 {
     if (!dbInitDone)
@@ -267,11 +382,37 @@ void Sqlite3Database::handleException(const std::runtime_error& exc, const std::
 
 std::shared_ptr<SQLResult> Sqlite3Database::select(const std::string& query)
 {
+    QueryTimer timer(this, query);
+    auto result = readerSelect(query, nullptr);
+    if (result)
+        return result;
+
     try {
         log_debug("Adding select to Queue: {}", query);
         auto stask = std::make_shared<SLSelectTask>(query);
         addTask(stask);
         stask->waitForTask();
+        timer.setDuration(stask->getRunTime());
+        return stask->getResult();
+    } catch (const std::runtime_error& e) {
+        handleException(e, LINE_MESSAGE);
+        return {};
+    }
+}
+
+std::shared_ptr<SQLResult> Sqlite3Database::selectPrepared(const std::string& query, const std::vector<SQLParam>& params)
+{
+    QueryTimer timer(this, query, &params);
+    auto result = readerSelect(query, &params);
+    if (result)
+        return result;
+
+    try {
+        log_debug("Adding prepared select to Queue: {}", query);
+        auto stask = std::make_shared<SLStatementTask>(query, params);
+        addTask(stask);
+        stask->waitForTask();
+        timer.setDuration(stask->getRunTime());
         return stask->getResult();
     } catch (const std::runtime_error& e) {
         handleException(e, LINE_MESSAGE);
@@ -279,11 +420,179 @@ std::shared_ptr<SQLResult> Sqlite3Database::select(const std::string& query)
     }
 }
 
+std::shared_ptr<SQLResult> Sqlite3Database::readerSelect(const std::string& query, const std::vector<SQLParam>* params)
+{
+    if (readConnectionCount <= 0 || queuedWrites > 0 || !useReadConnection())
+        return nullptr;
+    auto reader = acquireReadConnection();
+    if (!reader)
+        return nullptr;
+
+    sqlite3_stmt* stmt = nullptr;
+    try {
+        log_debug("Running on read connection: {}", query);
+        if (params) {
+            // cached statements are read completely, the connection is returned immediately
+            stmt = getStatement(reader->db, reader->statementCache, query);
+            bindStatement(reader->db, stmt, query, *params);
+        } else {
+            int ret = sqlite3_prepare_v2(reader->db, query.c_str(), static_cast<int>(query.size() + 1), &stmt, nullptr);
+            if (ret != SQLITE_OK) {
+                sqlite3_finalize(stmt);
+                stmt = nullptr;
+                throw DatabaseException("", handleError(query, "prepare failed", reader->db, ret));
+            }
+        }
+    } catch (const std::runtime_error& e) {
+        log_warning("Read connection failed, using sqlite3 thread: {}", e.what());
+        releaseReadConnection(reader);
+        return nullptr;
+    }
+
+    auto result = std::make_shared<Sqlite3Result>(this, stmt, params != nullptr, reader);
+    try {
+        result->fetchRows(reader->db, params ? std::numeric_limits<std::size_t>::max() : SQLITE3_FETCH_SIZE);
+    } catch (const std::runtime_error& e) {
+        // statement and connection are released by the result
+        log_warning("Read connection failed, using sqlite3 thread: {}", e.what());
+        return nullptr;
+    }
+    return result;
+}
+
+Sqlite3ReadConnection* Sqlite3Database::acquireReadConnection()
+{
+    std::scoped_lock<std::mutex> lock(read_mutex);
+    if (!readPoolOpen || idleReadConnections.empty())
+        return nullptr; // the sqlite3 thread is used instead of waiting, a nested select may hold the last connection
+    auto reader = idleReadConnections.back();
+    idleReadConnections.pop_back();
+    return reader;
+}
+
+void Sqlite3Database::releaseReadConnection(Sqlite3ReadConnection* reader)
+{
+    std::scoped_lock<std::mutex> lock(read_mutex);
+    if (readPoolOpen)
+        idleReadConnections.push_back(reader);
+    else
+        closeReadConnection(reader);
+}
+
+void Sqlite3Database::openReadConnections()
+{
+    if (readConnectionCount <= 0)
+        return;
+
+    auto res = select("PRAGMA journal_mode");
+    auto row = res ? res->nextRow() : nullptr;
+    auto journalMode = row ? toLower(row->col(0)) : "";
+    if (journalMode != "wal") {
+        log_warning("sqlite3 journal mode is '{}', read connections require 'wal'", journalMode);
+        readConnectionCount = 0;
+        return;
+    }
+
+    std::string dbFilePath = config->getOption(ConfigVal::SERVER_STORAGE_SQLITE_DATABASE_FILE);
+    std::scoped_lock<std::mutex> lock(read_mutex);
+    for (int i = 0; i < readConnectionCount; i++) {
+        auto reader = std::make_unique<Sqlite3ReadConnection>();
+        int ret = sqlite3_open_v2(dbFilePath.c_str(), &reader->db, SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX, nullptr);
+        if (ret != SQLITE_OK) {
+            log_warning("Could not open sqlite3 read connection {}: {}", i, sqlite3_errmsg(reader->db));
+            closeReadConnection(reader.get());
+            break;
+        }
+        sqlite3_busy_timeout(reader->db, SQLITE3_READ_BUSY_TIMEOUT);
+        idleReadConnections.push_back(reader.get());
+        readConnections.push_back(std::move(reader));
+    }
+    readPoolOpen = !idleReadConnections.empty();
+    log_info("Opened {} sqlite3 read connections", idleReadConnections.size());
+}
+
+void Sqlite3Database::closeReadConnections()
+{
+    std::scoped_lock<std::mutex> lock(read_mutex);
+    readPoolOpen = false;
+    // connections still in use are closed when their result is released
+    for (auto&& reader : idleReadConnections)
+        closeReadConnection(reader);
+    idleReadConnections.clear();
+}
+
+void Sqlite3Database::closeReadConnection(Sqlite3ReadConnection* reader)
+{
+    reader->statementCache.clear();
+    sqlite3_close(reader->db);
+    reader->db = nullptr;
+}
+
+sqlite3_stmt* Sqlite3Database::getStatement(sqlite3* db, StatementCache<sqlite3_stmt*>& cache, const std::string& query)
+{
+    auto stmt = cache.get(query);
+    if (stmt)
+        return stmt;
+
+    int ret = sqlite3_prepare_v2(db, query.c_str(), static_cast<int>(query.size() + 1), &stmt, nullptr);
+    if (ret != SQLITE_OK) {
+        sqlite3_finalize(stmt);
+        throw DatabaseException("", handleError(query, "prepare failed", db, ret));
+    }
+    cache.put(query, stmt);
+    return stmt;
+}
+
+void Sqlite3Database::bindStatement(sqlite3* db, sqlite3_stmt* stmt, const std::string& query, const std::vector<SQLParam>& params)
+{
+    int index = 1;
+    for (auto&& param : params) {
+        int ret;
+        if (std::holds_alternative<long long>(param)) {
+            ret = sqlite3_bind_int64(stmt, index, std::get<long long>(param));
+        } else if (std::holds_alternative<std::string>(param)) {
+            auto&& text = std::get<std::string>(param);
+            ret = sqlite3_bind_text(stmt, index, text.data(), static_cast<int>(text.size()), SQLITE_STATIC);
+        } else {
+            ret = sqlite3_bind_null(stmt, index);
+        }
+        if (ret != SQLITE_OK) {
+            sqlite3_reset(stmt);
+            sqlite3_clear_bindings(stmt);
+            throw DatabaseException("", handleError(query, fmt::format("failed to bind parameter {}", index), db, ret));
+        }
+        index++;
+    }
+}
+
+void Sqlite3Database::clearStatementCache()
+{
+    statementCache.clear();
+}
+
+void Sqlite3Database::closeDatabase(sqlite3*& db)
+{
+    clearStatementCache();
+    if (!db)
+        return;
+    // sqlite3_close fails with SQLITE_BUSY while any statement is not finalized
+    sqlite3_stmt* stmt;
+    while ((stmt = sqlite3_next_stmt(db, nullptr)))
+        sqlite3_finalize(stmt);
+    int ret = sqlite3_close(db);
+    if (ret != SQLITE_OK) {
+        log_error("Failed to close sqlite3 database: {}", sqlite3_errstr(ret));
+        sqlite3_close_v2(db);
+    }
+    db = nullptr;
+}
+
 void Sqlite3Database::del(std::string_view tableName, const std::string& clause, const std::vector<int>& ids)
 {
     auto query = clause.empty() //
         ? fmt::format("DELETE FROM {}", identifier(std::string(tableName))) //
         : fmt::format("DELETE FROM {} WHERE {}", identifier(std::string(tableName)), clause);
+    QueryTimer timer(this, query);
     try {
         log_debug("Adding delete to Queue: {}", query);
         {
@@ -297,6 +606,7 @@ void Sqlite3Database::del(std::string_view tableName, const std::string& clause,
         auto etask = std::make_shared<SLExecTask>(query, false);
         addTask(etask);
         etask->waitForTask();
+        timer.setDuration(etask->getRunTime());
     } catch (const std::runtime_error& e) {
         handleException(e, LINE_MESSAGE);
     }
@@ -304,12 +614,14 @@ void Sqlite3Database::del(std::string_view tableName, const std::string& clause,
 
 void Sqlite3Database::exec(std::string_view tableName, const std::string& query, int objId)
 {
+    QueryTimer timer(this, query);
     try {
         log_debug("Adding query to Queue: {}", query);
         auto eKey = fmt::format("{}_{}", tableName, objId);
         auto etask = std::make_shared<SLExecTask>(query, eKey);
         addTask(etask);
         etask->waitForTask();
+        timer.setDuration(etask->getRunTime());
     } catch (const std::runtime_error& e) {
         handleException(e, LINE_MESSAGE);
     }
@@ -317,11 +629,13 @@ void Sqlite3Database::exec(std::string_view tableName, const std::string& query,
 
 int Sqlite3Database::exec(const std::string& query, bool getLastInsertId)
 {
+    QueryTimer timer(this, query);
     try {
         log_debug("Adding query to Queue: {}", query);
         auto etask = std::make_shared<SLExecTask>(query, getLastInsertId);
         addTask(etask);
         etask->waitForTask();
+        timer.setDuration(etask->getRunTime());
         return getLastInsertId ? etask->getLastInsertId() : -1;
     } catch (const std::runtime_error& e) {
         handleException(e, LINE_MESSAGE);
@@ -329,18 +643,107 @@ int Sqlite3Database::exec(const std::string& query, bool getLastInsertId)
     }
 }
 
+std::string Sqlite3Database::explain(const std::string& query, const std::vector<SQLParam>* params)
+{
+    // unbound placeholders are NULL, which does not change the plan
+    auto res = select(fmt::format("EXPLAIN QUERY PLAN {}", query));
+    std::vector<std::string> lines;
+    std::unique_ptr<SQLRow> row;
+    while (res && (row = res->nextRow())) {
+        lines.push_back(row->col(3));
+    }
+    return fmt::format("{}", fmt::join(lines, "\n"));
+}
+
 void Sqlite3Database::execOnly(const std::string& query)
 {
+    QueryTimer timer(this, query);
     try {
         log_debug("Adding query to Queue: {}", query);
         auto etask = std::make_shared<SLExecTask>(query, false, false);
         addTask(etask);
         etask->waitForTask();
+        timer.setDuration(etask->getRunTime());
     } catch (const std::runtime_error& e) {
         log_error("Failed to execute {}\n{}", query, e.what());
     }
 }
 
+std::future<void> Sqlite3Database::execAsync(const std::string& query)
+{
+    auto wtask = std::make_shared<SLWriteTask>(query);
+    auto result = wtask->getFuture();
+    queuedWrites++;
+    try {
+        log_debug("Adding write to Queue: {}", query);
+        addTask(wtask);
+    } catch (const std::runtime_error& e) {
+        queuedWrites--;
+        wtask->sendSignal(e.what());
+    }
+    return result;
+}
+
+void Sqlite3Database::runWriteBatch(sqlite3* db, const std::vector<std::shared_ptr<SLWriteTask>>& batch)
+{
+    // a transaction opened by a caller already groups the writes
+    const bool callerTransaction = !sqlite3_get_autocommit(db);
+    bool ownTransaction = batch.size() > 1 && !callerTransaction && sqlite3_exec(db, "BEGIN TRANSACTION", nullptr, nullptr, nullptr) == SQLITE_OK;
+
+    std::vector<std::string> errors(batch.size());
+    for (std::size_t i = 0; i < batch.size(); i++) {
+        try {
+            batch.at(i)->run(db, this);
+        } catch (const std::runtime_error& e) {
+            errors.at(i) = e.what();
+        }
+    }
+    dirty = true;
+
+    if (callerTransaction) {
+        // the writes are lost if the caller rolls back, so they are not reported as done before the transaction ends
+        if (transactionWrites.empty()) {
+            transactionRolledBack = false;
+            sqlite3_rollback_hook(db, [](void* self) { static_cast<Sqlite3Database*>(self)->transactionRolledBack = true; }, this);
+        }
+        for (std::size_t i = 0; i < batch.size(); i++)
+            transactionWrites.emplace_back(batch.at(i), std::move(errors.at(i)));
+        return;
+    }
+    if (ownTransaction) {
+        int ret = sqlite3_exec(db, "COMMIT", nullptr, nullptr, nullptr);
+        if (ret != SQLITE_OK) {
+            auto error = handleError("COMMIT", "", db, ret);
+            sqlite3_exec(db, "ROLLBACK", nullptr, nullptr, nullptr);
+            for (auto&& taskError : errors) {
+                if (taskError.empty())
+                    taskError = error;
+            }
+        }
+    }
+    // selects see the writes from now on
+    queuedWrites -= batch.size();
+    for (std::size_t i = 0; i < batch.size(); i++) {
+        batch.at(i)->sendSignal(errors.at(i));
+    }
+}
+
+void Sqlite3Database::finishTransactionWrites(sqlite3* db, const std::string& error)
+{
+    if (transactionWrites.empty() || (error.empty() && !sqlite3_get_autocommit(db)))
+        return;
+    sqlite3_rollback_hook(db, nullptr, nullptr);
+    queuedWrites -= transactionWrites.size();
+    for (auto&& [task, taskError] : transactionWrites) {
+        if (taskError.empty() && !error.empty())
+            taskError = error;
+        else if (taskError.empty() && transactionRolledBack)
+            taskError = "Transaction of queued write was rolled back";
+        task->sendSignal(taskError);
+    }
+    transactionWrites.clear();
+}
+
 void Sqlite3Database::threadProc()
 {
     log_debug("Running thread");
@@ -373,17 +776,45 @@ void Sqlite3Database::threadProc()
                 auto task = std::move(taskQueue.front());
                 taskQueue.pop();
 
+                auto wtask = std::dynamic_pointer_cast<SLWriteTask>(task);
+                if (wtask) {
+                    // collect following writes to commit them together
+                    std::vector<std::shared_ptr<SLWriteTask>> batch { std::move(wtask) };
+                    while (!taskQueue.empty() && batch.size() < SQLITE3_WRITE_BATCH_SIZE) {
+                        auto next = std::dynamic_pointer_cast<SLWriteTask>(taskQueue.front());
+                        if (!next)
+                            break;
+                        batch.push_back(std::move(next));
+                        taskQueue.pop();
+                    }
+                    lock.unlock();
+                    runWriteBatch(db, batch);
+                    lock.lock();
+                    continue;
+                }
+
                 lock.unlock();
                 try {
+                    auto start = std::chrono::steady_clock::now();
                     task->run(db, this, throwOnError(task));
+                    task->addRunTime(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start));
+                    if (task->hasMoreSteps()) {
+                        // queue again behind the tasks that arrived in the meantime
+                        lock.lock();
+                        taskQueue.push(std::move(task));
+                        continue;
+                    }
                     if (task->didContamination())
                         dirty = true;
-                    else if (task->didDecontamination())
+                    else if (task->didDecontamination()) {
                         dirty = false;
+                        lastBackup = currentTime();
+                    }
                     task->sendSignal();
                 } catch (const std::runtime_error& e) {
                     task->sendSignal(e.what());
                 }
+                finishTransactionWrites(db);
                 lock.lock();
             }
 
@@ -402,21 +833,17 @@ void Sqlite3Database::threadProc()
         log_debug("Exiting");
 
         taskQueueOpen = false;
+        finishTransactionWrites(db, "Sorry, sqlite3 thread is shutting down");
         while (!taskQueue.empty()) {
             auto task = std::move(taskQueue.front());
             taskQueue.pop();
+            if (std::dynamic_pointer_cast<SLWriteTask>(task))
+                queuedWrites--;
             task->sendSignal("Sorry, sqlite3 thread is shutting down");
         }
 
-        if (db) {
-            log_debug("closing database");
-            if (sqlite3_close(db) == SQLITE_OK) {
-                log_debug("Closed database");
-            } else {
-                log_error("Closing database failed");
-            }
-            db = nullptr;
-        }
+        log_debug("closing database");
+        closeDatabase(db);
     } catch (const std::runtime_error& e) {
         log_error("Aborting thread {}", e.what());
     }
@@ -426,8 +853,58 @@ void Sqlite3Database::threadProc()
 
 void Sqlite3Database::timerNotify(const std::shared_ptr<Timer::Parameter>& param)
 {
+    std::scoped_lock<std::mutex> lock(backup_mutex);
+    if (!backupTask.expired()) {
+        log_debug("sqlite3 backup still in progress");
+        return;
+    }
     auto btask = std::make_shared<SLBackupTask>(config, false);
-    addTask(btask, true);
+    if (!backupOnOwnConnection) {
+        backupTask = btask;
+        addTask(btask, true);
+        return;
+    }
+    if (!dirty)
+        return;
+    if (backupThread.joinable())
+        backupThread.join();
+    backupTask = btask;
+    // changes after the snapshot of the backup mark the database dirty again
+    dirty = false;
+    backupThread = std::thread([this, btask] {
+        if (btask->copyOnOwnConnection())
+            lastBackup = currentTime();
+        else
+            dirty = true;
+    });
+}
+
+std::map<std::string, std::string> Sqlite3Database::getStatus()
+{
+    auto result = SQLDatabase::getStatus();
+    if (!hasBackupTimer)
+        return result;
+
+    std::shared_ptr<SLBackupTask> btask;
+    {
+        std::scoped_lock<std::mutex> lock(backup_mutex);
+        btask = backupTask.lock();
+    }
+    if (btask) {
+        result["backupState"] = "running";
+        // a backup on an own connection copies all pages in one step
+        if (!backupOnOwnConnection) {
+            auto [pageCount, remaining] = btask->getProgress();
+            result["backupProgress"] = fmt::format("{}%", pageCount > 0 ? (pageCount - remaining) * 100 / pageCount : 0);
+            result["backupPages"] = fmt::format("{}/{}", pageCount - remaining, pageCount);
+        }
+    } else {
+        result["backupState"] = dirty ? "pending" : "current";
+    }
+    auto last = lastBackup.load();
+    if (last.count() > 0)
+        result["backupTime"] = fmt::format("{:%Y-%m-%d %H:%M:%S}", fmt::localtime(last.count()));
+    return result;
 }
 
 void Sqlite3Database::addTask(const std::shared_ptr<SLTask>& task, bool onlyIfDirty)
@@ -450,6 +927,7 @@ void Sqlite3Database::addTask(const std::shared_ptr<SLTask>& task, bool onlyIfDi
 void Sqlite3Database::shutdownDriver()
 {
     log_debug("start");
+    closeReadConnections();
     auto lock = threadRunner->uniqueLockS("shutdown");
     if (!shutdownFlag) {
         shutdownFlag = true;
@@ -461,6 +939,10 @@ void Sqlite3Database::shutdownDriver()
         lock.unlock();
         log_debug("waiting for thread");
         threadRunner->join();
+
+        std::scoped_lock<std::mutex> backupLock(backup_mutex);
+        if (backupThread.joinable())
+            backupThread.join();
     }
     log_debug("end");
 }
@@ -474,34 +956,137 @@ void Sqlite3Database::storeInternalSetting(const std::string& key, const std::st
 
 /* Sqlite3Row */
 
-Sqlite3Row::Sqlite3Row(char** row)
-    : row(row)
+Sqlite3Row::Sqlite3Row(std::vector<Sqlite3Value> row)
+    : row(std::move(row))
 {
 }
 
 char* Sqlite3Row::col_c_str(int index) const
 {
-    return row[index];
+    auto&& value = row[index];
+    if (value.type == SQLITE_NULL)
+        return nullptr;
+    if (value.type == SQLITE_INTEGER && value.text.empty())
+        value.text = fmt::to_string(value.integer);
+    return value.text.data();
+}
+
+bool Sqlite3Row::isNullOrEmpty(int index) const
+{
+    auto&& value = row[index];
+    return value.type == SQLITE_NULL || (value.type != SQLITE_INTEGER && value.text.empty());
+}
+
+std::string_view Sqlite3Row::col_view(int index) const
+{
+    auto&& value = row[index];
+    if (value.type == SQLITE_INTEGER)
+        return col_c_str(index);
+    return value.text;
+}
+
+int Sqlite3Row::col_int(int index, int null_value) const
+{
+    return static_cast<int>(col_long(index, null_value));
+}
+
+long long Sqlite3Row::col_long(int index, long long null_value) const
+{
+    auto&& value = row[index];
+    if (value.type == SQLITE_INTEGER)
+        return value.integer;
+    if (value.type == SQLITE_NULL || value.text.empty())
+        return null_value;
+    return std::atoll(value.text.c_str());
 }
 
 /* Sqlite3Result */
 
+Sqlite3Result::Sqlite3Result(Sqlite3Database* sl, sqlite3_stmt* stmt, bool cached, Sqlite3ReadConnection* reader)
+    : sl(sl)
+    , stmt(stmt)
+    , cached(cached)
+    , reader(reader)
+    , ncolumn(stmt ? sqlite3_column_count(stmt) : 0)
+{
+}
+
 Sqlite3Result::~Sqlite3Result()
 {
-    if (table) {
-        sqlite3_free_table(table);
-        table = nullptr;
+    // only results of a read connection can be dropped before the last row
+    closeStatement();
+}
+
+void Sqlite3Result::fetchRows(sqlite3* db, std::size_t maxRows)
+{
+    values.clear();
+    cur_row = 0;
+    buf_rows = 0;
+    if (!stmt) {
+        closeStatement();
+        return;
+    }
+
+    int ret = SQLITE_DONE;
+    while (buf_rows < maxRows && (ret = sqlite3_step(stmt)) == SQLITE_ROW) {
+        for (int col = 0; col < ncolumn; col++) {
+            auto&& value = values.emplace_back();
+            value.type = sqlite3_column_type(stmt, col);
+            if (value.type == SQLITE_INTEGER) {
+                value.integer = sqlite3_column_int64(stmt, col);
+            } else if (value.type != SQLITE_NULL) {
+                auto data = value.type == SQLITE_BLOB ? sqlite3_column_blob(stmt, col) : sqlite3_column_text(stmt, col);
+                auto size = sqlite3_column_bytes(stmt, col);
+                if (data)
+                    value.text.assign(static_cast<const char*>(data), size);
+                if (value.type != SQLITE_BLOB)
+                    value.type = SQLITE_TEXT;
+            }
+        }
+        buf_rows++;
+    }
+    nrow += buf_rows;
+    if (ret == SQLITE_ROW)
+        return;
+
+    std::string error;
+    if (ret != SQLITE_DONE)
+        error = sl->handleError(sqlite3_sql(stmt), sqlite3_errmsg(db), db, ret);
+    closeStatement();
+    if (!error.empty())
+        throw DatabaseException("", error);
+}
+
+void Sqlite3Result::closeStatement()
+{
+    if (stmt && cached) {
+        // release locks and parameters held by the statement
+        sqlite3_reset(stmt);
+        sqlite3_clear_bindings(stmt);
+    } else if (stmt) {
+        sqlite3_finalize(stmt);
+    }
+    stmt = nullptr;
+    if (reader) {
+        sl->releaseReadConnection(reader);
+        reader = nullptr;
     }
 }
+
 std::unique_ptr<SQLRow> Sqlite3Result::nextRow()
 {
-    if (nrow) {
-        row += ncolumn;
-        cur_row++;
-        if (cur_row <= nrow) {
-            return std::make_unique<Sqlite3Row>(row);
+    if (cur_row >= buf_rows) {
+        if (!stmt || !reader)
+            return nullptr;
+        try {
+            fetchRows(reader->db, SQLITE3_FETCH_SIZE);
+        } catch (const std::runtime_error& e) {
+            log_error("Failed to read rows: {}", e.what());
         }
-        return nullptr;
+        if (cur_row >= buf_rows)
+            return nullptr;
     }
-    return nullptr;
+    auto first = values.begin() + cur_row * ncolumn;
+    cur_row++;
+    return std::make_unique<Sqlite3Row>(std::vector<Sqlite3Value>(std::make_move_iterator(first), std::make_move_iterator(first + ncolumn)));
 }
@@ -36,18 +36,36 @@
 #define __SQLITE3_STORAGE_H__
 
 #include "database/sql_database.h"
+#include "database/statement_cache.h"
 #include "util/thread_runner.h"
 #include "util/timer.h"
 
+#include <atomic>
+#include <limits>
 #include <mutex>
 #include <queue>
+#include <thread>
 #include <sqlite3.h>
+#include <unordered_map>
 
 class Sqlite3Database;
 class Sqlite3Result;
 class SLTask;
+class SLWriteTask;
+class SLBackupTask;
 
 #define DELETE_CACHE_MAX_SIZE 500 // remove entries, if cache has more than 500 (default)
+#define STATEMENT_CACHE_MAX_SIZE 64 // finalize least recently used prepared statement, if cache grows beyond
+#define SQLITE3_FETCH_SIZE 1000 // number of rows read per step of a select
+#define SQLITE3_READ_BUSY_TIMEOUT 1000 // milliseconds a read connection waits for a lock
+#define SQLITE3_WRITE_BATCH_SIZE 100 // maximum number of queued writes run in one transaction
+
+/// \brief Read only connection to run selects outside the sqlite3 thread in WAL mode
+struct Sqlite3ReadConnection {
+    sqlite3* db { nullptr };
+    /// \brief compiled statements by query string
+    StatementCache<sqlite3_stmt*> statementCache { STATEMENT_CACHE_MAX_SIZE, [](sqlite3_stmt* stmt) { sqlite3_finalize(stmt); } };
+};
 
 /// \brief The Database class for using SQLite3
 class Sqlite3Database : public Timer::Subscriber, public SQLDatabase, public std::enable_shared_from_this<SQLDatabase> {
@@ -56,11 +74,27 @@ public:
 
     std::string handleError(const std::string& query, const std::string& error, sqlite3* db, int errorCode);
     void timerNotify(const std::shared_ptr<Timer::Parameter>& param) override;
+    std::map<std::string, std::string> getStatus() override;
+
+    /// \brief get compiled statement for query from cache or prepare it, only to be called by the sqlite3 thread
+    sqlite3_stmt* getStatement(sqlite3* db, const std::string& query) { return getStatement(db, statementCache, query); }
+    /// \brief bind params to the placeholders of stmt
+    void bindStatement(sqlite3* db, sqlite3_stmt* stmt, const std::string& query, const std::vector<SQLParam>& params);
+    /// \brief finalize all cached statements, required before the database is closed
+    void clearStatementCache();
+    /// \brief finalize all statements and close db, only to be called by the sqlite3 thread
+    void closeDatabase(sqlite3*& db);
+    /// \brief return read connection to the pool after the result is read
+    void releaseReadConnection(Sqlite3ReadConnection* reader);
 
 protected:
     void _exec(const std::string& query) override;
     std::string prepareDatabase(const fs::path& dbFilePath, GrbFile& dbFile);
 
+    /// \brief selects may run on a read connection, they cannot see uncommitted changes
+    virtual bool useReadConnection() const { return true; }
+    bool hasReadConnections() const { return readConnectionCount > 0; }
+
 private:
     void prepare();
     void init() override;
@@ -70,22 +104,40 @@ private:
     std::string quote(const std::string& value) const override;
 
     std::shared_ptr<SQLResult> select(const std::string& query) override;
+    std::shared_ptr<SQLResult> selectPrepared(const std::string& query, const std::vector<SQLParam>& params) override;
+    std::string explain(const std::string& query, const std::vector<SQLParam>* params) override;
     void del(std::string_view tableName, const std::string& clause, const std::vector<int>& ids) override;
     void exec(std::string_view tableName, const std::string& query, int objId) override;
     int exec(const std::string& query, bool getLastInsertId = false) override;
     void execOnly(const std::string& query) override;
+    std::future<void> execAsync(const std::string& query) override;
 
     /// \brief Implement common behaviour on exceptions while calling the database
     void handleException(const std::runtime_error& exc, const std::string& lineMessage);
 
     void storeInternalSetting(const std::string& key, const std::string& value) override;
 
+    /// \brief create or drop the full text index used by search
+    void initSearchIndex();
+
+    /// \brief run select on a read connection, returns nullptr if none is available
+    std::shared_ptr<SQLResult> readerSelect(const std::string& query, const std::vector<SQLParam>* params);
+    Sqlite3ReadConnection* acquireReadConnection();
+    void openReadConnections();
+    void closeReadConnections();
+    static void closeReadConnection(Sqlite3ReadConnection* reader);
+    sqlite3_stmt* getStatement(sqlite3* db, StatementCache<sqlite3_stmt*>& cache, const std::string& query);
+
     std::string startupError;
 
     std::unique_ptr<StdThreadRunner> threadRunner;
     void threadProc();
 
     void addTask(const std::shared_ptr<SLTask>& task, bool onlyIfDirty = false);
+    /// \brief run consecutive write tasks in one transaction, only to be called by the sqlite3 thread
+    void runWriteBatch(sqlite3* db, const std::vector<std::shared_ptr<SLWriteTask>>& batch);
+    /// \brief complete the writes that ran in a transaction of a caller once it has ended, only to be called by the sqlite3 thread
+    void finishTransactionWrites(sqlite3* db, const std::string& error = "");
 
     std::shared_ptr<Timer> timer;
 
@@ -102,12 +154,37 @@ private:
     size_t maxDeleteCount { DELETE_CACHE_MAX_SIZE };
     std::chrono::seconds lastDelete;
 
+    /// \brief compiled statements by query string, owned by the sqlite3 thread
+    StatementCache<sqlite3_stmt*> statementCache { STATEMENT_CACHE_MAX_SIZE, [](sqlite3_stmt* stmt) { sqlite3_finalize(stmt); } };
+
+    /// \brief number of read connections, only used with WAL journal
+    int readConnectionCount {};
+    /// \brief writes queued by execAsync and not yet committed, read connections are not used before they are
+    std::atomic<std::size_t> queuedWrites {};
+    /// \brief writes that ran in a transaction of a caller with their errors, they are completed when it is committed or rolled back
+    std::vector<std::pair<std::shared_ptr<SLWriteTask>, std::string>> transactionWrites;
+    /// \brief set by the rollback hook while transactionWrites are pending
+    bool transactionRolledBack {};
+    std::vector<std::unique_ptr<Sqlite3ReadConnection>> readConnections;
+    std::vector<Sqlite3ReadConnection*> idleReadConnections;
+    bool readPoolOpen {};
+    std::mutex read_mutex;
+
     void threadCleanup() override { }
     bool threadCleanupRequired() const override { return false; }
 
-    bool dirty {};
+    /// \brief changes since the last backup, cleared by the backup thread as well
+    std::atomic<bool> dirty {};
     bool dbInitDone {};
     bool hasBackupTimer {};
+    /// \brief timed backups are copied by backupThread on an own connection, only used with WAL journal and read connections
+    bool backupOnOwnConnection {};
+    std::thread backupThread;
+    /// \brief backup in progress, used to report progress and to avoid overlapping backups
+    std::weak_ptr<SLBackupTask> backupTask;
+    std::mutex backup_mutex;
+    /// \brief time of the last completed backup
+    std::atomic<std::chrono::seconds> lastBackup {};
     int sqliteStatus {};
     /// \brief maximum number of attempts to terminate gracefully
     int shutdownAttempts { 5 };
@@ -121,41 +198,82 @@ public:
     void beginTransaction(std::string_view tName) override;
     void rollback(std::string_view tName) override;
     void commit(std::string_view tName) override;
+    void beginReadTransaction(std::string_view tName) override;
+    void commitReadTransaction(std::string_view tName) override;
+
+protected:
+    /// \brief the thread of an open transaction has to see its own changes, other threads read committed data
+    bool useReadConnection() const override { return !inTransaction || !ownsTransaction(); }
+
+private:
+    /// \brief true if the calling thread runs the open transaction
+    bool ownsTransaction() const { return transactionOwner == std::this_thread::get_id(); }
+    std::atomic<std::thread::id> transactionOwner {};
+};
+
+/// \brief Column value of a sqlite3 result row
+struct Sqlite3Value {
+    /// \brief SQLITE_NULL, SQLITE_INTEGER, SQLITE_BLOB or SQLITE_TEXT, floats are kept as text
+    int type { SQLITE_NULL };
+    long long integer {};
+    std::string text;
 };
 
 /// \brief Represents a result of a sqlite3 select
+///
+/// Results of the sqlite3 thread are read completely by the thread, so no statement stays
+/// open on the connection that runs the writes. Results of a read connection are stepped
+/// in batches and hold the connection until the last row is read or the result is dropped.
 class Sqlite3Result : public SQLResult {
 public:
-    Sqlite3Result() = default;
+    Sqlite3Result(Sqlite3Database* sl, sqlite3_stmt* stmt, bool cached, Sqlite3ReadConnection* reader = nullptr);
     ~Sqlite3Result() override;
 
     Sqlite3Result(const Sqlite3Result&) = delete;
     Sqlite3Result& operator=(const Sqlite3Result&) = delete;
 
+    /// \brief read up to maxRows rows from the statement, only to be called by the sqlite3 thread or the owner of the read connection
+    void fetchRows(sqlite3* db, std::size_t maxRows);
+    /// \brief read all rows and release the statement
+    void fetchAll(sqlite3* db) { fetchRows(db, std::numeric_limits<std::size_t>::max()); }
+
 private:
     std::unique_ptr<SQLRow> nextRow() override;
     [[nodiscard]] unsigned long long getNumRows() const override { return nrow; }
 
-    char** table { nullptr };
-    char** row;
-
-    int cur_row;
+    /// \brief reset cached or finalize own statement after last row and return read connection
+    void closeStatement();
 
-    int nrow;
+    Sqlite3Database* sl;
+    /// \brief statement to step, nullptr after the last row was read
+    sqlite3_stmt* stmt;
+    /// \brief statement belongs to statement cache
+    bool cached;
+    /// \brief read connection of the statement, nullptr if statement runs in sqlite3 thread
+    Sqlite3ReadConnection* reader;
     int ncolumn;
 
-    friend class SLSelectTask;
-    friend class Sqlite3Row;
+    /// \brief column values of the current batch
+    std::vector<Sqlite3Value> values;
+    std::size_t cur_row {};
+    std::size_t buf_rows {};
+    unsigned long long nrow {};
 };
 
 /// \brief Represents a row of a result of a sqlite3 select
 class Sqlite3Row : public SQLRow {
 public:
-    explicit Sqlite3Row(char** row);
+    explicit Sqlite3Row(std::vector<Sqlite3Value> row);
+
+    bool isNullOrEmpty(int index) const override;
+    std::string_view col_view(int index) const override;
+    int col_int(int index, int null_value) const override;
+    long long col_long(int index, long long null_value) const override;
 
 private:
     char* col_c_str(int index) const override;
-    char** row;
+    /// \brief text of integer values is created on demand
+    mutable std::vector<Sqlite3Value> row;
 };
 
 #endif // __SQLITE3_STORAGE_H__
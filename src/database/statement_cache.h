@@ -0,0 +1,107 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    statement_cache.h - this file is part of Gerbera.
+
+    Copyright (C) 2025 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file statement_cache.h
+/// \brief Definition of the StatementCache class.
+
+#ifndef __STATEMENT_CACHE_H__
+#define __STATEMENT_CACHE_H__
+
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+/// \brief Bounded LRU cache of prepared statements by query string
+///
+/// The cache is not locked, it belongs to one connection. Statements are released by the
+/// close function passed to the constructor when they are evicted, erased or cleared,
+/// the owner has to clear the cache before the connection is closed.
+template <typename Stmt>
+class StatementCache {
+public:
+    using CloseFunction = void (*)(Stmt);
+
+    StatementCache(std::size_t capacity, CloseFunction closeStmt)
+        : capacity(capacity)
+        , closeStmt(closeStmt)
+    {
+    }
+
+    StatementCache(const StatementCache&) = delete;
+    StatementCache& operator=(const StatementCache&) = delete;
+
+    /// \brief cached statement for query, nullptr if it is not cached
+    Stmt get(const std::string& query)
+    {
+        auto entry = index.find(query);
+        if (entry == index.end())
+            return nullptr;
+        entries.splice(entries.begin(), entries, entry->second);
+        return entry->second->second;
+    }
+
+    /// \brief add stmt for query, the least recently used statement is closed if the cache is full
+    void put(const std::string& query, Stmt stmt)
+    {
+        erase(query);
+        if (capacity > 0 && entries.size() >= capacity) {
+            closeStmt(entries.back().second);
+            index.erase(entries.back().first);
+            entries.pop_back();
+        }
+        entries.emplace_front(query, stmt);
+        index.emplace(query, entries.begin());
+    }
+
+    /// \brief close and remove the statement for query
+    void erase(const std::string& query)
+    {
+        auto entry = index.find(query);
+        if (entry == index.end())
+            return;
+        closeStmt(entry->second->second);
+        entries.erase(entry->second);
+        index.erase(entry);
+    }
+
+    /// \brief close all statements
+    void clear()
+    {
+        for (auto&& [query, stmt] : entries)
+            closeStmt(stmt);
+        entries.clear();
+        index.clear();
+    }
+
+    std::size_t size() const { return entries.size(); }
+
+private:
+    std::size_t capacity;
+    CloseFunction closeStmt;
+    /// \brief most recently used statement first
+    std::list<std::pair<std::string, Stmt>> entries;
+    std::unordered_map<std::string, typename std::list<std::pair<std::string, Stmt>>::iterator> index;
+};
+
+#endif // __STATEMENT_CACHE_H__
@@ -191,7 +191,7 @@ void Server::run()
     }
 
     log_debug("Creating UpnpXMLBuilders");
-    upnpXmlBuilder = std::make_shared<UpnpXMLBuilder>(context, getVirtualUrl());
+    upnpXmlBuilder = std::make_shared<UpnpXMLBuilder>(context, getVirtualUrl(), true);
     webXmlBuilder = std::make_shared<UpnpXMLBuilder>(context, getExternalUrl());
     auto devDescHdl = std::make_shared<DeviceDescriptionHandler>(content, webXmlBuilder, nullptr, ip, port);
 
@@ -586,6 +586,14 @@ void Server::sendSubscriptionUpdate(const std::string& updateString, const std::
     }
 }
 
+void Server::containersChanged(const std::vector<int>& objectIDs) const
+{
+    if (upnpXmlBuilder)
+        upnpXmlBuilder->invalidateObjects(objectIDs);
+    for (auto&& svc : serviceList)
+        svc->containersChanged(objectIDs);
+}
+
 std::unique_ptr<RequestHandler> Server::createRequestHandler(const char* filename, const std::shared_ptr<Quirks>& quirks) const
 {
     std::string link = URLUtils::urlUnescape(filename);
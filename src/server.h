@@ -94,6 +94,8 @@ public:
     bool getShutdownStatus() const;
 
     void sendSubscriptionUpdate(const std::string& updateString, const std::string& serviceId);
+    /// \brief drop cached responses of changed containers before the update is sent
+    void containersChanged(const std::vector<int>& objectIDs) const;
 
     std::shared_ptr<Content> getContent() const { return content; }
     std::vector<std::string> getCorsHosts() const { return corsHosts; }
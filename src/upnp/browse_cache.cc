@@ -0,0 +1,143 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    browse_cache.cc - this file is part of Gerbera.
+
+    Copyright (C) 2025 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file browse_cache.cc
+
+#define GRB_LOG_FAC GrbLogFacility::cds
+#include "browse_cache.h" // API
+
+#include <algorithm>
+#include <iterator>
+#include <unordered_set>
+
+#define BROWSE_CACHE_ENTRY_OVERHEAD 256 // estimated bytes of list, index and response per entry
+#define BROWSE_CACHE_ID_OVERHEAD 48 // estimated bytes of a registration
+
+BrowseCache::BrowseCache(std::size_t capacity)
+    : capacity(capacity)
+{
+}
+
+std::shared_ptr<const BrowseCacheEntry> BrowseCache::get(const std::string& key)
+{
+    std::scoped_lock<std::mutex> lock(mutex);
+    auto entry = index.find(key);
+    if (entry == index.end()) {
+        misses++;
+        return nullptr;
+    }
+    hits++;
+    entries.splice(entries.begin(), entries, entry->second);
+    return entry->second->response;
+}
+
+void BrowseCache::put(const std::string& key, int containerId, std::vector<int> objectIds, std::vector<int> refIds, std::size_t generation, std::shared_ptr<const BrowseCacheEntry> response)
+{
+    auto size = key.size() + response->result.size() + BROWSE_CACHE_ENTRY_OVERHEAD + (objectIds.size() + refIds.size() + 1) * BROWSE_CACHE_ID_OVERHEAD;
+    if (size > capacity)
+        return;
+
+    std::scoped_lock<std::mutex> lock(mutex);
+    // response may have been rendered before a change was notified
+    if (generation != this->generation)
+        return;
+
+    auto entry = index.find(key);
+    if (entry != index.end())
+        eraseEntry(entry->second);
+
+    entries.push_front(Entry { key, containerId, std::move(objectIds), std::move(refIds), std::move(response), size });
+    index[key] = entries.begin();
+    auto&& added = entries.front();
+    related.emplace(containerId, key);
+    for (auto id : added.objectIds)
+        related.emplace(id, key);
+    for (auto id : added.refIds)
+        referring.emplace(id, key);
+    bytes += size;
+
+    while (bytes > capacity)
+        eraseEntry(std::prev(entries.end()));
+}
+
+void BrowseCache::invalidate(const std::vector<int>& containerIds)
+{
+    generation++;
+    std::scoped_lock<std::mutex> lock(mutex);
+    // erase all responses registered with id in registry
+    auto eraseKeys = [this](std::unordered_multimap<int, std::string>& registry, int id, std::unordered_set<int>* children) {
+        std::vector<std::string> keys;
+        auto [first, last] = registry.equal_range(id);
+        std::transform(first, last, std::back_inserter(keys), [](auto&& rel) { return rel.second; });
+        for (auto&& key : keys) {
+            auto entry = index.find(key);
+            if (entry == index.end())
+                continue;
+            if (children && entry->second->containerId == id)
+                children->insert(entry->second->objectIds.begin(), entry->second->objectIds.end());
+            eraseEntry(entry->second);
+        }
+    };
+    for (auto containerId : containerIds) {
+        // the pages of the container, pages listing it and pages referring to its children
+        std::unordered_set<int> children;
+        eraseKeys(related, containerId, &children);
+        for (auto childId : children)
+            eraseKeys(referring, childId, nullptr);
+    }
+}
+
+void BrowseCache::clear()
+{
+    generation++;
+    std::scoped_lock<std::mutex> lock(mutex);
+    entries.clear();
+    index.clear();
+    related.clear();
+    referring.clear();
+    bytes = 0;
+}
+
+std::size_t BrowseCache::getBytes() const
+{
+    std::scoped_lock<std::mutex> lock(mutex);
+    return bytes;
+}
+
+void BrowseCache::eraseEntry(std::list<Entry>::iterator entry)
+{
+    auto unregister = [&entry](std::unordered_multimap<int, std::string>& registry, int id) {
+        auto [first, last] = registry.equal_range(id);
+        auto it = std::find_if(first, last, [&entry](auto&& rel) { return rel.second == entry->key; });
+        if (it != last)
+            registry.erase(it);
+    };
+    unregister(related, entry->containerId);
+    for (auto id : entry->objectIds)
+        unregister(related, id);
+    for (auto id : entry->refIds)
+        unregister(referring, id);
+    bytes -= entry->bytes;
+    index.erase(entry->key);
+    entries.erase(entry);
+}
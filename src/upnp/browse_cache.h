@@ -0,0 +1,103 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    browse_cache.h - this file is part of Gerbera.
+
+    Copyright (C) 2025 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file browse_cache.h
+/// \brief Definition of the BrowseCache class.
+
+#ifndef __BROWSE_CACHE_H__
+#define __BROWSE_CACHE_H__
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/// \brief Rendered response of a BrowseDirectChildren request
+struct BrowseCacheEntry {
+    std::string result;
+    std::size_t numberReturned {};
+    int totalMatches {};
+};
+
+/// \brief Memory bounded LRU cache of browse responses
+///
+/// A response is registered with its container and all objects on the page, so it is dropped
+/// when the container or one of the listed objects changes. Objects on the page referring to
+/// children of a changed container drop the response as well.
+class BrowseCache {
+public:
+    /// \param capacity maximum number of bytes of all cached responses
+    explicit BrowseCache(std::size_t capacity);
+
+    /// \brief cached response of key, nullptr if it is not cached
+    std::shared_ptr<const BrowseCacheEntry> get(const std::string& key);
+    /// \brief store response for page of container, skipped if the cache was changed since generation was read
+    /// \param objectIds ids of the objects on the page
+    /// \param refIds ids of the objects referred to by objects on the page
+    void put(const std::string& key, int containerId, std::vector<int> objectIds, std::vector<int> refIds, std::size_t generation, std::shared_ptr<const BrowseCacheEntry> response);
+    /// \brief drop responses of the changed containers and responses listing them
+    void invalidate(const std::vector<int>& containerIds);
+    void clear();
+
+    /// \brief read before browsing the database to detect invalidation while rendering
+    std::size_t getGeneration() const { return generation; }
+
+    std::size_t getHits() const { return hits; }
+    std::size_t getMisses() const { return misses; }
+    /// \brief number of bytes of all cached responses
+    std::size_t getBytes() const;
+
+private:
+    struct Entry {
+        std::string key;
+        int containerId;
+        std::vector<int> objectIds;
+        std::vector<int> refIds;
+        std::shared_ptr<const BrowseCacheEntry> response;
+        std::size_t bytes;
+    };
+
+    /// \brief remove entry and its registrations, lock must be held
+    void eraseEntry(std::list<Entry>::iterator entry);
+
+    std::size_t capacity;
+    std::size_t bytes {};
+    mutable std::mutex mutex;
+    /// \brief most recently used response first
+    std::list<Entry> entries;
+    std::unordered_map<std::string, std::list<Entry>::iterator> index;
+    /// \brief keys of responses by container id and ids of listed objects
+    std::unordered_multimap<int, std::string> related;
+    /// \brief keys of responses by ids of objects referred to by listed objects
+    std::unordered_multimap<int, std::string> referring;
+
+    /// \brief increased by each invalidation
+    std::atomic<std::size_t> generation {};
+    std::atomic<std::size_t> hits {};
+    std::atomic<std::size_t> misses {};
+};
+
+#endif // __BROWSE_CACHE_H__
@@ -47,10 +47,12 @@
 #include "database/sql_database.h"
 #include "exceptions.h"
 #include "subscription_request.h"
+#include "upnp/browse_cache.h"
 #include "upnp/clients.h"
 #include "upnp/compat.h"
 #include "upnp/quirks.h"
 #include "upnp/xml_builder.h"
+#include "util/grb_net.h"
 #include "util/tools.h"
 
 ContentDirectoryService::ContentDirectoryService(const std::shared_ptr<Context>& context,
@@ -76,6 +78,72 @@ ContentDirectoryService::ContentDirectoryService(const std::shared_ptr<Context>&
     titleSegments = this->config->getArrayOption(ConfigVal::UPNP_SEARCH_ITEM_SEGMENTS);
     resultSeparator = this->config->getOption(ConfigVal::UPNP_SEARCH_SEPARATOR);
     searchableContainers = this->config->getBoolOption(ConfigVal::UPNP_SEARCH_CONTAINER_FLAG);
+
+    auto browseCacheSize = this->config->getIntOption(ConfigVal::UPNP_BROWSE_CACHE_SIZE);
+    if (browseCacheSize > 0)
+        browseCache = std::make_unique<BrowseCache>(static_cast<std::size_t>(browseCacheSize) * 1024);
+}
+
+ContentDirectoryService::~ContentDirectoryService() = default;
+
+/// \brief key of page cursor for client and container
+static std::string pageCursorKey(std::string_view action, const std::shared_ptr<Quirks>& quirks, const std::string& containerId)
+{
+    auto client = quirks ? quirks->getClient() : nullptr;
+    return fmt::format("{} {} {}", action, (client && client->addr) ? client->addr->getNameInfo(false) : "", containerId);
+}
+
+std::shared_ptr<PageCursor> ContentDirectoryService::getPageCursor(const std::string& key)
+{
+    AutoLock lock(cursorMutex);
+    auto it = pageCursorIndex.find(key);
+    if (it == pageCursorIndex.end())
+        return std::make_shared<PageCursor>();
+    // request works on a copy, concurrent requests of the same client must not change it
+    return std::make_shared<PageCursor>(*it->second->second);
+}
+
+void ContentDirectoryService::storePageCursor(const std::string& key, std::shared_ptr<PageCursor> cursor)
+{
+    AutoLock lock(cursorMutex);
+    auto it = pageCursorIndex.find(key);
+    if (it != pageCursorIndex.end()) {
+        it->second->second = std::move(cursor);
+        pageCursors.splice(pageCursors.begin(), pageCursors, it->second);
+        return;
+    }
+    if (pageCursors.size() >= PAGE_CURSOR_MAX_COUNT) {
+        // drop cursor of the client that did not page for the longest time
+        pageCursorIndex.erase(pageCursors.back().first);
+        pageCursors.pop_back();
+    }
+    pageCursors.emplace_front(key, std::move(cursor));
+    pageCursorIndex.emplace(key, pageCursors.begin());
+}
+
+/// \brief everything the browse response of a container depends on
+static std::string browseCacheKey(const std::shared_ptr<Quirks>& quirks, const std::string& objID, const std::string& startingIndex, const std::string& requestedCount, const std::string& sortCriteria, const std::string& filter, int stringLimit)
+{
+    return fmt::format("{}|{}|{}|{}|{}|{}:{}|{}:{}|{}|{}", objID, startingIndex, requestedCount, stringLimit,
+        quirks->getGroup(), sortCriteria.size(), sortCriteria, filter.size(), filter,
+        fmt::ptr(quirks->getProfile()), quirks->checkFlags(~QuirkFlags(QUIRK_FLAG_NONE)));
+}
+
+void ContentDirectoryService::containersChanged(const std::vector<int>& objectIDs)
+{
+    if (browseCache)
+        browseCache->invalidate(objectIDs);
+}
+
+void ContentDirectoryService::setResponse(ActionRequest& request, const std::string& didlLiteXml, std::size_t numberReturned, int totalMatches) const
+{
+    auto response = xmlBuilder->createResponse(request.getActionName(), UPNP_DESC_CDS_SERVICE_TYPE);
+    auto respRoot = response->document_element();
+    respRoot.append_child("Result").append_child(pugi::node_pcdata).set_value(didlLiteXml.c_str());
+    respRoot.append_child("NumberReturned").append_child(pugi::node_pcdata).set_value(fmt::to_string(numberReturned).c_str());
+    respRoot.append_child("TotalMatches").append_child(pugi::node_pcdata).set_value(fmt::to_string(totalMatches).c_str());
+    respRoot.append_child("UpdateID").append_child(pugi::node_pcdata).set_value(fmt::to_string(systemUpdateID).c_str());
+    request.setResponse(std::move(response));
 }
 
 void ContentDirectoryService::doBrowse(ActionRequest& request)
@@ -118,6 +186,26 @@ void ContentDirectoryService::doBrowse(ActionRequest& request)
         throw UpnpException(UPNP_SOAP_E_INVALID_ARGS,
             "Invalid browse flag: " + browseFlag);
 
+    auto stringLimitClient = stringLimit;
+    if (quirks->getStringLimit() > -1) {
+        stringLimitClient = quirks->getStringLimit();
+    }
+
+    // Samsung feature roots are built for each request
+    std::string cacheKey;
+    std::size_t cacheGeneration {};
+    bool useCache = browseCache && arr.empty() && (flag & BROWSE_DIRECT_CHILDREN);
+    if (useCache) {
+        cacheKey = browseCacheKey(quirks, objID, startingIndex, requestedCount, sortCriteria, filter, stringLimitClient);
+        auto cached = browseCache->get(cacheKey);
+        if (cached) {
+            log_debug("Browse {} served from cache", objID);
+            setResponse(request, cached->result, cached->numberReturned, cached->totalMatches);
+            return;
+        }
+        cacheGeneration = browseCache->getGeneration();
+    }
+
     auto parent = database->loadObject(quirks->getGroup(), objectID);
     auto upnpClass = parent->getClass();
     if (sortCriteria.empty() && (startswith(upnpClass, UPNP_CLASS_MUSIC_ALBUM) || startswith(upnpClass, UPNP_CLASS_PLAYLIST_CONTAINER)))
@@ -136,13 +224,17 @@ void ContentDirectoryService::doBrowse(ActionRequest& request)
     param.setGroup(quirks->getGroup());
     if (quirks)
         param.setForbiddenDirectories(quirks->getForbiddenDirectories());
+    auto cursorKey = pageCursorKey("Browse", quirks, objID);
+    param.setCursor(getPageCursor(cursorKey));
 
     // Execute database browse
     try {
-        if (arr.empty())
+        if (arr.empty()) {
             arr = database->browse(param);
-        else
+            storePageCursor(cursorKey, param.getCursor());
+        } else {
             param.setTotalMatches(arr.size());
+        }
     } catch (const SearchParseException& srcEx) {
         log_warning(srcEx.what());
         throw UpnpException(UPNP_E_INVALID_ARGUMENT, srcEx.getUserMessage());
@@ -155,38 +247,30 @@ void ContentDirectoryService::doBrowse(ActionRequest& request)
     }
 
     // build response
-    pugi::xml_document didlLite;
-    if (!quirks->blockXmlDeclaration()) {
-        auto decl = didlLite.prepend_child(pugi::node_declaration);
-        decl.append_attribute("version") = "1.0";
-        decl.append_attribute("encoding") = "UTF-8";
-    }
-    auto didlLiteRoot = didlLite.append_child("DIDL-Lite");
-    didlLiteRoot.append_attribute(UPNP_XML_DIDL_LITE_NAMESPACE_ATTR) = UPNP_XML_DIDL_LITE_NAMESPACE;
-    didlLiteRoot.append_attribute(UPNP_XML_DC_NAMESPACE_ATTR) = UPNP_XML_DC_NAMESPACE;
-    didlLiteRoot.append_attribute(UPNP_XML_UPNP_NAMESPACE_ATTR) = UPNP_XML_UPNP_NAMESPACE;
-    didlLiteRoot.append_attribute(UPNP_XML_SEC_NAMESPACE_ATTR) = UPNP_XML_SEC_NAMESPACE;
-
-    auto stringLimitClient = stringLimit;
-    if (quirks->getStringLimit() > -1) {
-        stringLimitClient = quirks->getStringLimit();
-    }
+    auto didlLite = DidlLiteWriter(!quirks->blockXmlDeclaration(), quirks && quirks->needsStrictXml() ? pugi::format_no_escapes : 0, arr.size());
 
+    auto didlFilter = xmlBuilder->compileFilter(splitString(filter, ','));
     for (auto&& obj : arr) {
         markPlayedItem(obj, obj->getTitle());
-        xmlBuilder->renderObject(obj, splitString(filter, ','), stringLimitClient, didlLiteRoot, quirks);
     }
+    xmlBuilder->renderObjects(arr, didlFilter, stringLimitClient, didlLite, quirks);
 
-    std::string didlLiteXml = UpnpXMLBuilder::printXml(didlLite, "", quirks && quirks->needsStrictXml() ? pugi::format_no_escapes : 0);
+    std::string didlLiteXml = didlLite.finish();
     log_debug("didl {}", didlLiteXml);
 
-    auto response = xmlBuilder->createResponse(request.getActionName(), UPNP_DESC_CDS_SERVICE_TYPE);
-    auto respRoot = response->document_element();
-    respRoot.append_child("Result").append_child(pugi::node_pcdata).set_value(didlLiteXml.c_str());
-    respRoot.append_child("NumberReturned").append_child(pugi::node_pcdata).set_value(fmt::to_string(arr.size()).c_str());
-    respRoot.append_child("TotalMatches").append_child(pugi::node_pcdata).set_value(fmt::to_string(param.getTotalMatches()).c_str());
-    respRoot.append_child("UpdateID").append_child(pugi::node_pcdata).set_value(fmt::to_string(systemUpdateID).c_str());
-    request.setResponse(std::move(response));
+    setResponse(request, didlLiteXml, arr.size(), param.getTotalMatches());
+    if (useCache) {
+        std::vector<int> objectIds;
+        std::vector<int> refIds;
+        objectIds.reserve(arr.size());
+        for (auto&& obj : arr) {
+            objectIds.push_back(obj->getID());
+            if (obj->getRefID() != INVALID_OBJECT_ID)
+                refIds.push_back(obj->getRefID());
+        }
+        browseCache->put(cacheKey, objectID, std::move(objectIds), std::move(refIds), cacheGeneration,
+            std::make_shared<const BrowseCacheEntry>(BrowseCacheEntry { std::move(didlLiteXml), arr.size(), param.getTotalMatches() }));
+    }
 
     log_debug("end");
 }
@@ -217,19 +301,6 @@ void ContentDirectoryService::doSearch(ActionRequest& request)
         containerID, searchCriteria, sortCriteria, startingIndex, filter, requestedCount);
 
     auto&& quirks = request.getQuirks();
-    pugi::xml_document didlLite;
-    if (!quirks || !quirks->blockXmlDeclaration()) {
-        auto decl = didlLite.prepend_child(pugi::node_declaration);
-        decl.append_attribute("version") = "1.0";
-        decl.append_attribute("encoding") = "UTF-8";
-    }
-    auto didlLiteRoot = didlLite.append_child("DIDL-Lite");
-    didlLiteRoot.append_attribute(UPNP_XML_DIDL_LITE_NAMESPACE_ATTR) = UPNP_XML_DIDL_LITE_NAMESPACE;
-    didlLiteRoot.append_attribute(UPNP_XML_DC_NAMESPACE_ATTR) = UPNP_XML_DC_NAMESPACE;
-    didlLiteRoot.append_attribute(UPNP_XML_UPNP_NAMESPACE_ATTR) = UPNP_XML_UPNP_NAMESPACE;
-    didlLiteRoot.append_attribute(UPNP_XML_SEC_NAMESPACE_ATTR) = UPNP_XML_SEC_NAMESPACE;
-    if (quirks->checkFlags(QUIRK_FLAG_PV_SUBTITLES))
-        didlLiteRoot.append_attribute("xmlns:pv") = "http://www.pv.com/pvns/";
     if (sortCriteria.empty()) {
         sortCriteria = fmt::format("+{}", MetaEnumMapper::getMetaFieldName(MetadataFields::M_TITLE));
     }
@@ -239,11 +310,15 @@ void ContentDirectoryService::doSearch(ActionRequest& request)
         stoiString(startingIndex), stoiString(requestedCount), searchableContainers, quirks->getGroup());
     if (quirks)
         searchParam.setForbiddenDirectories(quirks->getForbiddenDirectories());
+    searchParam.setUpdateId(systemUpdateID);
+    auto cursorKey = pageCursorKey("Search", quirks, containerID);
+    searchParam.setCursor(getPageCursor(cursorKey));
 
     // Execute database search
     std::vector<std::shared_ptr<CdsObject>> results;
     try {
         results = database->search(searchParam);
+        storePageCursor(cursorKey, searchParam.getCursor());
         log_debug("Found {}/{} items", results.size(), searchParam.getTotalMatches());
     } catch (const SearchParseException& srcEx) {
         log_warning(srcEx.what());
@@ -257,16 +332,19 @@ void ContentDirectoryService::doSearch(ActionRequest& request)
     }
 
     // build response
+    auto didlLite = DidlLiteWriter(!quirks || !quirks->blockXmlDeclaration(), quirks && quirks->needsStrictXml() ? pugi::format_no_escapes : 0, results.size());
+    if (quirks->checkFlags(QUIRK_FLAG_PV_SUBTITLES))
+        didlLite.addNamespace("xmlns:pv", "http://www.pv.com/pvns/");
+
     auto stringLimitClient = stringLimit;
     if (quirks->getStringLimit() > -1) {
         stringLimitClient = quirks->getStringLimit();
     }
 
+    auto didlFilter = xmlBuilder->compileFilter(splitString(filter, ','));
     for (auto&& cdsObject : results) {
-        if (!cdsObject->isItem()) {
-            xmlBuilder->renderObject(cdsObject, splitString(filter, ','), stringLimitClient, didlLiteRoot);
+        if (!cdsObject->isItem())
             continue;
-        }
 
         std::string title = cdsObject->getTitle();
         if (!titleSegments.empty()) {
@@ -282,19 +360,13 @@ void ContentDirectoryService::doSearch(ActionRequest& request)
         }
 
         markPlayedItem(cdsObject, title);
-        xmlBuilder->renderObject(cdsObject, splitString(filter, ','), stringLimitClient, didlLiteRoot);
     }
+    xmlBuilder->renderObjects(results, didlFilter, stringLimitClient, didlLite);
 
-    std::string didlLiteXml = UpnpXMLBuilder::printXml(didlLite, "", quirks && quirks->needsStrictXml() ? pugi::format_no_escapes : 0);
+    std::string didlLiteXml = didlLite.finish();
     log_debug("didl {}", didlLiteXml);
 
-    auto response = xmlBuilder->createResponse(request.getActionName(), UPNP_DESC_CDS_SERVICE_TYPE);
-    auto respRoot = response->document_element();
-    respRoot.append_child("Result").append_child(pugi::node_pcdata).set_value(didlLiteXml.c_str());
-    respRoot.append_child("NumberReturned").append_child(pugi::node_pcdata).set_value(fmt::to_string(results.size()).c_str());
-    respRoot.append_child("TotalMatches").append_child(pugi::node_pcdata).set_value(fmt::to_string(searchParam.getTotalMatches()).c_str());
-    respRoot.append_child("UpdateID").append_child(pugi::node_pcdata).set_value(fmt::to_string(systemUpdateID).c_str());
-    request.setResponse(std::move(response));
+    setResponse(request, didlLiteXml, results.size(), searchParam.getTotalMatches());
 
     log_debug("end");
 }
@@ -401,6 +473,9 @@ void ContentDirectoryService::doSamsungBookmark(ActionRequest& request) const
     log_debug("start");
 
     request.getQuirks()->saveSamsungBookMarkedPosition(database, request);
+    // bookmarks are part of the rendered items
+    if (browseCache)
+        browseCache->clear();
 
     log_debug("end");
 }
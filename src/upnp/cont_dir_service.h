@@ -36,12 +36,20 @@
 
 #include "upnp_service.h"
 
+#include <list>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
+class BrowseCache;
 class CdsObject;
 class Context;
 class Database;
+class PageCursor;
+
+#define PAGE_CURSOR_MAX_COUNT 200 // number of page cursors kept for clients
 
 /// \brief This class is responsible for the UPnP Content Directory Service operations.
 ///
@@ -123,18 +131,39 @@ private:
     /// \param title current title of the item
     void markPlayedItem(const std::shared_ptr<CdsObject>& cdsObject, std::string title) const;
 
+    /// \brief set Browse or Search response
+    /// \param request request to answer
+    /// \param didlLiteXml rendered DIDL-Lite document
+    /// \param numberReturned number of objects in didlLiteXml
+    /// \param totalMatches number of objects available
+    void setResponse(ActionRequest& request, const std::string& didlLiteXml, std::size_t numberReturned, int totalMatches) const;
+
     std::shared_ptr<Database> database;
 
     std::vector<std::string> titleSegments;
     std::string resultSeparator;
     bool searchableContainers { false };
 
+    /// \brief Position after the last page returned by client and container to continue the next page, most recently used first
+    std::list<std::pair<std::string, std::shared_ptr<PageCursor>>> pageCursors;
+    std::unordered_map<std::string, decltype(pageCursors)::iterator> pageCursorIndex;
+    std::mutex cursorMutex;
+    using AutoLock = std::scoped_lock<std::mutex>;
+
+    /// \brief get copy of the cursor stored for key or an empty cursor
+    std::shared_ptr<PageCursor> getPageCursor(const std::string& key);
+    void storePageCursor(const std::string& key, std::shared_ptr<PageCursor> cursor);
+
+    /// \brief responses of BrowseDirectChildren, nullptr if disabled
+    std::unique_ptr<BrowseCache> browseCache;
+
 public:
     /// \brief Constructor for the CDS, saves the service type and service id
     /// in internal variables.
     explicit ContentDirectoryService(const std::shared_ptr<Context>& context,
         const std::shared_ptr<UpnpXMLBuilder>& xmlBuilder,
         UpnpDevice_Handle deviceHandle, int stringLimit, bool offline);
+    ~ContentDirectoryService() override;
 
     /// \brief Processes an incoming SubscriptionRequest.
     /// \param request SubscriptionRequest to be processed by the function.
@@ -150,6 +179,9 @@ public:
     /// an event to all subscribed devices. Container updates are supported,
     /// and of course the minimum required - systemUpdateID.
     bool sendSubscriptionUpdate(const std::string& containerUpdateIDsCsv) override;
+
+    /// \brief drop cached responses of the changed containers
+    void containersChanged(const std::vector<int>& objectIDs) override;
 };
 
 #endif // __UPNP_CDS_H__
@@ -0,0 +1,140 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    didl_cache.cc - this file is part of Gerbera.
+
+    Copyright (C) 2025 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file didl_cache.cc
+
+#define GRB_LOG_FAC GrbLogFacility::xml
+#include "didl_cache.h" // API
+
+#include "common.h"
+
+#include <algorithm>
+#include <iterator>
+
+#define DIDL_CACHE_ENTRY_OVERHEAD 128 // estimated bytes of list, index and registrations per fragment
+
+DidlCache::DidlCache(std::size_t capacity)
+    : capacity(capacity)
+{
+}
+
+std::shared_ptr<const std::string> DidlCache::get(const std::string& key)
+{
+    std::scoped_lock<std::mutex> lock(mutex);
+    auto entry = index.find(key);
+    if (entry == index.end()) {
+        misses++;
+        return nullptr;
+    }
+    hits++;
+    entries.splice(entries.begin(), entries, entry->second);
+    return entry->second->fragment;
+}
+
+void DidlCache::put(const std::string& key, int objectId, int parentId, int refId, std::size_t generation, std::string fragment)
+{
+    auto size = key.size() + fragment.size() + DIDL_CACHE_ENTRY_OVERHEAD;
+    if (size > capacity)
+        return;
+
+    std::vector<int> objectIds;
+    for (auto id : { objectId, parentId, refId }) {
+        if (id != INVALID_OBJECT_ID && std::find(objectIds.begin(), objectIds.end(), id) == objectIds.end())
+            objectIds.push_back(id);
+    }
+
+    std::scoped_lock<std::mutex> lock(mutex);
+    // object may have been rendered before a change was notified
+    if (generation != this->generation)
+        return;
+
+    auto entry = index.find(key);
+    if (entry != index.end())
+        eraseEntry(entry->second);
+
+    entries.push_front(Entry { key, std::move(objectIds), std::make_shared<const std::string>(std::move(fragment)), size });
+    index[key] = entries.begin();
+    for (auto id : entries.front().objectIds)
+        related.emplace(id, key);
+    bytes += size;
+
+    while (bytes > capacity)
+        eraseEntry(std::prev(entries.end()));
+}
+
+void DidlCache::invalidate(const std::vector<int>& containerIds)
+{
+    generation++;
+    std::scoped_lock<std::mutex> lock(mutex);
+    // erase all fragments registered with id and return their object ids
+    auto eraseRelated = [this](int id) {
+        std::vector<std::string> keys;
+        auto [first, last] = related.equal_range(id);
+        std::transform(first, last, std::back_inserter(keys), [](auto&& rel) { return rel.second; });
+        std::vector<int> objectIds;
+        for (auto&& key : keys) {
+            auto entry = index.find(key);
+            if (entry != index.end()) {
+                objectIds.push_back(entry->second->objectIds.front());
+                eraseEntry(entry->second);
+            }
+        }
+        return objectIds;
+    };
+    for (auto containerId : containerIds) {
+        // the container, its children and the objects related to the children
+        for (auto objectId : eraseRelated(containerId)) {
+            if (objectId != containerId)
+                eraseRelated(objectId);
+        }
+    }
+}
+
+void DidlCache::clear()
+{
+    generation++;
+    std::scoped_lock<std::mutex> lock(mutex);
+    entries.clear();
+    index.clear();
+    related.clear();
+    bytes = 0;
+}
+
+std::size_t DidlCache::getBytes() const
+{
+    std::scoped_lock<std::mutex> lock(mutex);
+    return bytes;
+}
+
+void DidlCache::eraseEntry(std::list<Entry>::iterator entry)
+{
+    for (auto id : entry->objectIds) {
+        auto [first, last] = related.equal_range(id);
+        auto it = std::find_if(first, last, [&entry](auto&& rel) { return rel.second == entry->key; });
+        if (it != last)
+            related.erase(it);
+    }
+    bytes -= entry->bytes;
+    index.erase(entry->key);
+    entries.erase(entry);
+}
@@ -0,0 +1,90 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    didl_cache.h - this file is part of Gerbera.
+
+    Copyright (C) 2025 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file didl_cache.h
+/// \brief Definition of the DidlCache class.
+
+#ifndef __DIDL_CACHE_H__
+#define __DIDL_CACHE_H__
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/// \brief Memory bounded LRU cache of rendered DIDL-Lite objects
+///
+/// The key of a fragment contains everything the rendering depends on. Fragments are also
+/// registered with the id, the parent id and the reference id of their object, so a changed
+/// container drops itself, its children and the objects referring to those children.
+class DidlCache {
+public:
+    /// \param capacity maximum number of bytes of all cached fragments
+    explicit DidlCache(std::size_t capacity);
+
+    /// \brief cached fragment of key, nullptr if it is not cached
+    std::shared_ptr<const std::string> get(const std::string& key);
+    /// \brief store fragment of an object, skipped if the cache was changed since generation was read
+    void put(const std::string& key, int objectId, int parentId, int refId, std::size_t generation, std::string fragment);
+    /// \brief drop fragments of the changed containers and their children
+    void invalidate(const std::vector<int>& containerIds);
+    void clear();
+
+    /// \brief read before rendering an object to detect invalidation while rendering
+    std::size_t getGeneration() const { return generation; }
+
+    std::size_t getHits() const { return hits; }
+    std::size_t getMisses() const { return misses; }
+    /// \brief number of bytes of all cached fragments
+    std::size_t getBytes() const;
+
+private:
+    struct Entry {
+        std::string key;
+        std::vector<int> objectIds;
+        std::shared_ptr<const std::string> fragment;
+        std::size_t bytes;
+    };
+
+    /// \brief remove entry and its registrations, lock must be held
+    void eraseEntry(std::list<Entry>::iterator entry);
+
+    std::size_t capacity;
+    std::size_t bytes {};
+    mutable std::mutex mutex;
+    /// \brief most recently used fragment first
+    std::list<Entry> entries;
+    std::unordered_map<std::string, std::list<Entry>::iterator> index;
+    /// \brief keys of fragments by id, parent id and reference id of their object
+    std::unordered_multimap<int, std::string> related;
+
+    /// \brief increased by each invalidation
+    std::atomic<std::size_t> generation {};
+    std::atomic<std::size_t> hits {};
+    std::atomic<std::size_t> misses {};
+};
+
+#endif // __DIDL_CACHE_H__
@@ -32,6 +32,7 @@
 #include <memory>
 #include <string>
 #include <upnp.h>
+#include <vector>
 
 class ActionRequest;
 class Config;
@@ -91,6 +92,10 @@ public:
     {
         return false;
     }
+
+    /// \brief Notification about changed containers before the update is sent
+    /// \param objectIDs ids of the changed containers
+    virtual void containersChanged(const std::vector<int>& objectIDs) { }
 };
 
 #endif // __UPNP_SERVICE_H__
@@ -42,15 +42,21 @@
 #include "config/result/transcoding.h"
 #include "context.h"
 #include "database/database.h"
+#include "exceptions.h"
 #include "request_handler/device_description_handler.h"
 #include "request_handler/request_handler.h"
 #include "upnp/clients.h"
+#include "upnp/didl_cache.h"
+#include "upnp/quirks.h"
+#include "upnp/upnp_common.h"
+#include "util/task_pool.h"
 #include "util/url_utils.h"
 
 #include <algorithm>
 #include <array>
 #include <fmt/chrono.h>
 #include <sstream>
+#include <thread>
 
 #define URL_FILE_EXTENSION "ext"
 
@@ -108,9 +114,94 @@
 #define UPNP_DLNA_PROFILE_PNG_SM_ICO "PNG_TN" // "PNG_SM_ICO"
 #define UPNP_DLNA_PROFILE_PNG_LRG_ICO "JPEG_TN" // "PNG_LRG_ICO"
 
+#define DIDL_OBJECT_SIZE_HINT 1024 // bytes reserved per object in DIDL-Lite buffer
+#define DIDL_PARALLEL_MIN_OBJECTS 32 // smallest part of a page rendered by another thread
+
+DidlLiteWriter::DidlLiteWriter(bool declaration, unsigned int flags, std::size_t objectCount)
+    : flags(flags)
+{
+    buffer.reserve((objectCount + 1) * DIDL_OBJECT_SIZE_HINT);
+    // same text as printing declaration and root nodes of a document
+    if (declaration)
+        buffer.append("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+    buffer.append("<DIDL-Lite");
+    addNamespace(UPNP_XML_DIDL_LITE_NAMESPACE_ATTR, UPNP_XML_DIDL_LITE_NAMESPACE);
+    addNamespace(UPNP_XML_DC_NAMESPACE_ATTR, UPNP_XML_DC_NAMESPACE);
+    addNamespace(UPNP_XML_UPNP_NAMESPACE_ATTR, UPNP_XML_UPNP_NAMESPACE);
+    addNamespace(UPNP_XML_SEC_NAMESPACE_ATTR, UPNP_XML_SEC_NAMESPACE);
+    scratchRoot = scratch.append_child("DIDL-Lite");
+}
+
+void DidlLiteWriter::addNamespace(const std::string& attribute, const std::string& uri)
+{
+    if (hasObjects)
+        throw_std_runtime_error("Namespace {} added after first object", attribute);
+    buffer.append(fmt::format(" {}=\"{}\"", attribute, uri));
+}
+
+pugi::xml_node& DidlLiteWriter::startObject()
+{
+    scratchRoot.remove_children();
+    return scratchRoot;
+}
+
+void DidlLiteWriter::endObject()
+{
+    auto object = scratchRoot.first_child();
+    if (!object) {
+        lastObjectStart = buffer.size();
+        return;
+    }
+    if (!hasObjects) {
+        buffer.append(">\n");
+        hasObjects = true;
+        objectsStart = buffer.size();
+    }
+    // each printed node is terminated by a newline, just like inside the root element
+    lastObjectStart = buffer.size();
+    object.print(*this, "", flags);
+    scratchRoot.remove_children();
+}
+
+void DidlLiteWriter::appendObject(const std::string& fragment)
+{
+    if (!hasObjects) {
+        buffer.append(">\n");
+        hasObjects = true;
+        objectsStart = buffer.size();
+    }
+    lastObjectStart = buffer.size();
+    buffer.append(fragment);
+}
+
+void DidlLiteWriter::appendObjects(const DidlLiteWriter& part)
+{
+    if (!part.hasObjects)
+        return;
+    if (!hasObjects) {
+        buffer.append(">\n");
+        hasObjects = true;
+        objectsStart = buffer.size();
+    }
+    lastObjectStart = buffer.size() + part.lastObjectStart - part.objectsStart;
+    buffer.append(part.buffer, part.objectsStart);
+}
+
+std::string DidlLiteWriter::finish()
+{
+    buffer.append(hasObjects ? "</DIDL-Lite>\n" : " />\n");
+    return std::move(buffer);
+}
+
+void DidlLiteWriter::write(const void* data, std::size_t size)
+{
+    buffer.append(static_cast<const char*>(data), size);
+}
+
 UpnpXMLBuilder::UpnpXMLBuilder(
     const std::shared_ptr<Context>& context,
-    std::string virtualUrl)
+    std::string virtualUrl,
+    bool renderDidl)
     : config(context->getConfig())
     , database(context->getDatabase())
     , definition(context->getDefinition())
@@ -135,8 +226,23 @@ UpnpXMLBuilder::UpnpXMLBuilder(
     resourcePropertyDefaults = config->getDictionaryOption(ConfigVal::UPNP_RESOURCE_PROPERTY_DEFAULTS);
     objectPropertyDefaults = config->getDictionaryOption(ConfigVal::UPNP_OBJECT_PROPERTY_DEFAULTS);
     containerPropertyDefaults = config->getDictionaryOption(ConfigVal::UPNP_CONTAINER_PROPERTY_DEFAULTS);
+
+    if (!renderDidl)
+        return;
+
+    auto didlCacheSize = config->getIntOption(ConfigVal::UPNP_DIDL_CACHE_SIZE);
+    if (didlCacheSize > 0)
+        didlCache = std::make_shared<DidlCache>(static_cast<std::size_t>(didlCacheSize) * 1024);
+
+    std::size_t threadCount = config->getIntOption(ConfigVal::UPNP_RENDER_THREADS);
+    if (threadCount == 0)
+        threadCount = std::thread::hardware_concurrency();
+    if (threadCount > 1)
+        renderPool = std::make_unique<TaskPool>("RenderThread", threadCount - 1);
 }
 
+UpnpXMLBuilder::~UpnpXMLBuilder() = default;
+
 std::unique_ptr<pugi::xml_document> UpnpXMLBuilder::createResponse(const std::string& actionName, const std::string& serviceType) const
 {
     auto response = std::make_unique<pugi::xml_document>();
@@ -184,19 +290,21 @@ std::vector<std::string> UpnpXMLBuilder::addPropertyList(
     bool strictXml,
     std::size_t stringLimit,
     pugi::xml_node& result,
-    const std::vector<std::string>& filter,
+    const PropertyFilter& filter,
     const std::vector<std::pair<std::string, std::string>>& meta,
     const std::map<std::string, std::string>& auxData,
     ConfigVal itemProps,
     ConfigVal nsProp) const
 {
-    auto namespaceMap = objectNamespaces.at(nsProp);
+    auto&& namespaceMap = objectNamespaces.at(nsProp);
     for (auto&& [xmlns, uri] : namespaceMap) {
         result.append_attribute(fmt::format("xmlns:{}", xmlns).c_str()) = uri.c_str();
     }
     auto propertyMap = config->getDictionaryOption(itemProps);
     std::vector<std::string> propNames;
     for (auto&& [tag, field] : propertyMap) {
+        if (!filter.containsField(tag))
+            continue;
         auto metaField = MetaEnumMapper::remapMetaDataField(field);
         bool wasMeta = false;
         for (auto&& [mkey, mvalue] : meta) {
@@ -222,15 +330,38 @@ std::string UpnpXMLBuilder::printXml(const pugi::xml_node& entry, const char* in
     return buf.str();
 }
 
+/// \brief name of the element created by addField for key as used in filters
+static std::string fieldFilterName(const std::string& key)
+{
+    auto i = key.find('@');
+    if (i == std::string::npos)
+        return key;
+    auto j = key.find('[', i + 1);
+    if (j != std::string::npos && key[key.length() - 1] == ']')
+        return key.substr(0, j);
+    return key;
+}
+
+PropertyFilter::PropertyFilter(std::vector<std::string> tags)
+    : all(false)
+    , tags(std::move(tags))
+    , tagSet(this->tags.begin(), this->tags.end())
+{
+}
+
+bool PropertyFilter::containsField(const std::string& key) const
+{
+    return all || contains(fieldFilterName(key));
+}
+
 std::string UpnpXMLBuilder::addField(
     pugi::xml_node& entry,
-    const std::vector<std::string>& filter,
+    const PropertyFilter& filter,
     const std::string& key,
     const std::string& val) const
 {
     auto i = key.find('@');
     auto j = key.find('[', i + 1);
-    auto filterActive = !(filter.size() == 1 && filter[0] == "*");
     if (i != std::string::npos && j != std::string::npos && key[key.length() - 1] == ']') {
         // e.g. used for MetadataFields::M_ALBUMARTIST
         // name@attr[val] => <name attr="val">
@@ -238,7 +369,7 @@ std::string UpnpXMLBuilder::addField(
         std::string attrValue = key.substr(j + 1, key.length() - j - 2);
         std::string name = key.substr(0, i);
         auto upnpElement = fmt::format("{}@{}", name, attrName);
-        if (filterActive && std::find(filter.begin(), filter.end(), upnpElement) == filter.end())
+        if (!filter.contains(upnpElement))
             return "";
         auto node = entry.append_child(name.c_str());
         node.append_attribute(attrName.c_str()) = attrValue.c_str();
@@ -249,7 +380,7 @@ std::string UpnpXMLBuilder::addField(
         std::string name = key.substr(0, i);
         std::string attrName = key.substr(i + 1);
         auto upnpElement = fmt::format("{}@{}", name, attrName);
-        if (filterActive && std::find(filter.begin(), filter.end(), upnpElement) == filter.end())
+        if (!filter.contains(upnpElement))
             return "";
         auto child = entry.child(name.c_str());
         if (child) {
@@ -259,7 +390,7 @@ std::string UpnpXMLBuilder::addField(
         }
         return upnpElement;
     } else {
-        if (filterActive && std::find(filter.begin(), filter.end(), key) == filter.end())
+        if (!filter.contains(key))
             return "";
         entry.append_child(key.c_str()).append_child(pugi::node_pcdata).set_value(val.c_str());
         return key;
@@ -277,7 +408,7 @@ bool UpnpXMLBuilder::checkFilterNamespace(const std::string& f, ConfigVal nsProp
      *    dc:date,dc:description,upnp:longDescription,upnp:genre,res,res@duration,res@size,upnp:albumArtURI,upnp:rating,upnp:lastPlaybackPosition,upnp:lastPlaybackTime,upnp:playbackCount,upnp:originalTrackNumber,upnp:episodeNumber,upnp:programTitle,upnp:seriesTitle,upnp:album,upnp:artist,upnp:author,upnp:director,dc:publisher,searchable,childCount,dc:title,dc:creator,upnp:actor,res@resolution,upnp:episodeCount,upnp:episodeSeason,xbmc:lastPlayerState,xbmc:dateadded,xbmc:rating,xbmc:votes,xbmc:artwork,xbmc:uniqueidentifier,xbmc:country,xbmc:userrating
      */
     auto parts = splitString(f, ':');
-    auto namespaceMap = objectNamespaces.at(nsProp);
+    auto&& namespaceMap = objectNamespaces.at(nsProp);
     if (parts.size() > 1) {
         auto nsp = parts.at(0);
         if (nsp != "dc" && nsp != "upnp" && namespaceMap.find(nsp) == namespaceMap.end())
@@ -289,10 +420,10 @@ bool UpnpXMLBuilder::checkFilterNamespace(const std::string& f, ConfigVal nsProp
 void UpnpXMLBuilder::addDefaultProperty(
     pugi::xml_node& result,
     const std::vector<std::string>& propNames,
-    const std::vector<std::string>& filter,
+    const PropertyFilter& filter,
     const std::map<std::string, std::string>& defaults)
 {
-    for (auto&& tag : filter) {
+    for (auto&& tag : filter.getTags()) {
         if (std::find(propNames.begin(), propNames.end(), tag) == propNames.end()) {
             std::string attributeTag = fmt::format("@{}", tag);
             if (defaults.find(tag) != defaults.end()) {
@@ -304,12 +435,81 @@ void UpnpXMLBuilder::addDefaultProperty(
     }
 }
 
+DidlFilter UpnpXMLBuilder::compileFilter(const std::vector<std::string>& filter) const
+{
+    std::map<ConfigVal, DidlFilter::Filters> filters;
+    for (auto nsProp : { ConfigVal::UPNP_TITLE_NAMESPACES, ConfigVal::UPNP_ALBUM_NAMESPACES, ConfigVal::UPNP_ARTIST_NAMESPACES, ConfigVal::UPNP_GENRE_NAMESPACES, ConfigVal::UPNP_PLAYLIST_NAMESPACES }) {
+        std::vector<std::string> cntFilter;
+        std::vector<std::string> objFilter;
+        std::vector<std::string> resFilter;
+        bool allObjProps = false;
+        bool allCntProps = false;
+        bool allResProps = false;
+        for (auto&& f : filter) {
+            if (f == "*") {
+                allObjProps = true;
+                allResProps = true;
+                allCntProps = true;
+            } else if (f == "res") {
+                // we always send resources
+            } else if (f == "res#") {
+                allResProps = true;
+            } else if (f == "container#") {
+                allCntProps = true;
+            } else if (startswith(f, "res@")) {
+                std::string resFlt = f.substr(4); // 4 == sizeof(res@)
+                if (checkFilterNamespace(resFlt, nsProp))
+                    resFilter.push_back(resFlt);
+            } else if (startswith(f, "container@")) {
+                std::string contFlt = f.substr(10); // 10 == sizeof(container@)
+                if (checkFilterNamespace(contFlt, nsProp))
+                    cntFilter.push_back(contFlt);
+            } else if (startswith(f, "@")) {
+                std::string objFlt = f.substr(1);
+                if (checkFilterNamespace(objFlt, nsProp))
+                    cntFilter.push_back(objFlt);
+            } else {
+                if (checkFilterNamespace(f, nsProp))
+                    objFilter.push_back(f);
+            }
+        }
+        auto&& compiled = filters[nsProp];
+        if (!allObjProps && !objFilter.empty()) {
+            if (std::find(objFilter.begin(), objFilter.end(), MetaEnumMapper::getMetaFieldName(MetadataFields::M_DATE)) == objFilter.end()) {
+                // date is required
+                objFilter.push_back(MetaEnumMapper::getMetaFieldName(MetadataFields::M_DATE));
+            }
+            compiled.objFilter = PropertyFilter(std::move(objFilter));
+        }
+        if (!allCntProps && !cntFilter.empty()) {
+            compiled.cntFilter = PropertyFilter(std::move(cntFilter));
+        }
+        if (!allResProps && !resFilter.empty()) {
+            resFilter.push_back("protocolInfo");
+            compiled.resFilter = PropertyFilter(std::move(resFilter));
+        }
+    }
+    auto signature = fmt::format("{}", fmt::join(filter, ","));
+    log_debug("Compiled filter {}", signature);
+    return { std::move(signature), std::move(filters) };
+}
+
 void UpnpXMLBuilder::renderObject(
     const std::shared_ptr<CdsObject>& obj,
     const std::vector<std::string>& filter,
     std::size_t stringLimit,
     pugi::xml_node& parent,
     const std::shared_ptr<Quirks>& quirks) const
+{
+    renderObject(obj, compileFilter(filter), stringLimit, parent, quirks);
+}
+
+void UpnpXMLBuilder::renderObject(
+    const std::shared_ptr<CdsObject>& obj,
+    const DidlFilter& filter,
+    std::size_t stringLimit,
+    pugi::xml_node& parent,
+    const std::shared_ptr<Quirks>& quirks) const
 {
     ConfigVal itemProps = ConfigVal::UPNP_TITLE_PROPERTIES;
     ConfigVal nsProp = ConfigVal::UPNP_TITLE_NAMESPACES;
@@ -328,57 +528,7 @@ void UpnpXMLBuilder::renderObject(
         nsProp = ConfigVal::UPNP_PLAYLIST_NAMESPACES;
     }
 
-    std::vector<std::string> cntFilter;
-    std::vector<std::string> objFilter;
-    std::vector<std::string> resFilter;
-    bool allObjProps = false;
-    bool allCntProps = false;
-    bool allResProps = false;
-    for (auto&& f : filter) {
-        if (f == "*") {
-            allObjProps = true;
-            allResProps = true;
-            allCntProps = true;
-        } else if (f == "res") {
-            // we always send resources
-        } else if (f == "res#") {
-            allResProps = true;
-        } else if (f == "container#") {
-            allCntProps = true;
-        } else if (startswith(f, "res@")) {
-            std::string resFlt = f.substr(4); // 4 == sizeof(res@)
-            if (checkFilterNamespace(resFlt, nsProp))
-                resFilter.push_back(resFlt);
-        } else if (startswith(f, "container@")) {
-            std::string contFlt = f.substr(10); // 10 == sizeof(container@)
-            if (checkFilterNamespace(contFlt, nsProp))
-                cntFilter.push_back(contFlt);
-        } else if (startswith(f, "@")) {
-            std::string objFlt = f.substr(1);
-            if (checkFilterNamespace(objFlt, nsProp))
-                cntFilter.push_back(objFlt);
-        } else {
-            if (checkFilterNamespace(f, nsProp))
-                objFilter.push_back(f);
-        }
-    }
-    if (allObjProps || objFilter.empty()) {
-        objFilter = { "*" };
-    } else if (std::find(objFilter.begin(), objFilter.end(), MetaEnumMapper::getMetaFieldName(MetadataFields::M_DATE)) == objFilter.end()) {
-        // date is required
-        objFilter.push_back(MetaEnumMapper::getMetaFieldName(MetadataFields::M_DATE));
-    }
-    if (allCntProps || cntFilter.empty()) {
-        cntFilter = { "*" };
-    }
-    if (allResProps || resFilter.empty()) {
-        resFilter = { "*" };
-    } else {
-        resFilter.push_back("protocolInfo");
-    }
-    log_debug("Object Filters {}", fmt::join(objFilter, ", "));
-    log_debug("Container Filters {}", fmt::join(cntFilter, ", "));
-    log_debug("Resource Filters {}", fmt::join(resFilter, ", "));
+    auto&& [objFilter, cntFilter, resFilter] = filter.getFilters(nsProp);
     auto result = parent.append_child("");
 
     result.append_attribute("id") = obj->getID();
@@ -410,6 +560,9 @@ void UpnpXMLBuilder::renderObject(
 
         // add metadata
         for (auto&& [key, group] : metaGroups) {
+            // description and track number are always sent
+            if (!objFilter.containsField(key) && key != MetaEnumMapper::getMetaFieldName(MetadataFields::M_DESCRIPTION) && key != MetaEnumMapper::getMetaFieldName(MetadataFields::M_TRACKNUMBER))
+                continue;
             if (mvMeta) {
                 for (auto&& val : group) {
                     // Trim metadata value as needed
@@ -500,15 +653,116 @@ void UpnpXMLBuilder::renderObject(
         propNames.emplace_back(fixTag);
 
     if (quirks && quirks->getFullFilter()) {
-        if (obj->isItem() && !(objFilter.size() == 1 && objFilter[0] == "*")) {
+        if (obj->isItem() && !objFilter.isAll()) {
             addDefaultProperty(result, propNames, objFilter, objectPropertyDefaults);
-        } else if (obj->isContainer() && !(cntFilter.size() == 1 && cntFilter[0] == "*")) {
+        } else if (obj->isContainer() && !cntFilter.isAll()) {
             addDefaultProperty(result, propNames, cntFilter, containerPropertyDefaults);
         }
     }
     log_debug("Rendered DIDL: {}", printXml(result, "  "));
 }
 
+/// \brief everything the rendered text of obj depends on
+static std::string didlCacheKey(
+    const std::shared_ptr<CdsObject>& obj,
+    const DidlFilter& filter,
+    std::size_t stringLimit,
+    unsigned int flags,
+    const std::shared_ptr<Quirks>& quirks)
+{
+    auto&& filterString = filter.getSignature();
+    auto title = obj->getTitle();
+    auto key = fmt::format("{}|{}|{}|{}|{}|{}|{}|{}:{}|{}:{}", obj->getID(), obj->getParentID(), obj->getRefID(), obj->getMTime().count(), obj->getUTime().count(), stringLimit, flags, filterString.size(), filterString, title.size(), title);
+    if (obj->isContainer()) {
+        auto cont = std::static_pointer_cast<CdsContainer>(obj);
+        key.append(fmt::format("|{}|{}", cont->getUpdateID(), cont->getChildCount()));
+    } else if (obj->isItem()) {
+        auto playStatus = std::static_pointer_cast<CdsItem>(obj)->getPlayStatus();
+        if (playStatus)
+            key.append(fmt::format("|{}|{}|{}|{}", playStatus->getPlayCount(), playStatus->getLastPlayed().count(), playStatus->getLastPlayedPosition().count(), playStatus->getBookMarkPosition().count()));
+    }
+    if (quirks)
+        key.append(fmt::format("|{}|{}|{}", quirks->getGroup(), fmt::ptr(quirks->getProfile()), quirks->checkFlags(~QuirkFlags(QUIRK_FLAG_NONE))));
+    else
+        key.append("|-");
+    return key;
+}
+
+void UpnpXMLBuilder::renderObject(
+    const std::shared_ptr<CdsObject>& obj,
+    const std::vector<std::string>& filter,
+    std::size_t stringLimit,
+    DidlLiteWriter& writer,
+    const std::shared_ptr<Quirks>& quirks) const
+{
+    renderObject(obj, compileFilter(filter), stringLimit, writer, quirks);
+}
+
+void UpnpXMLBuilder::renderObject(
+    const std::shared_ptr<CdsObject>& obj,
+    const DidlFilter& filter,
+    std::size_t stringLimit,
+    DidlLiteWriter& writer,
+    const std::shared_ptr<Quirks>& quirks) const
+{
+    if (!didlCache) {
+        renderObject(obj, filter, stringLimit, writer.startObject(), quirks);
+        writer.endObject();
+        return;
+    }
+
+    auto key = didlCacheKey(obj, filter, stringLimit, writer.getFlags(), quirks);
+    auto fragment = didlCache->get(key);
+    if (fragment) {
+        writer.appendObject(*fragment);
+        return;
+    }
+    auto generation = didlCache->getGeneration();
+    renderObject(obj, filter, stringLimit, writer.startObject(), quirks);
+    writer.endObject();
+    auto rendered = writer.lastObject();
+    if (!rendered.empty())
+        didlCache->put(key, obj->getID(), obj->getParentID(), obj->getRefID(), generation, std::move(rendered));
+}
+
+void UpnpXMLBuilder::renderObjects(
+    const std::vector<std::shared_ptr<CdsObject>>& objects,
+    const DidlFilter& filter,
+    std::size_t stringLimit,
+    DidlLiteWriter& writer,
+    const std::shared_ptr<Quirks>& quirks) const
+{
+    auto partCount = renderPool ? std::min(renderPool->getThreadCount() + 1, objects.size() / DIDL_PARALLEL_MIN_OBJECTS) : 1;
+    if (partCount < 2) {
+        for (auto&& obj : objects)
+            renderObject(obj, filter, stringLimit, writer, quirks);
+        return;
+    }
+
+    // render consecutive parts into own writers and join them in order
+    std::vector<std::unique_ptr<DidlLiteWriter>> parts;
+    std::vector<std::function<void()>> tasks;
+    auto partSize = (objects.size() + partCount - 1) / partCount;
+    for (std::size_t start = 0; start < objects.size(); start += partSize) {
+        auto end = std::min(start + partSize, objects.size());
+        auto part = parts.emplace_back(std::make_unique<DidlLiteWriter>(false, writer.getFlags(), end - start)).get();
+        tasks.emplace_back([this, &objects, &filter, stringLimit, &quirks, start, end, part] {
+            for (auto i = start; i < end; i++)
+                renderObject(objects.at(i), filter, stringLimit, *part, quirks);
+        });
+    }
+    log_debug("Rendering {} objects in {} parts", objects.size(), tasks.size());
+    renderPool->run(std::move(tasks));
+    for (auto&& part : parts)
+        writer.appendObjects(*part);
+}
+
+void UpnpXMLBuilder::invalidateObjects(const std::vector<int>& containerIds) const
+{
+    if (didlCache)
+        didlCache->invalidate(containerIds);
+}
+
 std::unique_ptr<pugi::xml_document> UpnpXMLBuilder::createEventPropertySet() const
 {
     auto doc = std::make_unique<pugi::xml_document>();
@@ -539,7 +793,7 @@ static bool isPrivateAttribute(ResourceAttribute attribute)
 void UpnpXMLBuilder::renderResource(const CdsObject& object,
     const CdsResource& resource,
     pugi::xml_node& parent,
-    const std::vector<std::string>& filter,
+    const PropertyFilter& filter,
     const std::shared_ptr<Quirks>& quirks,
     const std::map<std::string, std::string>& clientSpecificAttrs,
     const std::string& clientGroup,
@@ -553,25 +807,24 @@ void UpnpXMLBuilder::renderResource(const CdsObject& object,
 
     res.append_child(pugi::node_pcdata).set_value(url.c_str());
 
-    auto filterActive = !(filter.size() == 1 && filter[0] == "*");
     std::vector<std::string> propNames = { "id" };
     for (auto&& [attr, val] : resource.getAttributes()) {
         if (isPrivateAttribute(attr)) {
             continue;
         }
-        if (filterActive && std::find(filter.begin(), filter.end(), EnumMapper::getAttributeName(attr)) == filter.end())
+        if (!filter.contains(EnumMapper::getAttributeName(attr)))
             continue;
         res.append_attribute(EnumMapper::getAttributeName(attr).c_str()) = val.c_str();
         propNames.push_back(EnumMapper::getAttributeName(attr));
     }
 
     for (auto&& [k, v] : clientSpecificAttrs) {
-        if (filterActive && std::find(filter.begin(), filter.end(), k) == filter.end())
+        if (!filter.contains(k))
             continue;
         res.append_attribute(k.c_str()) = v.c_str();
         propNames.push_back(k);
     }
-    if (filterActive && quirks && quirks->getFullFilter()) {
+    if (!filter.isAll() && quirks && quirks->getFullFilter()) {
         addDefaultProperty(res, propNames, filter, resourcePropertyDefaults);
     }
 }
@@ -1017,7 +1270,7 @@ std::pair<bool, int> UpnpXMLBuilder::insertTempTranscodingResource(
 void UpnpXMLBuilder::addResources(
     const std::shared_ptr<CdsItem>& item,
     pugi::xml_node& parent,
-    const std::vector<std::string>& filter,
+    const PropertyFilter& filter,
     const std::shared_ptr<Quirks>& quirks) const
 {
     bool isExternalURL = (item->isExternalItem() && !item->getFlag(OBJECT_FLAG_PROXY_URL));
@@ -1109,7 +1362,7 @@ void UpnpXMLBuilder::addResources(
 void UpnpXMLBuilder::addResources(
     const std::shared_ptr<CdsContainer>& cont,
     pugi::xml_node& parent,
-    const std::vector<std::string>& filter,
+    const PropertyFilter& filter,
     const std::shared_ptr<Quirks>& quirks) const
 {
     auto orderedResources = getOrderedResources(*cont);
@@ -40,6 +40,7 @@
 #include <map>
 #include <memory>
 #include <pugixml.hpp>
+#include <unordered_set>
 #include <vector>
 
 #define CONTENT_MEDIA_HANDLER "media"
@@ -54,13 +55,107 @@ class Config;
 class ConfigDefinition;
 class Context;
 class Database;
+class DidlCache;
 enum class ContentHandler;
 enum class ConfigVal;
 class Quirks;
+class TaskPool;
+
+/// \brief Writes a DIDL-Lite document directly into a string buffer
+///
+/// Each object is rendered into a scratch node and printed right away, so the
+/// tree of the whole page is never built and the text is not copied through a stream.
+/// The result is identical to printing the complete tree with UpnpXMLBuilder::printXml
+/// without indent.
+class DidlLiteWriter : public pugi::xml_writer {
+public:
+    /// \param declaration start with xml declaration
+    /// \param flags pugi format flags, e.g. pugi::format_no_escapes for strict xml
+    /// \param objectCount expected number of objects to reserve buffer space
+    DidlLiteWriter(bool declaration, unsigned int flags, std::size_t objectCount = 0);
+
+    /// \brief add namespace attribute to the root element, must be called before the first object
+    void addNamespace(const std::string& attribute, const std::string& uri);
+    /// \brief empty node to render the next object into
+    pugi::xml_node& startObject();
+    /// \brief print object rendered into node from startObject
+    void endObject();
+    /// \brief append object rendered earlier
+    void appendObject(const std::string& fragment);
+    /// \brief append all objects of a writer that rendered a part of the page
+    void appendObjects(const DidlLiteWriter& part);
+    /// \brief text of the object printed by the last endObject
+    std::string lastObject() const { return buffer.substr(lastObjectStart); }
+    unsigned int getFlags() const { return flags; }
+    /// \brief close root element and hand out the document
+    std::string finish();
+
+    void write(const void* data, std::size_t size) override;
+
+private:
+    std::string buffer;
+    unsigned int flags;
+    bool hasObjects {};
+    /// \brief position of the first object
+    std::size_t objectsStart {};
+    std::size_t lastObjectStart {};
+    pugi::xml_document scratch;
+    pugi::xml_node scratchRoot;
+};
+
+/// \brief Set of properties requested for one kind of DIDL-Lite element
+class PropertyFilter {
+public:
+    /// \brief filter accepting all properties
+    PropertyFilter() = default;
+    explicit PropertyFilter(std::vector<std::string> tags);
+
+    bool isAll() const { return all; }
+    bool contains(const std::string& tag) const { return all || tagSet.find(tag) != tagSet.end(); }
+    /// \brief check element name created by UpnpXMLBuilder::addField for key
+    bool containsField(const std::string& key) const;
+    /// \brief requested tags in order of the request
+    const std::vector<std::string>& getTags() const { return tags; }
+
+private:
+    bool all { true };
+    std::vector<std::string> tags;
+    std::unordered_set<std::string> tagSet;
+};
+
+/// \brief Browse or Search filter compiled once per request
+///
+/// Unknown namespaces are dropped depending on the namespaces configured for the kind
+/// of object, so the filters are prepared for each namespace configuration.
+class DidlFilter {
+public:
+    struct Filters {
+        PropertyFilter objFilter;
+        PropertyFilter cntFilter;
+        PropertyFilter resFilter;
+    };
+
+    DidlFilter(std::string signature, std::map<ConfigVal, Filters> filters)
+        : signature(std::move(signature))
+        , filters(std::move(filters))
+    {
+    }
+
+    /// \brief filter string as requested
+    const std::string& getSignature() const { return signature; }
+    const Filters& getFilters(ConfigVal nsProp) const { return filters.at(nsProp); }
+
+private:
+    std::string signature;
+    std::map<ConfigVal, Filters> filters;
+};
 
 class UpnpXMLBuilder {
 public:
-    explicit UpnpXMLBuilder(const std::shared_ptr<Context>& context, std::string virtualUrl);
+    /// \brief create builder for virtualUrl
+    /// \param renderDidl set up DIDL cache and render threads, only needed for the builder answering UPnP browse and search requests
+    UpnpXMLBuilder(const std::shared_ptr<Context>& context, std::string virtualUrl, bool renderDidl = false);
+    ~UpnpXMLBuilder();
 
     /// \brief Renders XML for the action response header.
     /// \param actionName Name of the action.
@@ -73,6 +168,10 @@ public:
     /// whatever can then be adapted to it.
     std::unique_ptr<pugi::xml_document> createResponse(const std::string& actionName, const std::string& serviceType) const;
 
+    /// \brief Parse the upnp attribute filter of a request
+    /// \param filter upnp attribute filter split at ','
+    DidlFilter compileFilter(const std::vector<std::string>& filter) const;
+
     /// \brief Renders the DIDL-Lite representation of an object in the content directory.
     /// \param obj Object to be rendered as XML.
     /// \param filter upnp attribute filter
@@ -88,6 +187,52 @@ public:
         std::size_t stringLimit,
         pugi::xml_node& parent,
         const std::shared_ptr<Quirks>& quirks = nullptr) const;
+    void renderObject(
+        const std::shared_ptr<CdsObject>& obj,
+        const DidlFilter& filter,
+        std::size_t stringLimit,
+        pugi::xml_node& parent,
+        const std::shared_ptr<Quirks>& quirks = nullptr) const;
+
+    /// \brief Renders the DIDL-Lite representation of an object and appends it to the writer.
+    ///
+    /// The rendered text is kept in the DIDL cache and reused until the object changes.
+    /// \param obj Object to be rendered as XML.
+    /// \param filter upnp attribute filter
+    /// \param stringLimit maximum length of string
+    /// \param writer DIDL-Lite document in progress
+    /// \param quirks inject special handling for clients
+    void renderObject(
+        const std::shared_ptr<CdsObject>& obj,
+        const std::vector<std::string>& filter,
+        std::size_t stringLimit,
+        DidlLiteWriter& writer,
+        const std::shared_ptr<Quirks>& quirks = nullptr) const;
+    void renderObject(
+        const std::shared_ptr<CdsObject>& obj,
+        const DidlFilter& filter,
+        std::size_t stringLimit,
+        DidlLiteWriter& writer,
+        const std::shared_ptr<Quirks>& quirks = nullptr) const;
+
+    /// \brief Renders the DIDL-Lite representation of all objects in order and appends them to the writer.
+    ///
+    /// Large pages are split into parts which are rendered in parallel by the render threads.
+    /// \param objects Objects to be rendered as XML.
+    /// \param filter upnp attribute filter
+    /// \param stringLimit maximum length of string
+    /// \param writer DIDL-Lite document in progress
+    /// \param quirks inject special handling for clients
+    void renderObjects(
+        const std::vector<std::shared_ptr<CdsObject>>& objects,
+        const DidlFilter& filter,
+        std::size_t stringLimit,
+        DidlLiteWriter& writer,
+        const std::shared_ptr<Quirks>& quirks = nullptr) const;
+
+    /// \brief drop cached DIDL-Lite of the changed containers and their children
+    void invalidateObjects(const std::vector<int>& containerIds) const;
+    std::shared_ptr<DidlCache> getDidlCache() const { return didlCache; }
 
     /// \brief Renders XML for the event property set.
     /// \return pugi::xml_document representing the newly created XML.
@@ -97,7 +242,7 @@ public:
     /// \param obj Object containing this resource
     /// \param resource The CDSResource itself
     /// \param parent Parent node to render the result into
-    /// \param filter upnp attribute filter
+    /// \param filter requested resource attributes
     /// \param quirks inject special handling for clients
     /// \param clientSpecificAttrs A map containing extra client specific res attributes (like resolution, etc.)
     /// \param clientGroup The clients group for play tracking
@@ -105,7 +250,7 @@ public:
     void renderResource(
         const CdsObject& obj,
         const CdsResource& resource, pugi::xml_node& parent,
-        const std::vector<std::string>& filter,
+        const PropertyFilter& filter,
         const std::shared_ptr<Quirks>& quirks,
         const std::map<std::string, std::string>& clientSpecificAttrs,
         const std::string& clientGroup,
@@ -125,7 +270,7 @@ public:
 
     void addResources(const std::shared_ptr<CdsItem>& item,
         pugi::xml_node& parent,
-        const std::vector<std::string>& filter,
+        const PropertyFilter& filter,
         const std::shared_ptr<Quirks>& quirks) const;
 
     /// \brief build path for first resource from item
@@ -146,6 +291,10 @@ protected:
     std::shared_ptr<Config> config;
     std::shared_ptr<Database> database;
     std::shared_ptr<ConfigDefinition> definition;
+    /// \brief rendered objects, nullptr if disabled
+    std::shared_ptr<DidlCache> didlCache;
+    /// \brief threads rendering parts of large pages besides the request thread, nullptr if rendering is not split
+    std::unique_ptr<TaskPool> renderPool;
 
     std::vector<ContentHandler> orderedHandler;
 
@@ -171,21 +320,21 @@ protected:
     void addResources(
         const std::shared_ptr<CdsContainer>& cont,
         pugi::xml_node& parent,
-        const std::vector<std::string>& filter,
+        const PropertyFilter& filter,
         const std::shared_ptr<Quirks>& quirks) const;
     std::string renderExtension(
         const std::string& contentType,
         const fs::path& location,
         const std::string& language) const;
     std::string addField(pugi::xml_node& entry,
-        const std::vector<std::string>& filter,
+        const PropertyFilter& filter,
         const std::string& key,
         const std::string& val) const;
     std::vector<std::string> addPropertyList(
         bool strictXml,
         std::size_t stringLimit,
         pugi::xml_node& result,
-        const std::vector<std::string>& filter,
+        const PropertyFilter& filter,
         const std::vector<std::pair<std::string, std::string>>& meta,
         const std::map<std::string, std::string>& auxData,
         ConfigVal itemProps,
@@ -210,7 +359,7 @@ protected:
     static void addDefaultProperty(
         pugi::xml_node& result,
         const std::vector<std::string>& propNames,
-        const std::vector<std::string>& filter,
+        const PropertyFilter& filter,
         const std::map<std::string, std::string>& defaults);
 };
 #endif // __UPNP_XML_H__
@@ -0,0 +1,123 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    task_pool.cc - this file is part of Gerbera.
+
+    Copyright (C) 2025 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file task_pool.cc
+
+#define GRB_LOG_FAC GrbLogFacility::thread
+#include "task_pool.h" // API
+
+#include "util/logger.h"
+#include "util/thread_runner.h"
+
+#include <algorithm>
+
+TaskPool::TaskPool(std::string name, std::size_t threadCount)
+    : name(std::move(name))
+{
+    for (std::size_t i = 0; i < threadCount; i++) {
+        auto thread = std::make_unique<StdThreadRunner>(
+            fmt::format("{}{}", this->name, i), [](void* arg) {
+                auto inst = static_cast<TaskPool*>(arg);
+                inst->threadProc();
+            },
+            this);
+        if (thread->isAlive())
+            threads.push_back(std::move(thread));
+    }
+    log_debug("{} started {} threads", this->name, threads.size());
+}
+
+TaskPool::~TaskPool()
+{
+    {
+        std::scoped_lock<std::mutex> lock(mutex);
+        shutdown = true;
+    }
+    taskCond.notify_all();
+    for (auto&& thread : threads)
+        thread->join();
+}
+
+void TaskPool::run(std::vector<std::function<void()>> tasks)
+{
+    auto batch = std::make_shared<Batch>();
+    batch->pending = tasks.size();
+    {
+        std::scoped_lock<std::mutex> lock(mutex);
+        for (auto&& task : tasks)
+            queue.emplace_back(std::move(task), batch);
+    }
+    taskCond.notify_all();
+
+    // help with the own tasks instead of waiting idle
+    std::unique_lock<std::mutex> lock(mutex);
+    while (batch->pending > 0) {
+        auto own = std::find_if(queue.begin(), queue.end(), [&batch](auto&& task) { return task.second == batch; });
+        if (own == queue.end()) {
+            doneCond.wait(lock, [&batch] { return batch->pending == 0; });
+            break;
+        }
+        auto task = std::move(*own);
+        queue.erase(own);
+        lock.unlock();
+        execute(task);
+        lock.lock();
+    }
+    if (batch->error)
+        std::rethrow_exception(batch->error);
+}
+
+void TaskPool::threadProc()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        taskCond.wait(lock, [this] { return shutdown || !queue.empty(); });
+        if (shutdown)
+            break;
+        auto task = std::move(queue.front());
+        queue.pop_front();
+        lock.unlock();
+        execute(task);
+        lock.lock();
+    }
+}
+
+void TaskPool::execute(Task& task)
+{
+    std::exception_ptr error;
+    try {
+        task.first();
+    } catch (...) {
+        error = std::current_exception();
+    }
+    bool done;
+    {
+        std::scoped_lock<std::mutex> lock(mutex);
+        auto&& batch = task.second;
+        if (error && !batch->error)
+            batch->error = error;
+        done = --batch->pending == 0;
+    }
+    if (done)
+        doneCond.notify_all();
+}
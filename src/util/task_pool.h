@@ -0,0 +1,87 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    task_pool.h - this file is part of Gerbera.
+
+    Copyright (C) 2025 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file task_pool.h
+/// \brief Definition of the TaskPool class.
+
+#ifndef __TASK_POOL_H__
+#define __TASK_POOL_H__
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+template <class Condition, class Mutex>
+class ThreadRunner;
+using StdThreadRunner = class ThreadRunner<std::condition_variable, std::mutex>;
+
+/// \brief Fixed number of threads sharing the tasks of concurrent requests
+///
+/// The calling thread works on its own tasks as well, so a request always makes progress
+/// even if all pool threads are busy with tasks of other requests.
+class TaskPool {
+public:
+    /// \param name name of the threads
+    /// \param threadCount number of threads besides the calling threads
+    TaskPool(std::string name, std::size_t threadCount);
+    ~TaskPool();
+
+    TaskPool(const TaskPool&) = delete;
+    TaskPool& operator=(const TaskPool&) = delete;
+
+    /// \brief run all tasks and return when they are done
+    ///
+    /// The first exception thrown by a task is rethrown after all tasks finished.
+    void run(std::vector<std::function<void()>> tasks);
+
+    std::size_t getThreadCount() const { return threads.size(); }
+
+private:
+    /// \brief tasks of one call to run
+    struct Batch {
+        std::size_t pending {};
+        std::exception_ptr error;
+    };
+    using Task = std::pair<std::function<void()>, std::shared_ptr<Batch>>;
+
+    void threadProc();
+    /// \brief run task and mark it done, lock must not be held
+    void execute(Task& task);
+
+    std::string name;
+    std::vector<std::unique_ptr<StdThreadRunner>> threads;
+    std::mutex mutex;
+    /// \brief signals new tasks to pool threads
+    std::condition_variable taskCond;
+    /// \brief signals finished batches to calling threads
+    std::condition_variable doneCond;
+    std::deque<Task> queue;
+    bool shutdown {};
+};
+
+#endif // __TASK_POOL_H__
@@ -38,6 +38,7 @@
 #include "util/logger.h"
 
 #include <algorithm>
+#include <cctype>
 #include <numeric>
 #include <queue>
 #include <sstream>
@@ -369,6 +370,129 @@ unsigned int stringHash(std::string_view str)
     return std::accumulate(str.begin(), str.end(), 5381U, [](auto h, auto ch) { return ((h << 5) + h) ^ ch; });
 }
 
+/// \brief simple case folding of latin, greek and cyrillic letters
+static char32_t foldCase(char32_t ch)
+{
+    if ((ch >= 'A' && ch <= 'Z') || (ch >= 0xC0 && ch <= 0xDE && ch != 0xD7))
+        return ch + 0x20;
+    if (ch == 0x130) // capital I with dot above
+        return 'i';
+    if ((ch >= 0x100 && ch <= 0x137) || (ch >= 0x14A && ch <= 0x177))
+        return ch | 1;
+    if ((ch >= 0x139 && ch <= 0x148) || (ch >= 0x179 && ch <= 0x17E))
+        return (ch & 1) ? ch + 1 : ch;
+    if (ch == 0x178)
+        return 0xFF;
+    if (ch >= 0x391 && ch <= 0x3A9 && ch != 0x3A2)
+        return ch + 0x20;
+    if (ch == 0x3C2)
+        return 0x3C3;
+    if (ch >= 0x410 && ch <= 0x42F)
+        return ch + 0x20;
+    if (ch >= 0x400 && ch <= 0x40F)
+        return ch + 0x50;
+    return ch;
+}
+
+static void appendUtf8(std::string& str, char32_t ch)
+{
+    if (ch < 0x80) {
+        str.push_back(static_cast<char>(ch));
+    } else if (ch < 0x800) {
+        str.push_back(static_cast<char>(0xC0 | (ch >> 6)));
+        str.push_back(static_cast<char>(0x80 | (ch & 0x3F)));
+    } else if (ch < 0x10000) {
+        str.push_back(static_cast<char>(0xE0 | (ch >> 12)));
+        str.push_back(static_cast<char>(0x80 | ((ch >> 6) & 0x3F)));
+        str.push_back(static_cast<char>(0x80 | (ch & 0x3F)));
+    } else {
+        str.push_back(static_cast<char>(0xF0 | (ch >> 18)));
+        str.push_back(static_cast<char>(0x80 | ((ch >> 12) & 0x3F)));
+        str.push_back(static_cast<char>(0x80 | ((ch >> 6) & 0x3F)));
+        str.push_back(static_cast<char>(0x80 | (ch & 0x3F)));
+    }
+}
+
+/// \brief fold case of all letters in valid utf-8 sequences, other bytes are kept
+static std::string foldString(std::string_view str)
+{
+    std::string result;
+    result.reserve(str.size());
+    for (std::size_t i = 0; i < str.size();) {
+        auto c = static_cast<unsigned char>(str[i]);
+        std::size_t len = 0;
+        char32_t ch = 0;
+        if (c < 0x80) {
+            len = 1;
+            ch = c;
+        } else if ((c & 0xE0) == 0xC0) {
+            len = 2;
+            ch = c & 0x1F;
+        } else if ((c & 0xF0) == 0xE0) {
+            len = 3;
+            ch = c & 0x0F;
+        } else if ((c & 0xF8) == 0xF0) {
+            len = 4;
+            ch = c & 0x07;
+        }
+        for (std::size_t j = 1; j < len; j++) {
+            if (i + j >= str.size() || (static_cast<unsigned char>(str[i + j]) & 0xC0) != 0x80) {
+                len = 0;
+                break;
+            }
+            ch = (ch << 6) | (static_cast<unsigned char>(str[i + j]) & 0x3F);
+        }
+        if (len == 0) {
+            result.push_back(str[i++]);
+            continue;
+        }
+        if (ch == 0xDF)
+            result.append("ss");
+        else
+            appendUtf8(result, foldCase(ch));
+        i += len;
+    }
+    return result;
+}
+
+std::string makeSortKey(std::string_view title, const std::vector<std::string>& articles)
+{
+    auto folded = trimString(foldString(title));
+    for (auto&& article : articles) {
+        auto prefix = foldString(article);
+        if (!prefix.empty() && folded.size() > prefix.size() + 1 && startswith(folded, prefix) && folded[prefix.size()] == ' ') {
+            folded = trimString(folded.substr(prefix.size() + 1));
+            break;
+        }
+    }
+
+    std::string key;
+    key.reserve(folded.size() + 8);
+    for (std::size_t i = 0; i < folded.size();) {
+        if (!std::isdigit(static_cast<unsigned char>(folded[i]))) {
+            key.push_back(folded[i++]);
+            continue;
+        }
+        auto end = i;
+        while (end < folded.size() && std::isdigit(static_cast<unsigned char>(folded[end])))
+            end++;
+        while (i + 1 < end && folded[i] == '0')
+            i++;
+        // shorter numbers are smaller
+        key.append(fmt::format("{:02d}", std::min<std::size_t>(end - i, 99)));
+        key.append(folded, i, end - i);
+        i = end;
+    }
+
+    if (key.size() > 255) {
+        std::size_t cut = 255;
+        while (cut > 0 && (static_cast<unsigned char>(key[cut]) & 0xC0) == 0x80)
+            cut--;
+        key.resize(cut);
+    }
+    return key;
+}
+
 std::string getValueOrDefault(const std::vector<std::pair<std::string, std::string>>& m, const std::string& key, const std::string& defval)
 {
     return getValueOrDefault<std::string, std::string>(m, key, defval);
@@ -169,6 +169,15 @@ std::string fallbackString(const std::string& first, const std::string& fallback
 /// \return return the (unsigned int) hash value
 unsigned int stringHash(std::string_view str);
 
+/// \brief computes a key to sort titles by comparing the bytes
+///
+/// Letters are case folded, a leading article is removed and numbers are
+/// prefixed by their length, so "Track 2" sorts before "Track 10".
+/// \param title the title to compute the key for
+/// \param articles leading words that are ignored, like "The"
+/// \return return the key of at most 255 bytes
+std::string makeSortKey(std::string_view title, const std::vector<std::string>& articles = {});
+
 /// \brief Get value of map, iff not key is not in map return defval
 template <typename K, typename V>
 V getValueOrDefault(const std::vector<std::pair<K, V>>& m, const K& key, const V& defval)
@@ -281,6 +281,12 @@ void Web::ConfigLoad::writeDatabaseStatus(pugi::xml_node& values)
             setValue(item3, totalSize);
         }
     }
+
+    for (auto&& [attr, value] : database->getStatus()) {
+        auto item = values.append_child(CONFIG_LOAD_ITEM);
+        createItem(item, fmt::format("/status/attribute::{}", attr), ConfigVal::MAX, ConfigVal::MAX);
+        setValue(item, value);
+    }
 }
 
 /// \brief: write upnp shortcuts
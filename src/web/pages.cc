@@ -79,6 +79,8 @@ std::unique_ptr<WebRequestHandler> createWebRequestHandler(
         return std::make_unique<Web::Action>(content, server, xmlBuilder, quirks);
     if (page == "clients")
         return std::make_unique<Web::Clients>(content, server, xmlBuilder, quirks);
+    if (page == "queries")
+        return std::make_unique<Web::Queries>(content, server, xmlBuilder, quirks);
     if (page == "config_load")
         return std::make_unique<Web::ConfigLoad>(content, server, xmlBuilder, quirks);
     if (page == "config_save")
@@ -235,6 +235,14 @@ public:
     void process() override;
 };
 
+/// \brief Run time statistics and slow statements of the database
+class Queries : public WebRequestHandler {
+    using WebRequestHandler::WebRequestHandler;
+
+public:
+    void process() override;
+};
+
 /// \brief Call from WebUi to load configuration
 class ConfigLoad : public WebRequestHandler {
 protected:
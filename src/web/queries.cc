@@ -0,0 +1,59 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    web/queries.cc - this file is part of Gerbera.
+
+    Copyright (C) 2025 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file web/queries.cc
+#define GRB_LOG_FAC GrbLogFacility::web
+
+#include "pages.h" // API
+
+#include "content/content.h"
+#include "context.h"
+#include "database/database.h"
+#include "util/xml_to_json.h"
+
+#define WEB_QUERY_STATS_COUNT 25 // number of statement shapes shown
+
+void Web::Queries::process()
+{
+    checkRequest();
+    auto root = xmlDoc->document_element();
+    auto database = content->getContext()->getDatabase();
+
+    // statement shapes with the highest total run time
+    auto queries = root.append_child("queries");
+    xml2Json->setArrayName(queries, "query");
+    for (auto&& stats : database->getQueryStats(WEB_QUERY_STATS_COUNT)) {
+        auto item = queries.append_child("query");
+        for (auto&& [key, value] : stats)
+            item.append_attribute(key.c_str()) = value.c_str();
+    }
+
+    // most recent slow statements
+    auto slow = root.append_child("slow");
+    xml2Json->setArrayName(slow, "query");
+    for (auto&& entry : database->getSlowQueries()) {
+        auto item = slow.append_child("query");
+        for (auto&& [key, value] : entry)
+            item.append_attribute(key.c_str()) = value.c_str();
+    }
+}
@@ -0,0 +1,107 @@
+/*GRB*
+    Gerbera - https://gerbera.io/
+
+    test_import_batch.cc - this file is part of Gerbera.
+
+    Copyright (C) 2025 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+#include "cds/cds_item.h"
+#include "config/config_setup.h"
+#include "content/import_service.h"
+#include "upnp/clients.h"
+#include "exceptions.h"
+
+#include "../mock/config_mock.h"
+#include "../mock/database_mock.h"
+
+#include <gtest/gtest.h>
+#include <thread>
+
+/// \brief records the batches passed to addObjects
+class BatchDatabaseMock : public DatabaseMock {
+public:
+    using DatabaseMock::DatabaseMock;
+
+    void addObjects(const std::vector<std::shared_ptr<CdsObject>>& objects) override
+    {
+        if (failAdd)
+            throw_std_runtime_error("addObjects failed");
+        batches.push_back(objects.size());
+    }
+
+    std::vector<std::size_t> batches;
+    bool failAdd { false };
+};
+
+class ImportBatchTest : public ::testing::Test {
+public:
+    void SetUp() override
+    {
+        database = std::make_shared<BatchDatabaseMock>(std::make_shared<ConfigMock>());
+    }
+
+    std::shared_ptr<BatchDatabaseMock> database;
+};
+
+TEST_F(ImportBatchTest, WritesFullBatches)
+{
+    {
+        ImportBatch batch(database, 3, std::chrono::hours(1));
+        for (int i = 0; i < 7; i++)
+            batch.add(std::make_shared<CdsItem>());
+        EXPECT_EQ(database->batches, std::vector<std::size_t>({ 3, 3 }));
+        EXPECT_EQ(batch.size(), 1U);
+        batch.flush();
+        EXPECT_EQ(batch.size(), 0U);
+    }
+    EXPECT_EQ(database->batches, std::vector<std::size_t>({ 3, 3, 1 }));
+}
+
+TEST_F(ImportBatchTest, WritesDueBatches)
+{
+    ImportBatch batch(database, 100, std::chrono::milliseconds(10));
+    batch.flushIfDue();
+    batch.add(std::make_shared<CdsItem>());
+    batch.flushIfDue();
+    EXPECT_TRUE(database->batches.empty());
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    batch.flushIfDue();
+    EXPECT_EQ(database->batches, std::vector<std::size_t>({ 1 }));
+}
+
+TEST_F(ImportBatchTest, WritesPendingOnException)
+{
+    try {
+        ImportBatch batch(database, 100, std::chrono::hours(1));
+        batch.add(std::make_shared<CdsItem>());
+        batch.add(std::make_shared<CdsItem>());
+        throw_std_runtime_error("import failed");
+    } catch (const std::runtime_error&) {
+    }
+    EXPECT_EQ(database->batches, std::vector<std::size_t>({ 2 }));
+
+    // a failing write in the destructor is logged
+    database->failAdd = true;
+    {
+        ImportBatch batch(database, 100, std::chrono::hours(1));
+        batch.add(std::make_shared<CdsItem>());
+    }
+    database->failAdd = false;
+    EXPECT_EQ(database->batches, std::vector<std::size_t>({ 2 }));
+}
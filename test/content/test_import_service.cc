@@ -0,0 +1,152 @@
+/*GRB*
+    Gerbera - https://gerbera.io/
+
+    test_import_service.cc - this file is part of Gerbera.
+
+    Copyright (C) 2025 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+#include "cds/cds_container.h"
+#include "cds/cds_item.h"
+#include "config/config_definition.h"
+#include "config/config_setup.h"
+#include "config/result/directory_tweak.h"
+#include "content/autoscan_setting.h"
+#include "content/import_service.h"
+#include "context.h"
+#include "upnp/clients.h"
+#include "upnp/upnp_common.h"
+#include "util/grb_time.h"
+
+#include "../mock/config_mock.h"
+#include "../mock/database_mock.h"
+
+#include <fstream>
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+/// \brief configuration without directory tweaks
+class ImportConfigMock : public ConfigMock {
+public:
+    std::shared_ptr<DirectoryConfigList> getDirectoryTweakOption(ConfigVal option) const override { return tweaks; }
+
+    std::shared_ptr<DirectoryConfigList> tweaks = std::make_shared<DirectoryConfigList>();
+};
+
+/// \brief stores one directory with one file and records the objects read and written
+class RescanDatabaseMock : public DatabaseMock {
+public:
+    using DatabaseMock::DatabaseMock;
+
+    std::shared_ptr<CdsObject> findObjectByPath(const fs::path& path, const std::string& group, DbFileType fileType) override
+    {
+        foundPaths.push_back(path);
+        return path == container->getLocation() ? container : nullptr;
+    }
+
+    std::unordered_map<std::string, FileState> getFileStates(int containerId) override
+    {
+        if (containerId != container->getID())
+            return {};
+        return { { item->getLocation().string(), { item->getID(), item->getParentID(), item->getFlags(), item->getMTime(), item->getClass(), item->getMimeType() } } };
+    }
+
+    std::shared_ptr<CdsObject> loadObject(int objectID) override
+    {
+        if (objectID != item->getID())
+            return nullptr;
+        auto loaded = std::make_shared<CdsItem>();
+        item->copyTo(loaded);
+        return loaded;
+    }
+
+    void updateObject(const std::shared_ptr<CdsObject>& object, int* changedContainer) override
+    {
+        updatedIds.push_back(object->getID());
+    }
+
+    std::shared_ptr<CdsContainer> container;
+    std::shared_ptr<CdsItem> item;
+    std::vector<fs::path> foundPaths;
+    std::vector<int> updatedIds;
+};
+
+class ImportServiceTest : public ::testing::Test {
+public:
+    void SetUp() override
+    {
+        scanDir = fs::temp_directory_path() / fmt::format("gerbera-import-test-{}", ::getpid());
+        fs::create_directories(scanDir);
+        auto file = scanDir / "song.mp3";
+        std::ofstream(file) << "data";
+
+        auto config = std::make_shared<ImportConfigMock>();
+        database = std::make_shared<RescanDatabaseMock>(config);
+
+        database->container = std::make_shared<CdsContainer>("dir", UPNP_CLASS_CONTAINER_FOLDER);
+        database->container->setID(5);
+        database->container->setParentID(CDS_ID_FS_ROOT);
+        database->container->setLocation(scanDir);
+        database->container->setMTime(toSeconds(fs::directory_entry(scanDir).last_write_time()));
+        // container art is assigned already, so no handler is needed
+        database->container->addResource(std::make_shared<CdsResource>(ContentHandler::CONTAINERART, ResourcePurpose::Thumbnail));
+
+        database->item = std::make_shared<CdsItem>();
+        database->item->setID(7);
+        database->item->setParentID(5);
+        database->item->setTitle("Song");
+        database->item->setLocation(file);
+        database->item->setMimeType("audio/mpeg");
+        database->item->setClass(UPNP_CLASS_MUSIC_TRACK);
+        database->item->setMTime(toSeconds(fs::directory_entry(file).last_write_time()));
+        database->item->addMetaData(MetadataFields::M_ARTIST, "Artist");
+
+        auto definition = std::make_shared<ConfigDefinition>();
+        definition->init(definition);
+        auto context = std::make_shared<Context>(definition, config, nullptr, nullptr, database, nullptr, nullptr);
+        importService = std::make_shared<ImportService>(context, nullptr);
+    }
+
+    void TearDown() override
+    {
+        std::error_code ec;
+        fs::remove_all(scanDir, ec);
+    }
+
+    fs::path scanDir;
+    std::shared_ptr<RescanDatabaseMock> database;
+    std::shared_ptr<ImportService> importService;
+};
+
+TEST_F(ImportServiceTest, RescanKeepsUnchangedItems)
+{
+    AutoScanSetting settings;
+    std::unordered_set<int> currentContent { database->item->getID() };
+    importService->doImport(scanDir, settings, currentContent, nullptr);
+
+    // the stored file state is enough to find the unchanged item
+    EXPECT_TRUE(currentContent.empty());
+    EXPECT_EQ(std::count(database->foundPaths.begin(), database->foundPaths.end(), database->item->getLocation()), 0);
+    EXPECT_EQ(std::count(database->updatedIds.begin(), database->updatedIds.end(), database->item->getID()), 0);
+
+    // callers get the full object, not the one built from the file state
+    auto object = importService->getObject(database->item->getLocation());
+    ASSERT_TRUE(object);
+    EXPECT_EQ(object->getID(), database->item->getID());
+    EXPECT_EQ(object->getTitle(), "Song");
+    EXPECT_EQ(object->getMetaData(MetadataFields::M_ARTIST), "Artist");
+}
@@ -0,0 +1,91 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    test_browse_cache.cc - this file is part of Gerbera.
+
+    Copyright (C) 2025 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+/// \file test_browse_cache.cc
+#include "upnp/browse_cache.h"
+
+#include <gtest/gtest.h>
+
+static std::shared_ptr<const BrowseCacheEntry> makeResponse(std::string result, std::size_t numberReturned = 1, int totalMatches = 1)
+{
+    return std::make_shared<const BrowseCacheEntry>(BrowseCacheEntry { std::move(result), numberReturned, totalMatches });
+}
+
+TEST(BrowseCacheTest, ReturnsStoredResponse)
+{
+    BrowseCache cache(4096);
+    EXPECT_EQ(cache.get("a"), nullptr);
+
+    cache.put("a", 2, { 5, 6 }, {}, cache.getGeneration(), makeResponse("<DIDL-Lite />", 2, 10));
+    auto response = cache.get("a");
+    ASSERT_NE(response, nullptr);
+    EXPECT_EQ(response->result, "<DIDL-Lite />");
+    EXPECT_EQ(response->numberReturned, 2);
+    EXPECT_EQ(response->totalMatches, 10);
+    EXPECT_EQ(cache.getHits(), 1);
+    EXPECT_EQ(cache.getMisses(), 1);
+}
+
+TEST(BrowseCacheTest, ContainerChangeDropsListingPages)
+{
+    BrowseCache cache(4096);
+    cache.put("container", 2, { 5, 6 }, {}, cache.getGeneration(), makeResponse("2"));
+    cache.put("parent", 1, { 2, 3 }, {}, cache.getGeneration(), makeResponse("1"));
+    cache.put("reference", 7, { 8 }, { 5 }, cache.getGeneration(), makeResponse("7"));
+    cache.put("sibling", 3, { 9 }, {}, cache.getGeneration(), makeResponse("3"));
+
+    cache.invalidate({ 2 });
+    EXPECT_EQ(cache.get("container"), nullptr);
+    EXPECT_EQ(cache.get("parent"), nullptr);
+    EXPECT_EQ(cache.get("reference"), nullptr);
+    EXPECT_NE(cache.get("sibling"), nullptr);
+
+    cache.invalidate({ 9 });
+    EXPECT_EQ(cache.get("sibling"), nullptr);
+}
+
+TEST(BrowseCacheTest, EvictsLeastRecentlyUsedBeyondCapacity)
+{
+    BrowseCache cache(1000);
+    auto result = std::string(100, 'x');
+    cache.put("a", 1, { 10 }, {}, cache.getGeneration(), makeResponse(result));
+    cache.put("b", 2, { 20 }, {}, cache.getGeneration(), makeResponse(result));
+    EXPECT_NE(cache.get("a"), nullptr);
+
+    cache.put("c", 3, { 30 }, {}, cache.getGeneration(), makeResponse(result));
+    EXPECT_LE(cache.getBytes(), 1000);
+    EXPECT_NE(cache.get("a"), nullptr);
+    EXPECT_EQ(cache.get("b"), nullptr);
+    EXPECT_NE(cache.get("c"), nullptr);
+
+    cache.invalidate({ 10 });
+    EXPECT_EQ(cache.get("a"), nullptr);
+}
+
+TEST(BrowseCacheTest, SkipsResponseRenderedBeforeInvalidation)
+{
+    BrowseCache cache(4096);
+    auto generation = cache.getGeneration();
+    cache.invalidate({ 9 });
+    cache.put("a", 9, { 10 }, {}, generation, makeResponse("9"));
+    EXPECT_EQ(cache.get("a"), nullptr);
+}
@@ -0,0 +1,78 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    test_didl_cache.cc - this file is part of Gerbera.
+
+    Copyright (C) 2025 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+/// \file test_didl_cache.cc
+#include "upnp/didl_cache.h"
+
+#include <gtest/gtest.h>
+
+TEST(DidlCacheTest, ReturnsStoredFragment)
+{
+    DidlCache cache(4096);
+    EXPECT_EQ(cache.get("a"), nullptr);
+
+    cache.put("a", 5, 2, -1, cache.getGeneration(), "<item id=\"5\" />\n");
+    auto fragment = cache.get("a");
+    ASSERT_NE(fragment, nullptr);
+    EXPECT_EQ(*fragment, "<item id=\"5\" />\n");
+    EXPECT_EQ(cache.getHits(), 1);
+    EXPECT_EQ(cache.getMisses(), 1);
+}
+
+TEST(DidlCacheTest, ContainerChangeDropsChildrenAndReferences)
+{
+    DidlCache cache(4096);
+    cache.put("container", 2, 1, -1, cache.getGeneration(), "2");
+    cache.put("child", 5, 2, -1, cache.getGeneration(), "5");
+    cache.put("reference", 8, 7, 5, cache.getGeneration(), "8");
+    cache.put("sibling", 6, 3, -1, cache.getGeneration(), "6");
+
+    cache.invalidate({ 2 });
+    EXPECT_EQ(cache.get("container"), nullptr);
+    EXPECT_EQ(cache.get("child"), nullptr);
+    EXPECT_EQ(cache.get("reference"), nullptr);
+    EXPECT_NE(cache.get("sibling"), nullptr);
+}
+
+TEST(DidlCacheTest, EvictsLeastRecentlyUsedBeyondCapacity)
+{
+    DidlCache cache(600);
+    auto fragment = std::string(100, 'x');
+    cache.put("a", 1, 0, -1, cache.getGeneration(), fragment);
+    cache.put("b", 2, 0, -1, cache.getGeneration(), fragment);
+    EXPECT_NE(cache.get("a"), nullptr);
+
+    cache.put("c", 3, 0, -1, cache.getGeneration(), fragment);
+    EXPECT_LE(cache.getBytes(), 600);
+    EXPECT_NE(cache.get("a"), nullptr);
+    EXPECT_EQ(cache.get("b"), nullptr);
+    EXPECT_NE(cache.get("c"), nullptr);
+}
+
+TEST(DidlCacheTest, SkipsFragmentRenderedBeforeInvalidation)
+{
+    DidlCache cache(4096);
+    auto generation = cache.getGeneration();
+    cache.invalidate({ 9 });
+    cache.put("a", 10, 9, -1, generation, "10");
+    EXPECT_EQ(cache.get("a"), nullptr);
+}
@@ -258,6 +258,7 @@ enum class TestCol {
     RefId,
     Last7,
     LastUpdated,
+    MetaAlbum,
 };
 
 std::string OTN = MetaEnumMapper::getMetaFieldName(MetadataFields::M_TRACKNUMBER);
@@ -308,10 +309,10 @@ public:
     void TearDown() override { }
 
     ::testing::AssertionResult executeSearchParserTest(const std::string& input,
-        const std::string& expectedOutput, const std::string& expectedRe = "")
+        const std::string& expectedOutput, const std::string& expectedRe = "", const std::shared_ptr<SearchIndex>& searchIndex = nullptr)
     {
         try {
-            DefaultSQLEmitter emitter(columnMapper, columnMapper, columnMapper, columnMapper);
+            DefaultSQLEmitter emitter(columnMapper, columnMapper, columnMapper, columnMapper, searchIndex);
             auto parser = SearchParser(emitter, input);
             auto rootNode = parser.parse();
             if (!rootNode)
@@ -440,6 +441,25 @@ TEST_F(ParserTest, SearchCriteriaUsingStartsWithOperator)
         "(_t_._property_name_='upnp:album' AND LOWER(_t_._property_value_) LIKE LOWER('Midnight%')) OR (_t_._property_name_='upnp:artist' AND LOWER(_t_._property_value_) LIKE LOWER('HEAVE%'))"));
 }
 
+TEST_F(ParserTest, SearchCriteriaUsingSearchIndex)
+{
+    auto searchIndex = std::make_shared<SearchIndex>();
+    searchIndex->properties = { "upnp:album", "upnp:artist" };
+    searchIndex->metaQuery = "SELECT _item_id_ FROM _idx_ WHERE _property_name_ = '{0}' AND _property_value_ LIKE {1}";
+
+    EXPECT_TRUE(executeSearchParserTest("upnp:album contains \"Midnight\"",
+        "(_t_._item_id_ IN (SELECT _item_id_ FROM _idx_ WHERE _property_name_ = 'upnp:album' AND _property_value_ LIKE '%Midnight%'))", "", searchIndex));
+
+    EXPECT_TRUE(executeSearchParserTest("upnp:album startswith \"Midnight\" or upnp:artist contains \"HEAVE\"",
+        "(_t_._item_id_ IN (SELECT _item_id_ FROM _idx_ WHERE _property_name_ = 'upnp:album' AND _property_value_ LIKE 'Midnight%')) OR (_t_._item_id_ IN (SELECT _item_id_ FROM _idx_ WHERE _property_name_ = 'upnp:artist' AND _property_value_ LIKE '%HEAVE%'))", "", searchIndex));
+
+    // operators and properties not covered by the index
+    EXPECT_TRUE(executeSearchParserTest("upnp:album doesnotcontain \"Midnight\"",
+        "(_t_._property_name_='upnp:album' AND LOWER(_t_._property_value_) NOT LIKE LOWER('%Midnight%'))", "", searchIndex));
+    EXPECT_TRUE(executeSearchParserTest("upnp:genre contains \"Rock\"",
+        "(_t_._property_name_='upnp:genre' AND LOWER(_t_._property_value_) LIKE LOWER('%Rock%'))", "", searchIndex));
+}
+
 TEST_F(ParserTest, SearchCriteriaUsingExistsOperator)
 {
     // (containsOpExpr)
@@ -537,3 +557,22 @@ TEST_F(ParserTest, SortTrackNumber)
     EXPECT_TRUE(executeSortParserTest("+upnp:originalTrackNumber",
         "_t_._number1_ ASC, _t_._number2_ ASC"));
 }
+
+TEST_F(ParserTest, SortPromotedMetadata)
+{
+    auto album = MetaEnumMapper::getMetaFieldName(MetadataFields::M_ALBUM);
+    testSortMap.emplace_back(album, TestCol::MetaAlbum);
+    testColMap.emplace(TestCol::MetaAlbum, SearchProperty { "t", "meta_upnp_album" });
+    auto promotedMapper = std::make_shared<EnumColumnMapper<TestCol>>('_', '_', "t", "TestTable", testSortMap, testColMap);
+
+    std::string addColumns;
+    std::string addJoin;
+    auto parser = SortParser(promotedMapper, promotedMapper, promotedMapper, "+upnp:album,-upnp:artist");
+    EXPECT_EQ(parser.parse(addColumns, addJoin), "_t_._meta_upnp_album_ ASC, _meta_prop0_._property_value_ DESC");
+    EXPECT_EQ(addJoin, "LEFT JOIN _TestTable_ _meta_prop0_ ON _t_._item_id_ = _meta_prop0_._item_id_ AND _meta_prop0_._property_name_ = 'upnp:artist'");
+
+    DefaultSQLEmitter emitter(promotedMapper, promotedMapper, promotedMapper, promotedMapper);
+    auto rootNode = SearchParser(emitter, "upnp:album exists true").parse();
+    ASSERT_TRUE(rootNode);
+    EXPECT_EQ(rootNode->emit(), "(_t_._meta_upnp_album_ IS NOT NULL)");
+}
@@ -31,6 +31,7 @@
 #include "context.h"
 #include "metadata/metadata_handler.h"
 #include "upnp/client_manager.h"
+#include "upnp/upnp_common.h"
 #include "upnp/xml_builder.h"
 #include "util/grb_net.h"
 #include "util/string_converter.h"
@@ -345,6 +346,111 @@ TEST_F(UpnpXmlTest, RenderObjectItemWithResources)
     EXPECT_STREQ(didlLiteXml.c_str(), expectedXml.str().c_str());
 }
 
+TEST_F(UpnpXmlTest, DidlLiteWriterMatchesDocument)
+{
+    // arrange
+    pugi::xml_document didlLite;
+    auto decl = didlLite.prepend_child(pugi::node_declaration);
+    decl.append_attribute("version") = "1.0";
+    decl.append_attribute("encoding") = "UTF-8";
+    auto root = didlLite.append_child("DIDL-Lite");
+    root.append_attribute(UPNP_XML_DIDL_LITE_NAMESPACE_ATTR) = UPNP_XML_DIDL_LITE_NAMESPACE;
+    root.append_attribute(UPNP_XML_DC_NAMESPACE_ATTR) = UPNP_XML_DC_NAMESPACE;
+    root.append_attribute(UPNP_XML_UPNP_NAMESPACE_ATTR) = UPNP_XML_UPNP_NAMESPACE;
+    root.append_attribute(UPNP_XML_SEC_NAMESPACE_ATTR) = UPNP_XML_SEC_NAMESPACE;
+
+    auto cont = std::make_shared<CdsContainer>();
+    cont->setID(1);
+    cont->setParentID(0);
+    cont->setTitle("Container & Co");
+    cont->setClass(UPNP_CLASS_CONTAINER);
+    cont->addMetaData(MetadataFields::M_DATE, "2022-04-01T00:00:00");
+
+    auto item = std::make_shared<CdsItem>();
+    item->setID(2);
+    item->setParentID(1);
+    item->setTitle("Title <1>");
+    item->setClass(UPNP_CLASS_MUSIC_TRACK);
+    item->addMetaData(MetadataFields::M_ALBUM, "Album");
+    item->addMetaData(MetadataFields::M_DATE, "2022-04-01T00:00:00");
+
+    EXPECT_CALL(*config, getOption(ConfigVal::IMPORT_LIBOPTS_ENTRY_SEP))
+        .WillRepeatedly(Return(" / "));
+    EXPECT_CALL(*config, getTranscodingProfileListOption(_))
+        .WillRepeatedly(Return(std::make_shared<TranscodingProfileList>()));
+
+    // act
+    auto writer = DidlLiteWriter(true, 0, 2);
+    for (auto&& obj : std::vector<std::shared_ptr<CdsObject>> { cont, item }) {
+        subject->renderObject(obj, { "*" }, std::string::npos, root);
+        subject->renderObject(obj, { "*" }, std::string::npos, writer);
+    }
+
+    // assert
+    std::string didlLiteXml = UpnpXMLBuilder::printXml(didlLite, "", 0);
+    EXPECT_EQ(writer.finish(), didlLiteXml);
+}
+
+TEST_F(UpnpXmlTest, DidlLiteWriterWithoutObjects)
+{
+    auto writer = DidlLiteWriter(false, pugi::format_no_escapes);
+    writer.addNamespace("xmlns:pv", "http://www.pv.com/pvns/");
+
+    std::ostringstream expectedXml;
+    expectedXml << "<DIDL-Lite xmlns=\"" << UPNP_XML_DIDL_LITE_NAMESPACE << "\"";
+    expectedXml << " xmlns:dc=\"" << UPNP_XML_DC_NAMESPACE << "\"";
+    expectedXml << " xmlns:upnp=\"" << UPNP_XML_UPNP_NAMESPACE << "\"";
+    expectedXml << " xmlns:sec=\"" << UPNP_XML_SEC_NAMESPACE << "\"";
+    expectedXml << " xmlns:pv=\"http://www.pv.com/pvns/\" />\n";
+
+    EXPECT_EQ(writer.finish(), expectedXml.str());
+}
+
+TEST_F(UpnpXmlTest, DidlLiteWriterJoinsParts)
+{
+    auto whole = DidlLiteWriter(true, 0);
+    auto joined = DidlLiteWriter(true, 0);
+    auto first = DidlLiteWriter(false, 0);
+    auto second = DidlLiteWriter(false, 0);
+    auto empty = DidlLiteWriter(false, 0);
+    for (auto&& fragment : { "<item id=\"1\" />\n", "<item id=\"2\" />\n" }) {
+        whole.appendObject(fragment);
+        first.appendObject(fragment);
+    }
+    whole.appendObject("<item id=\"3\" />\n");
+    second.appendObject("<item id=\"3\" />\n");
+
+    joined.appendObjects(first);
+    joined.appendObjects(empty);
+    joined.appendObjects(second);
+
+    EXPECT_EQ(joined.lastObject(), "<item id=\"3\" />\n");
+    EXPECT_EQ(joined.finish(), whole.finish());
+}
+
+TEST_F(UpnpXmlTest, CompileFilter)
+{
+    auto all = subject->compileFilter({ "*" });
+    auto&& allFilters = all.getFilters(ConfigVal::UPNP_TITLE_NAMESPACES);
+    EXPECT_TRUE(allFilters.objFilter.isAll());
+    EXPECT_TRUE(allFilters.cntFilter.isAll());
+    EXPECT_TRUE(allFilters.resFilter.isAll());
+
+    auto filter = subject->compileFilter({ "dc:title", "upnp:artist@role", "res", "res@size", "@childCount", "xbmc:rating" });
+    EXPECT_EQ(filter.getSignature(), "dc:title,upnp:artist@role,res,res@size,@childCount,xbmc:rating");
+    auto&& filters = filter.getFilters(ConfigVal::UPNP_ALBUM_NAMESPACES);
+    EXPECT_FALSE(filters.objFilter.isAll());
+    EXPECT_TRUE(filters.objFilter.contains("dc:title"));
+    EXPECT_TRUE(filters.objFilter.contains("dc:date"));
+    EXPECT_TRUE(filters.objFilter.containsField("upnp:artist@role[AlbumArtist]"));
+    EXPECT_FALSE(filters.objFilter.containsField("upnp:genre"));
+    EXPECT_FALSE(filters.objFilter.contains("xbmc:rating"));
+    EXPECT_TRUE(filters.cntFilter.contains("childCount"));
+    EXPECT_TRUE(filters.resFilter.contains("size"));
+    EXPECT_TRUE(filters.resFilter.contains("protocolInfo"));
+    EXPECT_FALSE(filters.resFilter.contains("duration"));
+}
+
 TEST_F(UpnpXmlTest, CreatesEventPropertySet)
 {
     auto result = subject->createEventPropertySet();
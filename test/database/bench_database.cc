@@ -0,0 +1,435 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    bench_database.cc - this file is part of Gerbera.
+
+    Copyright (C) 2025 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file bench_database.cc
+/// \brief Benchmark of the database layer with a synthetic library
+///
+/// A library of artist and album containers with tracks carrying metadata and
+/// a resource is written through the Database api and the typical requests are
+/// timed against it. Each result is printed as one json object per line.
+///
+/// Usage: benchdb [--sizes 10000,100000,1000000] [--runs 200] [--backend sqlite3|mysql|all]
+///                [--db /tmp/gerbera-bench.db] [--output results.json]
+///
+/// The MySQL backend is used when built with MySQL and GERBERA_BENCH_MYSQL_HOST is set,
+/// GERBERA_BENCH_MYSQL_USER, GERBERA_BENCH_MYSQL_PASSWORD and GERBERA_BENCH_MYSQL_DATABASE
+/// select the account and the (empty) database.
+#include "cds/cds_container.h"
+#include "cds/cds_item.h"
+#include "cds/cds_resource.h"
+#include "config/config.h"
+#include "database/db_param.h"
+#include "database/sqlite3/sqlite_database.h"
+#include "exceptions.h"
+#include "sqlite_config_fake.h"
+#include "upnp/upnp_common.h"
+#include "util/string_converter.h"
+#include "util/tools.h"
+
+#if HAVE_MYSQL
+#include "database/mysql/mysql_database.h"
+#include "mysql_config_fake.h"
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <spdlog/sinks/stdout_color_sinks.h>
+#include <spdlog/spdlog.h>
+
+#define BENCH_BATCH_SIZE 1000 // objects per addObjects call
+#define BENCH_ALBUM_TRACKS 10 // tracks in each album
+#define BENCH_ARTIST_ALBUMS 10 // albums of each artist
+#define BENCH_PAGE_SIZE 50 // requested count of browse and search
+
+class BenchSqliteConfig : public SqliteConfigFake {
+public:
+    explicit BenchSqliteConfig(fs::path dbFile)
+        : dbFile(std::move(dbFile))
+    {
+    }
+    std::string getOption(ConfigVal option) const override
+    {
+        if (option == ConfigVal::SERVER_STORAGE_SQLITE_DATABASE_FILE)
+            return dbFile;
+        if (option == ConfigVal::SERVER_STORAGE_SQLITE_INIT_SQL_FILE)
+            return BENCH_SQLITE_INIT_FILE;
+        if (option == ConfigVal::SERVER_STORAGE_SQLITE_UPGRADE_FILE)
+            return BENCH_SQLITE_UPGRADE_FILE;
+        return SqliteConfigFake::getOption(option);
+    }
+    bool getBoolOption(ConfigVal option) const override { return false; }
+
+private:
+    fs::path dbFile;
+};
+
+#if HAVE_MYSQL
+class BenchMySQLConfig : public MySQLConfigFake {
+public:
+    std::string getOption(ConfigVal option) const override
+    {
+        if (option == ConfigVal::SERVER_STORAGE_MYSQL_HOST)
+            return getEnv("GERBERA_BENCH_MYSQL_HOST");
+        if (option == ConfigVal::SERVER_STORAGE_MYSQL_USERNAME)
+            return getEnv("GERBERA_BENCH_MYSQL_USER");
+        if (option == ConfigVal::SERVER_STORAGE_MYSQL_PASSWORD)
+            return getEnv("GERBERA_BENCH_MYSQL_PASSWORD");
+        if (option == ConfigVal::SERVER_STORAGE_MYSQL_DATABASE)
+            return getEnv("GERBERA_BENCH_MYSQL_DATABASE");
+        if (option == ConfigVal::SERVER_STORAGE_MYSQL_INIT_SQL_FILE)
+            return BENCH_MYSQL_INIT_FILE;
+        if (option == ConfigVal::SERVER_STORAGE_MYSQL_UPGRADE_FILE)
+            return BENCH_MYSQL_UPGRADE_FILE;
+        return MySQLConfigFake::getOption(option);
+    }
+    std::int32_t getIntOption(ConfigVal option) const override
+    {
+        return option == ConfigVal::SERVER_STORAGE_MYSQL_CONNECTIONS ? 1 : 0;
+    }
+
+private:
+    static std::string getEnv(const char* name)
+    {
+        auto value = std::getenv(name);
+        return value ? value : "";
+    }
+};
+#endif
+
+/// \brief Layout of the synthetic library, tracks are numbered from 0
+struct BenchLibrary {
+    explicit BenchLibrary(std::size_t objects)
+    {
+        albums = std::max<std::size_t>(1, objects / (BENCH_ALBUM_TRACKS + 1));
+        artists = std::max<std::size_t>(1, albums / BENCH_ARTIST_ALBUMS);
+        tracks = objects > albums + artists + 1 ? objects - albums - artists - 1 : 1;
+    }
+
+    std::size_t artists;
+    std::size_t albums;
+    std::size_t tracks;
+
+    std::size_t albumOfTrack(std::size_t track) const { return track % albums; }
+    std::size_t artistOfAlbum(std::size_t album) const { return album % artists; }
+
+    static std::string artistName(std::size_t artist) { return fmt::format("Artist {}", artist); }
+    static std::string albumName(std::size_t album) { return fmt::format("Album {}", album); }
+    static std::string trackName(std::size_t track) { return fmt::format("Track {}", track); }
+
+    fs::path artistPath(std::size_t artist) const { return fs::path("/bench") / artistName(artist); }
+    fs::path albumPath(std::size_t album) const { return artistPath(artistOfAlbum(album)) / albumName(album); }
+    fs::path trackPath(std::size_t track) const { return albumPath(albumOfTrack(track)) / fmt::format("{}.mp3", trackName(track)); }
+};
+
+/// \brief Durations of all runs of one operation
+class BenchResult {
+public:
+    BenchResult(std::string backend, std::size_t objects, std::string operation)
+        : backend(std::move(backend))
+        , objects(objects)
+        , operation(std::move(operation))
+    {
+    }
+
+    template <typename F>
+    void run(F&& func)
+    {
+        auto start = std::chrono::steady_clock::now();
+        func();
+        runs.push_back(std::chrono::steady_clock::now() - start);
+    }
+
+    std::string toJson() const
+    {
+        auto sorted = runs;
+        std::sort(sorted.begin(), sorted.end());
+        auto total = std::accumulate(sorted.begin(), sorted.end(), std::chrono::duration<double, std::milli>::zero());
+        auto percentile = [&sorted](double p) { return sorted.empty() ? 0.0 : sorted.at(std::min(sorted.size() - 1, static_cast<std::size_t>(p * sorted.size()))).count(); };
+        return fmt::format(R"({{"backend":"{}","objects":{},"operation":"{}","runs":{},"total_ms":{:.3f},"mean_ms":{:.3f},"p50_ms":{:.3f},"p95_ms":{:.3f},"max_ms":{:.3f}}})",
+            backend, objects, operation, sorted.size(), total.count(), sorted.empty() ? 0.0 : total.count() / sorted.size(),
+            percentile(0.5), percentile(0.95), sorted.empty() ? 0.0 : sorted.back().count());
+    }
+
+private:
+    std::string backend;
+    std::size_t objects;
+    std::string operation;
+    std::vector<std::chrono::duration<double, std::milli>> runs;
+};
+
+class DatabaseBenchmark {
+public:
+    DatabaseBenchmark(std::string backend, std::shared_ptr<Database> database, std::size_t objects, std::size_t runs, std::ostream& out)
+        : backend(std::move(backend))
+        , database(std::move(database))
+        , library(objects)
+        , objects(objects)
+        , runs(runs)
+        , out(out)
+    {
+    }
+
+    void run()
+    {
+        import();
+        browse();
+        search();
+        childCounts();
+        findByPath();
+        remove();
+    }
+
+private:
+    std::string backend;
+    std::shared_ptr<Database> database;
+    BenchLibrary library;
+    std::size_t objects;
+    std::size_t runs;
+    std::ostream& out;
+    std::mt19937 random { 42 };
+
+    int rootId { INVALID_OBJECT_ID };
+    std::vector<int> artistIds;
+    std::vector<int> albumIds;
+
+    void report(const BenchResult& result)
+    {
+        out << result.toJson() << std::endl;
+    }
+
+    std::size_t pick(std::size_t count)
+    {
+        return std::uniform_int_distribution<std::size_t>(0, count - 1)(random);
+    }
+
+    static std::shared_ptr<CdsContainer> makeContainer(int parentId, const std::string& title, const fs::path& location, const std::string& upnpClass)
+    {
+        auto cont = std::make_shared<CdsContainer>(title, upnpClass);
+        cont->setParentID(parentId);
+        cont->setLocation(location);
+        cont->setVirtual(false);
+        return cont;
+    }
+
+    std::shared_ptr<CdsItem> makeTrack(std::size_t track) const
+    {
+        auto album = library.albumOfTrack(track);
+        auto item = std::make_shared<CdsItem>();
+        item->setParentID(albumIds.at(album));
+        item->setTitle(BenchLibrary::trackName(track));
+        item->setLocation(library.trackPath(track));
+        item->setMimeType("audio/mpeg");
+        item->setClass(UPNP_CLASS_MUSIC_TRACK);
+        item->setTrackNumber(track / library.albums + 1);
+        item->setVirtual(false);
+        item->addMetaData(MetadataFields::M_TITLE, BenchLibrary::trackName(track));
+        item->addMetaData(MetadataFields::M_ARTIST, BenchLibrary::artistName(library.artistOfAlbum(album)));
+        item->addMetaData(MetadataFields::M_ALBUM, BenchLibrary::albumName(album));
+        item->addMetaData(MetadataFields::M_GENRE, fmt::format("Genre {}", album % 20));
+        item->addMetaData(MetadataFields::M_DATE, fmt::format("{}-01-01", 1950 + album % 70));
+        auto resource = std::make_shared<CdsResource>(ContentHandler::DEFAULT, ResourcePurpose::Content);
+        resource->addAttribute(ResourceAttribute::PROTOCOLINFO, "http-get:*:audio/mpeg:*");
+        resource->addAttribute(ResourceAttribute::SIZE, fmt::to_string(3000000 + track % 1000));
+        resource->addAttribute(ResourceAttribute::DURATION, "0:03:30.000");
+        item->addResource(resource);
+        return item;
+    }
+
+    /// \brief add containers and tracks in batches, each batch is one run
+    void import()
+    {
+        BenchResult result(backend, objects, "import");
+        auto root = makeContainer(CDS_ID_FS_ROOT, "bench", "/bench", UPNP_CLASS_CONTAINER);
+        result.run([&] { database->addObject(root, nullptr); });
+        rootId = root->getID();
+
+        auto addBatches = [&](std::size_t count, auto&& make, std::vector<int>* ids) {
+            for (std::size_t start = 0; start < count; start += BENCH_BATCH_SIZE) {
+                std::vector<std::shared_ptr<CdsObject>> batch;
+                for (auto index = start; index < std::min(count, start + BENCH_BATCH_SIZE); index++)
+                    batch.push_back(make(index));
+                result.run([&] { database->addObjects(batch); });
+                if (ids)
+                    std::transform(batch.begin(), batch.end(), std::back_inserter(*ids), [](auto&& obj) { return obj->getID(); });
+            }
+        };
+        addBatches(library.artists, [&](std::size_t artist) { return makeContainer(rootId, BenchLibrary::artistName(artist), library.artistPath(artist), UPNP_CLASS_MUSIC_ARTIST); }, &artistIds);
+        addBatches(library.albums, [&](std::size_t album) { return makeContainer(artistIds.at(library.artistOfAlbum(album)), BenchLibrary::albumName(album), library.albumPath(album), UPNP_CLASS_MUSIC_ALBUM); }, &albumIds);
+        addBatches(library.tracks, [&](std::size_t track) { return makeTrack(track); }, nullptr);
+        report(result);
+    }
+
+    void browse()
+    {
+        BenchResult result(backend, objects, "browse");
+        for (std::size_t count = 0; count < runs; count++) {
+            auto parentId = count % 2 ? artistIds.at(pick(artistIds.size())) : albumIds.at(pick(albumIds.size()));
+            auto parent = database->loadObject(parentId);
+            BrowseParam param(parent, BROWSE_DIRECT_CHILDREN | BROWSE_ITEMS | BROWSE_CONTAINERS);
+            param.setRange(0, BENCH_PAGE_SIZE);
+            result.run([&] { database->browse(param); });
+        }
+        report(result);
+    }
+
+    void search()
+    {
+        BenchResult result(backend, objects, "search");
+        for (std::size_t count = 0; count < runs; count++) {
+            std::string criteria;
+            switch (count % 3) {
+            case 0:
+                criteria = fmt::format(R"(upnp:class derivedfrom "object.item.audioItem" and upnp:artist = "{}")", BenchLibrary::artistName(pick(library.artists)));
+                break;
+            case 1:
+                criteria = fmt::format(R"(upnp:album = "{}")", BenchLibrary::albumName(pick(library.albums)));
+                break;
+            default:
+                criteria = fmt::format(R"(dc:title contains "{}")", BenchLibrary::trackName(pick(library.tracks)));
+                break;
+            }
+            SearchParam param(fmt::to_string(CDS_ID_ROOT), criteria, "+dc:title", 0, BENCH_PAGE_SIZE, false, DEFAULT_CLIENT_GROUP);
+            result.run([&] { database->search(param); });
+        }
+        report(result);
+    }
+
+    void childCounts()
+    {
+        BenchResult result(backend, objects, "getChildCounts");
+        for (std::size_t count = 0; count < runs; count++) {
+            std::vector<int> ids;
+            for (std::size_t index = 0; index < BENCH_PAGE_SIZE; index++)
+                ids.push_back(albumIds.at(pick(albumIds.size())));
+            result.run([&] { database->getChildCounts(ids); });
+        }
+        report(result);
+    }
+
+    void findByPath()
+    {
+        BenchResult result(backend, objects, "findObjectByPath");
+        for (std::size_t count = 0; count < runs; count++) {
+            auto path = library.trackPath(pick(library.tracks));
+            std::shared_ptr<CdsObject> obj;
+            result.run([&] { obj = database->findObjectByPath(path, DEFAULT_CLIENT_GROUP, DbFileType::File); });
+            if (!obj)
+                throw_std_runtime_error("Track {} not found", path.string());
+        }
+        report(result);
+    }
+
+    /// \brief remove single albums with their tracks and finally the whole library
+    void remove()
+    {
+        BenchResult result(backend, objects, "removeObjects");
+        std::shuffle(albumIds.begin(), albumIds.end(), random);
+        for (std::size_t count = 0; count < std::min(runs, albumIds.size()); count++)
+            result.run([&] { database->removeObjects({ albumIds.at(count) }); });
+        report(result);
+
+        BenchResult tree(backend, objects, "removeTree");
+        tree.run([&] { database->removeObjects({ rootId }); });
+        report(tree);
+    }
+};
+
+static std::vector<std::size_t> parseSizes(const std::string& arg)
+{
+    std::vector<std::size_t> sizes;
+    for (auto&& size : splitString(arg, ','))
+        sizes.push_back(std::stoul(size));
+    return sizes;
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<std::size_t> sizes { 10000, 100000, 1000000 };
+    std::size_t runs = 200;
+    std::string backend = "all";
+    fs::path dbFile = fs::temp_directory_path() / "gerbera-bench.db";
+    std::string output;
+
+    for (int i = 1; i < argc; i++) {
+        std::string_view arg = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value of " << arg << std::endl;
+            return EXIT_FAILURE;
+        }
+        if (arg == "--sizes")
+            sizes = parseSizes(argv[++i]);
+        else if (arg == "--runs")
+            runs = std::stoul(argv[++i]);
+        else if (arg == "--backend")
+            backend = argv[++i];
+        else if (arg == "--db")
+            dbFile = argv[++i];
+        else if (arg == "--output")
+            output = argv[++i];
+        else {
+            std::cerr << "Unknown argument " << arg << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    // keep stdout for results
+    spdlog::set_default_logger(spdlog::stderr_color_mt("benchdb"));
+    spdlog::set_level(spdlog::level::warn);
+
+    std::ofstream outFile;
+    if (!output.empty())
+        outFile.open(output);
+    std::ostream& out = output.empty() ? std::cout : outFile;
+
+    try {
+        for (auto&& size : sizes) {
+            if (backend == "all" || backend == "sqlite3") {
+                fs::remove(dbFile);
+                auto config = std::make_shared<BenchSqliteConfig>(dbFile);
+                std::shared_ptr<Database> database = std::make_shared<Sqlite3Database>(config, nullptr, std::make_shared<ConverterManager>(config), nullptr);
+                database->init();
+                DatabaseBenchmark("sqlite3", database, size, runs, out).run();
+                database->shutdown();
+                fs::remove(dbFile);
+            }
+#if HAVE_MYSQL
+            if ((backend == "all" && std::getenv("GERBERA_BENCH_MYSQL_HOST")) || backend == "mysql") {
+                auto config = std::make_shared<BenchMySQLConfig>();
+                std::shared_ptr<Database> database = std::make_shared<MySQLDatabase>(config, nullptr, std::make_shared<ConverterManager>(config));
+                database->init();
+                DatabaseBenchmark("mysql", database, size, runs, out).run();
+                database->shutdown();
+            }
+#endif
+        }
+    } catch (const std::runtime_error& ex) {
+        std::cerr << "Benchmark failed: " << ex.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -168,4 +168,10 @@ TEST_F(MysqlDatabaseTest, CheckInitScript)
 
     EXPECT_EQ(myHash, std::dynamic_pointer_cast<SQLDatabase>(subject)->getHash(0));
 }
+
+TEST_F(MysqlDatabaseTest, QuoteWithoutConnection)
+{
+    // escaping needs the connection charset, without connection it fails instead of using a closed handle
+    EXPECT_THROW(std::dynamic_pointer_cast<SQLDatabase>(subject)->quote("it's"), std::runtime_error);
+}
 #endif
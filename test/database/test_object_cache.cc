@@ -0,0 +1,94 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    test_object_cache.cc - this file is part of Gerbera.
+
+    Copyright (C) 2025 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file test_object_cache.cc
+#include "cds/cds_container.h"
+#include "cds/cds_item.h"
+#include "database/object_cache.h"
+
+#include <fmt/core.h>
+#include <gtest/gtest.h>
+
+static std::shared_ptr<CdsObject> makeItem(int id, int refId = 0)
+{
+    auto item = std::make_shared<CdsItem>();
+    item->setID(id);
+    item->setRefID(refId);
+    item->setParentID(1);
+    item->setTitle(fmt::format("Item {}", id));
+    item->setMimeType("audio/mpeg");
+    return item;
+}
+
+TEST(ObjectCacheTest, ReturnsCopy)
+{
+    ObjectCache cache(10, 1);
+    EXPECT_EQ(cache.get(5), nullptr);
+
+    cache.put(makeItem(5), cache.getGeneration());
+    auto first = cache.get(5);
+    ASSERT_NE(first, nullptr);
+    EXPECT_EQ(first->getTitle(), "Item 5");
+
+    first->setTitle("Changed");
+    EXPECT_EQ(cache.get(5)->getTitle(), "Item 5");
+    EXPECT_EQ(cache.getHits(), 2);
+    EXPECT_EQ(cache.getMisses(), 1);
+}
+
+TEST(ObjectCacheTest, EvictsLeastRecentlyUsed)
+{
+    ObjectCache cache(2, 1);
+    cache.put(makeItem(1), cache.getGeneration());
+    cache.put(makeItem(2), cache.getGeneration());
+    EXPECT_NE(cache.get(1), nullptr);
+
+    cache.put(makeItem(3), cache.getGeneration());
+    EXPECT_EQ(cache.size(), 2);
+    EXPECT_NE(cache.get(1), nullptr);
+    EXPECT_EQ(cache.get(2), nullptr);
+    EXPECT_NE(cache.get(3), nullptr);
+    EXPECT_EQ(cache.getEvictions(), 1);
+}
+
+TEST(ObjectCacheTest, EraseRemovesReferrers)
+{
+    ObjectCache cache(10);
+    cache.put(makeItem(7), cache.getGeneration());
+    cache.put(makeItem(8, 7), cache.getGeneration());
+    cache.put(makeItem(9), cache.getGeneration());
+
+    cache.erase(7);
+    EXPECT_EQ(cache.get(7), nullptr);
+    EXPECT_EQ(cache.get(8), nullptr);
+    EXPECT_NE(cache.get(9), nullptr);
+}
+
+TEST(ObjectCacheTest, SkipsObjectLoadedBeforeChange)
+{
+    ObjectCache cache(10);
+    auto generation = cache.getGeneration();
+    cache.erase(4);
+    cache.put(makeItem(4), generation);
+    EXPECT_EQ(cache.get(4), nullptr);
+}
@@ -0,0 +1,88 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    test_query_stats.cc - this file is part of Gerbera.
+
+    Copyright (C) 2025 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file test_query_stats.cc
+#include "database/query_stats.h"
+
+#include <fmt/core.h>
+#include <gtest/gtest.h>
+
+using namespace std::chrono_literals;
+
+TEST(QueryStatsTest, NormalizeReplacesLiterals)
+{
+    EXPECT_EQ(QueryStats::normalize("SELECT \"c\".\"id\" FROM \"mt_cds_object\" \"c\" WHERE \"c\".\"id\" = 42"),
+        "SELECT \"c\".\"id\" FROM \"mt_cds_object\" \"c\" WHERE \"c\".\"id\" = ?");
+    EXPECT_EQ(QueryStats::normalize("SELECT * FROM `t` WHERE `name` = 'it''s' AND `x` = 'a\\'b'"),
+        "SELECT * FROM `t` WHERE `name` = ? AND `x` = ?");
+    EXPECT_EQ(QueryStats::normalize("SELECT  a1,\n meta_prop0 FROM t WHERE v > 1.5"),
+        "SELECT a1, meta_prop0 FROM t WHERE v > ?");
+}
+
+TEST(QueryStatsTest, NormalizeCollapsesLists)
+{
+    EXPECT_EQ(QueryStats::normalize("DELETE FROM t WHERE id IN (1, 2,3 , 4)"), "DELETE FROM t WHERE id IN (?)");
+    EXPECT_EQ(QueryStats::normalize("DELETE FROM t WHERE id IN (7)"), "DELETE FROM t WHERE id IN (?)");
+    EXPECT_EQ(QueryStats::normalize("SELECT a FROM t WHERE id = ? AND b = 'x'"), "SELECT a FROM t WHERE id = ? AND b = ?");
+}
+
+TEST(QueryStatsTest, VerbSkipsCommentsAndWhitespace)
+{
+    EXPECT_EQ(QueryStats::getVerb("select * from t"), "SELECT");
+    EXPECT_EQ(QueryStats::getVerb("\n  -- Find all descendants\nWITH RECURSIVE d(id) AS (SELECT 1) SELECT id FROM d"), "WITH");
+    EXPECT_EQ(QueryStats::getVerb("/* batch */ INSERT INTO t VALUES (1)"), "INSERT");
+    EXPECT_EQ(QueryStats::getVerb("UPDATE(t)"), "UPDATE");
+    EXPECT_EQ(QueryStats::getVerb("-- only a comment"), "");
+    EXPECT_EQ(QueryStats::getVerb(""), "");
+}
+
+TEST(QueryStatsTest, RecordsHistogramByShape)
+{
+    QueryStats stats(100ms);
+    EXPECT_FALSE(stats.record("SELECT a FROM t WHERE id = 1", 50us));
+    EXPECT_FALSE(stats.record("SELECT a FROM t WHERE id = 2", 5ms));
+    EXPECT_TRUE(stats.record("SELECT a FROM t WHERE id = 3", 200ms));
+    EXPECT_FALSE(stats.record("SELECT b FROM t", 2ms));
+
+    auto top = stats.getTop(10);
+    ASSERT_EQ(top.size(), 2);
+    EXPECT_EQ(top[0].shape, "SELECT a FROM t WHERE id = ?");
+    EXPECT_EQ(top[0].count, 3);
+    EXPECT_EQ(top[0].max, 200ms);
+    EXPECT_EQ(top[0].histogram, (std::array<std::size_t, QUERY_STATS_BUCKETS> { 1, 0, 1, 0, 1, 0 }));
+
+    EXPECT_EQ(stats.getTop(1).size(), 1);
+}
+
+TEST(QueryStatsTest, KeepsRecentSlowQueries)
+{
+    QueryStats stats(0ms);
+    EXPECT_FALSE(stats.record("SELECT 1", 10s));
+
+    for (int i = 0; i < QUERY_STATS_SLOW_LOG_SIZE + 5; i++)
+        stats.addSlowQuery(fmt::format("SELECT {}", i), 2s, "SCAN t");
+    auto slow = stats.getSlowQueries();
+    ASSERT_EQ(slow.size(), QUERY_STATS_SLOW_LOG_SIZE);
+    EXPECT_EQ(slow.front().query, fmt::format("SELECT {}", QUERY_STATS_SLOW_LOG_SIZE + 4));
+    EXPECT_EQ(slow.front().plan, "SCAN t");
+}
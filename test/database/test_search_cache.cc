@@ -0,0 +1,88 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    test_search_cache.cc - this file is part of Gerbera.
+
+    Copyright (C) 2025 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file test_search_cache.cc
+#include "database/search_cache.h"
+
+#include <gtest/gtest.h>
+
+static std::shared_ptr<const SearchCacheEntry> makeEntry(std::vector<int> ids)
+{
+    auto entry = std::make_shared<SearchCacheEntry>();
+    entry->totalMatches = ids.size();
+    entry->ids = std::move(ids);
+    return entry;
+}
+
+TEST(SearchCacheTest, ReturnsEntryOfSameUpdateId)
+{
+    SearchCache cache(10);
+    EXPECT_EQ(cache.get("a", 3), nullptr);
+
+    cache.put("a", 3, cache.getGeneration(), makeEntry({ 5, 2, 9 }));
+    auto entry = cache.get("a", 3);
+    ASSERT_NE(entry, nullptr);
+    EXPECT_EQ(entry->ids, std::vector<int>({ 5, 2, 9 }));
+    EXPECT_EQ(entry->totalMatches, 3);
+    EXPECT_EQ(cache.getHits(), 1);
+    EXPECT_EQ(cache.getMisses(), 1);
+}
+
+TEST(SearchCacheTest, NewUpdateIdDropsEntries)
+{
+    SearchCache cache(10);
+    cache.get("a", 1);
+    cache.put("a", 1, cache.getGeneration(), makeEntry({ 1 }));
+    cache.put("b", 1, cache.getGeneration(), makeEntry({ 2 }));
+
+    EXPECT_EQ(cache.get("a", 2), nullptr);
+    EXPECT_EQ(cache.size(), 0);
+
+    // results read for an older update id are not stored
+    cache.put("b", 1, cache.getGeneration(), makeEntry({ 2 }));
+    EXPECT_EQ(cache.get("b", 2), nullptr);
+    EXPECT_EQ(cache.get("b", 1), nullptr);
+}
+
+TEST(SearchCacheTest, EvictsLeastRecentlyUsed)
+{
+    SearchCache cache(2);
+    cache.put("a", 0, cache.getGeneration(), makeEntry({ 1 }));
+    cache.put("b", 0, cache.getGeneration(), makeEntry({ 2 }));
+    EXPECT_NE(cache.get("a", 0), nullptr);
+
+    cache.put("c", 0, cache.getGeneration(), makeEntry({ 3 }));
+    EXPECT_EQ(cache.size(), 2);
+    EXPECT_NE(cache.get("a", 0), nullptr);
+    EXPECT_EQ(cache.get("b", 0), nullptr);
+    EXPECT_NE(cache.get("c", 0), nullptr);
+}
+
+TEST(SearchCacheTest, SkipsResultReadBeforeClear)
+{
+    SearchCache cache(10);
+    auto generation = cache.getGeneration();
+    cache.clear();
+    cache.put("a", 0, generation, makeEntry({ 4 }));
+    EXPECT_EQ(cache.get("a", 0), nullptr);
+}
@@ -23,6 +23,7 @@
 
 /// \file test_sql_generators.cc
 #include "database/sql_database.h"
+#include "exceptions.h"
 
 #include "sqlite_config_fake.h"
 
@@ -31,6 +32,7 @@
 
 class TestDatabase : public SQLDatabase, public std::enable_shared_from_this<SQLDatabase> {
 public:
+    using SQLDatabase::getSeekCondition;
     using SQLDatabase::identifier;
 
     TestDatabase(const std::shared_ptr<Config>& config, const std::shared_ptr<Mime>& mime, const std::shared_ptr<ConverterManager>& converterManager)
@@ -142,3 +144,32 @@ TEST_F(DatabaseTest, DeleteTest)
     database->deleteRows("Table", "id", { 1, 2, 3 });
     EXPECT_EQ(database->lastStatement, "DELETE FROM [Table] WHERE [id] IN (1,2,3)");
 }
+
+TEST_F(DatabaseTest, SelectPreparedTest)
+{
+    database->selectPrepared("SELECT * FROM [Table] WHERE [id] = ? AND [name] = ? AND [ref] = ?", { 12, "Text", nullptr });
+    EXPECT_EQ(database->lastStatement, "SELECT * FROM [Table] WHERE [id] = 12 AND [name] = \"Text\" AND [ref] = NULL");
+
+    database->selectPrepared("SELECT '?', \"a?\", `b?` FROM [Table] WHERE [name] = 'it''s?' AND [id] = ?", { 12 });
+    EXPECT_EQ(database->lastStatement, "SELECT '?', \"a?\", `b?` FROM [Table] WHERE [name] = 'it''s?' AND [id] = 12");
+
+    EXPECT_THROW(database->selectPrepared("SELECT * FROM [Table] WHERE [id] = ?", {}), DatabaseException);
+    EXPECT_THROW(database->selectPrepared("SELECT * FROM [Table]", { 1 }), DatabaseException);
+}
+
+TEST_F(DatabaseTest, SeekConditionTest)
+{
+    EXPECT_EQ(TestDatabase::getSeekCondition({ "[a] ASC", "[id] ASC" }, { "'x'", "5" }),
+        "(([a] > 'x') OR ([a] = 'x' AND [id] > 5))");
+    EXPECT_EQ(TestDatabase::getSeekCondition({ "[a] DESC", "[id] ASC" }, { "'x'", "5" }),
+        "((([a] < 'x' OR [a] IS NULL)) OR ([a] = 'x' AND [id] > 5))");
+
+    // NULL sorts first ascending and last descending
+    EXPECT_EQ(TestDatabase::getSeekCondition({ "[a] ASC", "[id] ASC" }, { "NULL", "5" }),
+        "(([a] IS NOT NULL) OR ([a] IS NULL AND [id] > 5))");
+    EXPECT_EQ(TestDatabase::getSeekCondition({ "[a] DESC", "[id] ASC" }, { "NULL", "5" }),
+        "(([a] IS NULL AND [id] > 5))");
+    EXPECT_EQ(TestDatabase::getSeekCondition({ "[a] DESC" }, { "NULL" }), "0 = 1");
+
+    EXPECT_THROW(TestDatabase::getSeekCondition({ "[a] ASC", "[id] ASC" }, { "5" }), DatabaseException);
+}
@@ -0,0 +1,689 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    test_sqlite_database.cc - this file is part of Gerbera.
+
+    Copyright (C) 2025 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+
+/// \file test_sqlite_database.cc
+#include "cds/cds_container.h"
+#include "cds/cds_item.h"
+#include "config/config.h"
+#include "database/db_param.h"
+#include "database/search_cache.h"
+#include "database/sqlite3/sl_task.h"
+#include "database/sqlite3/sqlite_database.h"
+#include "exceptions.h"
+#include "util/string_converter.h"
+
+#include "sqlite_config_fake.h"
+
+#include <fmt/core.h>
+#include <gtest/gtest.h>
+#include <set>
+#include <thread>
+
+/// \brief Configuration of a database file in the temp directory, options are set by the test
+class SqliteTestConfig : public SqliteConfigFake {
+public:
+    explicit SqliteTestConfig(fs::path dbFile)
+        : dbFile(std::move(dbFile))
+    {
+    }
+
+    std::string getOption(ConfigVal option) const override
+    {
+        if (option == ConfigVal::SERVER_STORAGE_SQLITE_DATABASE_FILE)
+            return dbFile;
+        if (option == ConfigVal::SERVER_STORAGE_SQLITE_JOURNALMODE)
+            return journalMode;
+        return SqliteConfigFake::getOption(option);
+    }
+    std::int32_t getIntOption(ConfigVal option) const override
+    {
+        auto entry = intOptions.find(option);
+        return entry != intOptions.end() ? entry->second : 0;
+    }
+    bool getBoolOption(ConfigVal option) const override
+    {
+        auto entry = boolOptions.find(option);
+        return entry != boolOptions.end() ? entry->second : SqliteConfigFake::getBoolOption(option);
+    }
+
+    fs::path dbFile;
+    std::string journalMode { "DELETE" };
+    std::map<ConfigVal, std::int32_t> intOptions;
+    std::map<ConfigVal, bool> boolOptions;
+};
+
+/// \brief access to the query helpers of SQLDatabase
+class SqlHelpers : public SQLDatabase {
+public:
+    using SQLDatabase::getSeekCondition;
+    using SQLDatabase::getSortKeyColumns;
+    using SQLDatabase::getSortKeys;
+};
+
+class SqliteDatabaseTest : public ::testing::Test {
+public:
+    void SetUp() override
+    {
+        dbFile = fs::temp_directory_path() / fmt::format("gerbera-test-{}.db", ::testing::UnitTest::GetInstance()->current_test_info()->name());
+        removeFiles();
+        config = std::make_shared<SqliteTestConfig>(dbFile);
+    }
+
+    void TearDown() override
+    {
+        if (database)
+            database->shutdown();
+        database = nullptr;
+        sqlDatabase = nullptr;
+        removeFiles();
+    }
+
+protected:
+    /// \brief create the database with the options set by the test
+    void start()
+    {
+        if (config->getBoolOption(ConfigVal::SERVER_STORAGE_USE_TRANSACTIONS))
+            sqlDatabase = std::make_shared<Sqlite3DatabaseWithTransactions>(config, nullptr, std::make_shared<ConverterManager>(config), nullptr);
+        else
+            sqlDatabase = std::make_shared<Sqlite3Database>(config, nullptr, std::make_shared<ConverterManager>(config), nullptr);
+        database = sqlDatabase;
+        database->init();
+    }
+
+    /// \brief first column of the first row returned by query
+    std::string selectValue(const std::string& query, const std::vector<SQLParam>& params)
+    {
+        auto res = sqlDatabase->selectPrepared(query, params);
+        if (!res)
+            return "<no result>";
+        auto row = res->nextRow();
+        return row ? row->col(0) : "<no row>";
+    }
+
+    /// \brief value of key in the internal settings of the backup file
+    std::string backupValue(const std::string& key) const
+    {
+        sqlite3* db = nullptr;
+        std::string value = "<no backup>";
+        if (sqlite3_open_v2(fmt::format(SQLITE3_BACKUP_FORMAT, dbFile.string()).c_str(), &db, SQLITE_OPEN_READONLY, nullptr) == SQLITE_OK) {
+            sqlite3_stmt* stmt = nullptr;
+            if (sqlite3_prepare_v2(db, R"(SELECT "value" FROM "mt_internal_setting" WHERE "key" = ?)", -1, &stmt, nullptr) == SQLITE_OK) {
+                sqlite3_bind_text(stmt, 1, key.c_str(), -1, SQLITE_TRANSIENT);
+                value = sqlite3_step(stmt) == SQLITE_ROW ? reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0)) : "<no row>";
+            }
+            sqlite3_finalize(stmt);
+        }
+        sqlite3_close(db);
+        return value;
+    }
+
+    /// \brief run a timed backup and wait for it by shutting the database down
+    void backupAndShutdown()
+    {
+        std::dynamic_pointer_cast<Sqlite3Database>(sqlDatabase)->timerNotify(nullptr);
+        database->shutdown();
+        database = nullptr;
+    }
+
+    /// \brief number of containers whose stored child counts differ from their children
+    std::string wrongChildCounts()
+    {
+        return selectValue(R"(SELECT COUNT(*) FROM "mt_cds_object" "p" WHERE "p"."object_type" = 1 AND ()"
+                           R"("p"."child_containers" <> (SELECT COUNT(*) FROM "mt_cds_object" "c" WHERE "c"."parent_id" = "p"."id" AND "c"."object_type" = 1) OR )"
+                           R"("p"."child_items" <> (SELECT COUNT(*) FROM "mt_cds_object" "c" WHERE "c"."parent_id" = "p"."id" AND ("c"."object_type" & 2) = 2)))",
+            {});
+    }
+
+    /// \brief number of ancestors stored for id
+    int ancestorCount(int id)
+    {
+        return std::stoi(selectValue(R"(SELECT COUNT(*) FROM "grb_cds_ancestor" WHERE "object_id" = ?)", { id }));
+    }
+
+    /// \brief stored child containers and items of container id
+    std::string childCounts(int id)
+    {
+        return selectValue(R"(SELECT "child_containers" || '/' || "child_items" FROM "mt_cds_object" WHERE "id" = ?)", { id });
+    }
+
+    static std::shared_ptr<CdsContainer> makeContainer(int parentId, const std::string& title)
+    {
+        auto cont = std::make_shared<CdsContainer>(title, UPNP_CLASS_CONTAINER);
+        cont->setParentID(parentId);
+        cont->setLocation(fmt::format("/test/{}", title));
+        cont->setVirtual(false);
+        return cont;
+    }
+
+    static std::shared_ptr<CdsItem> makeItem(int parentId, const std::string& title)
+    {
+        auto item = std::make_shared<CdsItem>();
+        item->setParentID(parentId);
+        item->setTitle(title);
+        item->setLocation(fmt::format("/test/{}.mp3", title));
+        item->setMimeType("audio/mpeg");
+        item->setClass(UPNP_CLASS_MUSIC_TRACK);
+        item->setVirtual(false);
+        return item;
+    }
+
+    void removeFiles() const
+    {
+        for (auto&& suffix : { "", "-wal", "-shm", "-journal", ".backup" }) {
+            std::error_code ec;
+            fs::remove(fmt::format("{}{}", dbFile.string(), suffix), ec);
+        }
+    }
+
+    fs::path dbFile;
+    std::shared_ptr<SqliteTestConfig> config;
+    std::shared_ptr<Database> database;
+    std::shared_ptr<SQLDatabase> sqlDatabase;
+};
+
+TEST_F(SqliteDatabaseTest, PreparedStatement)
+{
+    start();
+    database->storeInternalSetting("test-key", "test-value");
+
+    EXPECT_EQ(selectValue(R"(SELECT "value" FROM "mt_internal_setting" WHERE "key" = ?)", { "test-key" }), "test-value");
+    EXPECT_EQ(selectValue(R"(SELECT "value" FROM "mt_internal_setting" WHERE "key" = ?)", { "missing" }), "<no row>");
+    // placeholders in literals are no parameters
+    EXPECT_EQ(selectValue(R"(SELECT '?' || "value" FROM "mt_internal_setting" WHERE "key" = ?)", { "test-key" }), "?test-value");
+    EXPECT_EQ(selectValue("SELECT ?", { nullptr }), "");
+    EXPECT_EQ(selectValue("SELECT ? + 1", { 41 }), "42");
+}
+
+TEST_F(SqliteDatabaseTest, PreparedStatementCacheEviction)
+{
+    start();
+
+    // more statements than the cache holds, each is used again after being evicted
+    for (int round = 0; round < 2; round++) {
+        for (int i = 0; i < STATEMENT_CACHE_MAX_SIZE * 2; i++) {
+            EXPECT_EQ(selectValue(fmt::format("SELECT ? + {}", i), { 1 }), fmt::to_string(i + 1));
+        }
+    }
+}
+
+TEST_F(SqliteDatabaseTest, TypedColumns)
+{
+    start();
+
+    auto res = sqlDatabase->select("SELECT 42, 'text', NULL, '', x'00ff41'");
+    ASSERT_NE(res, nullptr);
+    auto row = res->nextRow();
+    ASSERT_NE(row, nullptr);
+    EXPECT_EQ(row->col_long(0, -1), 42);
+    EXPECT_EQ(row->col_int(0, -1), 42);
+    EXPECT_EQ(row->col(0), "42");
+    EXPECT_EQ(row->col_view(1), "text");
+    EXPECT_TRUE(row->isNullOrEmpty(2));
+    EXPECT_EQ(row->col_int(2, -1), -1);
+    EXPECT_TRUE(row->isNullOrEmpty(3));
+    EXPECT_EQ(row->col_blob(4), std::string_view("\0\xff" "A", 3));
+    EXPECT_EQ(res->nextRow(), nullptr);
+}
+
+TEST_F(SqliteDatabaseTest, SelectWhileWriting)
+{
+    start();
+
+    // more rows than read in one step, writes are queued while the result is read
+    constexpr int rowCount = SQLITE3_FETCH_SIZE * 2 + 1;
+    auto res = sqlDatabase->select(fmt::format("WITH RECURSIVE n(x) AS (SELECT 1 UNION ALL SELECT x + 1 FROM n WHERE x < {}) SELECT x FROM n", rowCount));
+    ASSERT_NE(res, nullptr);
+    int count = 0;
+    while (auto row = res->nextRow()) {
+        count++;
+        EXPECT_EQ(row->col_int(0, 0), count);
+        if (count % SQLITE3_FETCH_SIZE == 0)
+            database->storeInternalSetting(fmt::format("key-{}", count), "value");
+    }
+    EXPECT_EQ(count, rowCount);
+    EXPECT_EQ(res->getNumRows(), static_cast<unsigned long long>(rowCount));
+    EXPECT_EQ(selectValue(R"(SELECT COUNT(*) FROM "mt_internal_setting" WHERE "key" LIKE 'key-%')", {}), "2");
+}
+
+TEST_F(SqliteDatabaseTest, StreamedRowCount)
+{
+    config->journalMode = "WAL";
+    config->intOptions[ConfigVal::SERVER_STORAGE_SQLITE_READ_CONNECTIONS] = 1;
+    start();
+
+    // results of a read connection count the rows read so far, empty results none
+    constexpr int rowCount = SQLITE3_FETCH_SIZE * 2 + 1;
+    auto res = sqlDatabase->select(fmt::format("WITH RECURSIVE n(x) AS (SELECT 1 UNION ALL SELECT x + 1 FROM n WHERE x < {}) SELECT x FROM n", rowCount));
+    ASSERT_NE(res, nullptr);
+    EXPECT_EQ(res->getNumRows(), static_cast<unsigned long long>(SQLITE3_FETCH_SIZE));
+    int count = 0;
+    while (res->nextRow())
+        count++;
+    EXPECT_EQ(count, rowCount);
+    EXPECT_EQ(res->getNumRows(), static_cast<unsigned long long>(rowCount));
+
+    res = sqlDatabase->select(R"(SELECT "key" FROM "mt_internal_setting" WHERE "key" = 'missing')");
+    ASSERT_NE(res, nullptr);
+    EXPECT_EQ(res->getNumRows(), 0U);
+}
+
+TEST_F(SqliteDatabaseTest, ReadConnectionSeesQueuedWrites)
+{
+    config->journalMode = "WAL";
+    config->intOptions[ConfigVal::SERVER_STORAGE_SQLITE_READ_CONNECTIONS] = 2;
+    start();
+
+    for (int i = 0; i < 200; i++) {
+        auto key = fmt::format("key-{}", i);
+        sqlDatabase->execAsync(fmt::format(R"(INSERT INTO "mt_internal_setting" VALUES('{}', 'value-{}'))", key, i));
+        EXPECT_EQ(selectValue(R"(SELECT "value" FROM "mt_internal_setting" WHERE "key" = ?)", { key }), fmt::format("value-{}", i));
+    }
+}
+
+TEST_F(SqliteDatabaseTest, ReadConnectionInTransaction)
+{
+    config->journalMode = "WAL";
+    config->intOptions[ConfigVal::SERVER_STORAGE_SQLITE_READ_CONNECTIONS] = 2;
+    config->boolOptions[ConfigVal::SERVER_STORAGE_USE_TRANSACTIONS] = true;
+    start();
+
+    const std::string query = R"(SELECT "value" FROM "mt_internal_setting" WHERE "key" = ?)";
+    sqlDatabase->beginTransaction("test");
+    sqlDatabase->exec(R"(INSERT INTO "mt_internal_setting" VALUES('key', 'value'))");
+    // the thread of the transaction sees its change, other threads only committed data
+    EXPECT_EQ(selectValue(query, { "key" }), "value");
+    std::string otherValue;
+    std::thread([&] { otherValue = selectValue(query, { "key" }); }).join();
+    EXPECT_EQ(otherValue, "<no row>");
+
+    sqlDatabase->commit("test");
+    std::thread([&] { otherValue = selectValue(query, { "key" }); }).join();
+    EXPECT_EQ(otherValue, "value");
+}
+
+TEST_F(SqliteDatabaseTest, QueuedWritesInOrder)
+{
+    start();
+
+    // writes to the same row are applied in the order they were queued, even across batches
+    std::vector<std::future<void>> results;
+    results.push_back(sqlDatabase->execAsync(R"(INSERT INTO "mt_internal_setting" VALUES('key', 'value-0'))"));
+    for (int i = 1; i <= SQLITE3_WRITE_BATCH_SIZE * 2; i++)
+        results.push_back(sqlDatabase->execAsync(fmt::format(R"(UPDATE "mt_internal_setting" SET "value" = 'value-{}' WHERE "key" = 'key')", i)));
+    for (auto&& result : results)
+        EXPECT_NO_THROW(result.get());
+    EXPECT_EQ(selectValue(R"(SELECT "value" FROM "mt_internal_setting" WHERE "key" = ?)", { "key" }), fmt::format("value-{}", SQLITE3_WRITE_BATCH_SIZE * 2));
+}
+
+TEST_F(SqliteDatabaseTest, QueuedWriteFailure)
+{
+    start();
+
+    // a failing write only fails its own future, the other writes of the batch are kept
+    auto first = sqlDatabase->execAsync(R"(INSERT INTO "mt_internal_setting" VALUES('first', 'value'))");
+    auto failed = sqlDatabase->execAsync(R"(INSERT INTO "no_such_table" VALUES('key', 'value'))");
+    auto last = sqlDatabase->execAsync(R"(INSERT INTO "mt_internal_setting" VALUES('last', 'value'))");
+    EXPECT_NO_THROW(first.get());
+    EXPECT_THROW(failed.get(), std::runtime_error);
+    EXPECT_NO_THROW(last.get());
+    EXPECT_EQ(selectValue(R"(SELECT COUNT(*) FROM "mt_internal_setting" WHERE "key" IN ('first', 'last'))", {}), "2");
+}
+
+TEST_F(SqliteDatabaseTest, QueuedWritesInTransaction)
+{
+    config->boolOptions[ConfigVal::SERVER_STORAGE_USE_TRANSACTIONS] = true;
+    start();
+
+    // writes queued in a transaction are only done when it is committed
+    sqlDatabase->beginTransaction("test");
+    auto rolledBack = sqlDatabase->execAsync(R"(INSERT INTO "mt_internal_setting" VALUES('rolled-back', 'value'))");
+    sqlDatabase->rollback("test");
+    EXPECT_THROW(rolledBack.get(), std::runtime_error);
+    EXPECT_EQ(selectValue(R"(SELECT COUNT(*) FROM "mt_internal_setting" WHERE "key" = ?)", { "rolled-back" }), "0");
+
+    sqlDatabase->beginTransaction("test");
+    auto committed = sqlDatabase->execAsync(R"(INSERT INTO "mt_internal_setting" VALUES('committed', 'value'))");
+    // the write has run but waits for the transaction
+    EXPECT_EQ(selectValue(R"(SELECT COUNT(*) FROM "mt_internal_setting" WHERE "key" = ?)", { "committed" }), "1");
+    EXPECT_EQ(committed.wait_for(std::chrono::milliseconds(100)), std::future_status::timeout);
+    sqlDatabase->commit("test");
+    EXPECT_NO_THROW(committed.get());
+}
+
+TEST_F(SqliteDatabaseTest, SearchIndexTriggers)
+{
+    config->boolOptions[ConfigVal::SERVER_STORAGE_SQLITE_SEARCH_INDEX] = true;
+    start();
+    if (selectValue("SELECT COUNT(*) FROM sqlite_master WHERE name = ?", { SEARCH_INDEX_TITLE_TABLE }) != "1")
+        GTEST_SKIP() << "sqlite3 without FTS5 trigram tokenizer";
+
+    const std::string titleQuery = R"(SELECT COUNT(*) FROM "grb_search_title" WHERE "dc_title" LIKE ?)";
+    const std::string metaQuery = R"(SELECT COUNT(*) FROM "grb_search_metadata" WHERE "property_value" LIKE ?)";
+    sqlDatabase->exec(R"(INSERT INTO "mt_cds_object" ("id", "parent_id", "object_type", "dc_title") VALUES (100, 0, 2, 'Rolling In The Deep'))");
+    sqlDatabase->exec(R"(INSERT INTO "mt_metadata" ("id", "item_id", "property_name", "property_value") VALUES (100, 100, 'upnp:artist', 'Adele'))");
+    sqlDatabase->exec(R"(INSERT INTO "mt_metadata" ("id", "item_id", "property_name", "property_value") VALUES (101, 100, 'upnp:date', 'Adelaide'))");
+    EXPECT_EQ(selectValue(titleQuery, { "%the deep%" }), "1");
+    EXPECT_EQ(selectValue(metaQuery, { "%adel%" }), "1");
+
+    sqlDatabase->exec(R"(UPDATE "mt_cds_object" SET "dc_title" = 'Someone Like You' WHERE "id" = 100)");
+    sqlDatabase->exec(R"(UPDATE "mt_metadata" SET "property_value" = 'Amy' WHERE "id" = 100)");
+    EXPECT_EQ(selectValue(titleQuery, { "%the deep%" }), "0");
+    EXPECT_EQ(selectValue(titleQuery, { "%like you%" }), "1");
+    EXPECT_EQ(selectValue(metaQuery, { "%adel%" }), "0");
+    EXPECT_EQ(selectValue(metaQuery, { "%amy%" }), "1");
+
+    // metadata is removed by the foreign key
+    sqlDatabase->exec(R"(DELETE FROM "mt_cds_object" WHERE "id" = 100)");
+    EXPECT_EQ(selectValue(titleQuery, { "%like you%" }), "0");
+    EXPECT_EQ(selectValue(metaQuery, { "%amy%" }), "0");
+
+    // switching the option off removes the index
+    database->shutdown();
+    config->boolOptions[ConfigVal::SERVER_STORAGE_SQLITE_SEARCH_INDEX] = false;
+    start();
+    EXPECT_EQ(selectValue("SELECT COUNT(*) FROM sqlite_master WHERE name = ?", { SEARCH_INDEX_TITLE_TABLE }), "0");
+    EXPECT_EQ(selectValue("SELECT COUNT(*) FROM sqlite_master WHERE type = 'trigger'", {}), "0");
+}
+
+TEST_F(SqliteDatabaseTest, SeekPages)
+{
+    start();
+    sqlDatabase->exec(R"(CREATE TABLE "seek_test" ("id" integer primary key, "a" text, "b" integer))");
+    sqlDatabase->exec(R"(INSERT INTO "seek_test" VALUES (1, 'x', 1), (2, NULL, 2), (3, 'y', NULL), (4, 'x', NULL), (5, NULL, NULL),
+        (6, 'y', 3), (7, 'x', 1), (8, NULL, 2), (9, 'z', 1), (10, 'it''s', 4))");
+
+    for (auto&& orderTerms : std::vector<std::vector<std::string>> {
+             { R"("a" ASC)", R"("b" ASC)", R"("id" ASC)" },
+             { R"("a" DESC)", R"("b" ASC)", R"("id" ASC)" },
+             { R"("a" ASC)", R"("b" DESC)", R"("id" ASC)" },
+             { R"("a" DESC)", R"("b" DESC)", R"("id" ASC)" },
+         }) {
+        auto orderBy = fmt::format("{}", fmt::join(orderTerms, ", "));
+        std::vector<std::string> expected;
+        auto res = sqlDatabase->select(fmt::format(R"(SELECT "id" FROM "seek_test" ORDER BY {})", orderBy));
+        while (auto row = res->nextRow())
+            expected.push_back(row->col(0));
+
+        // read pages of 3 rows, each continues after the keys of the last row of the page before
+        std::vector<std::string> paged;
+        std::vector<std::string> keys;
+        for (int page = 0; page < 10; page++) {
+            auto where = keys.empty() ? "" : fmt::format(" WHERE {}", SqlHelpers::getSeekCondition(orderTerms, keys));
+            res = sqlDatabase->select(fmt::format(R"(SELECT "id"{} FROM "seek_test"{} ORDER BY {} LIMIT 3)", SqlHelpers::getSortKeyColumns(orderTerms), where, orderBy));
+            std::unique_ptr<SQLRow> last;
+            while (auto row = res->nextRow()) {
+                paged.push_back(row->col(0));
+                last = std::move(row);
+            }
+            if (!last)
+                break;
+            keys = SqlHelpers::getSortKeys(last, 1, orderTerms.size());
+        }
+        EXPECT_EQ(paged, expected) << orderBy;
+    }
+}
+
+TEST_F(SqliteDatabaseTest, ChildCounts)
+{
+    start();
+
+    auto first = makeContainer(CDS_ID_FS_ROOT, "first");
+    database->addObject(first, nullptr);
+    auto second = makeContainer(CDS_ID_FS_ROOT, "second");
+    database->addObject(second, nullptr);
+    auto sub = makeContainer(first->getID(), "sub");
+    database->addObject(sub, nullptr);
+    EXPECT_EQ(childCounts(first->getID()), "1/0");
+
+    std::vector<std::shared_ptr<CdsObject>> batch;
+    for (int i = 0; i < 5; i++)
+        batch.push_back(makeItem(i < 3 ? first->getID() : second->getID(), fmt::format("item{}", i)));
+    database->addObjects(batch);
+    EXPECT_EQ(childCounts(first->getID()), "1/3");
+    EXPECT_EQ(childCounts(second->getID()), "0/2");
+    EXPECT_EQ(wrongChildCounts(), "0");
+
+    // move an item to another container
+    batch.front()->setParentID(second->getID());
+    database->updateObject(batch.front(), nullptr);
+    EXPECT_EQ(childCounts(first->getID()), "1/2");
+    EXPECT_EQ(childCounts(second->getID()), "0/3");
+
+    // removing a container does not count its children for the parent
+    database->removeObjects({ sub->getID(), batch.back()->getID() });
+    EXPECT_EQ(childCounts(first->getID()), "0/2");
+    EXPECT_EQ(childCounts(second->getID()), "0/2");
+    EXPECT_EQ(wrongChildCounts(), "0");
+}
+
+TEST_F(SqliteDatabaseTest, CheckChildCounts)
+{
+    start();
+
+    auto cont = makeContainer(CDS_ID_FS_ROOT, "cont");
+    database->addObject(cont, nullptr);
+    database->addObject(makeItem(cont->getID(), "item"), nullptr);
+    sqlDatabase->exec(fmt::format(R"(UPDATE "mt_cds_object" SET "child_containers" = 7, "child_items" = 0 WHERE "id" = {})", cont->getID()));
+    EXPECT_EQ(wrongChildCounts(), "1");
+
+    // init corrects the stored counts
+    database->shutdown();
+    start();
+    EXPECT_EQ(childCounts(cont->getID()), "0/1");
+    EXPECT_EQ(wrongChildCounts(), "0");
+}
+
+TEST_F(SqliteDatabaseTest, AddObjectsBatch)
+{
+    start();
+
+    auto cont = makeContainer(CDS_ID_FS_ROOT, "cont");
+    database->addObject(cont, nullptr);
+
+    // containers and items have different column lists, the ids of each insert are matched to the objects
+    std::vector<std::shared_ptr<CdsObject>> batch;
+    for (int i = 0; i < 7; i++) {
+        if (i % 3 == 0) {
+            batch.push_back(makeContainer(cont->getID(), fmt::format("sub{}", i)));
+        } else {
+            auto item = makeItem(cont->getID(), fmt::format("item{}", i));
+            item->addMetaData(MetadataFields::M_TITLE, item->getTitle());
+            batch.push_back(item);
+        }
+    }
+    database->addObjects(batch);
+
+    std::set<int> ids;
+    for (auto&& obj : batch) {
+        ids.insert(obj->getID());
+        EXPECT_EQ(selectValue(R"(SELECT "dc_title" FROM "mt_cds_object" WHERE "id" = ?)", { obj->getID() }), obj->getTitle());
+        if (obj->isItem())
+            EXPECT_EQ(selectValue(R"(SELECT "property_value" FROM "mt_metadata" WHERE "item_id" = ? AND "property_name" = 'dc:title')", { obj->getID() }), obj->getTitle());
+        EXPECT_EQ(ancestorCount(obj->getID()), ancestorCount(cont->getID()) + 1);
+    }
+    EXPECT_EQ(ids.size(), batch.size());
+    EXPECT_EQ(childCounts(cont->getID()), "3/4");
+}
+
+TEST_F(SqliteDatabaseTest, BackupInSteps)
+{
+    start();
+    database->storeInternalSetting("backup-key", "value");
+    backupAndShutdown();
+    EXPECT_EQ(backupValue("backup-key"), "value");
+}
+
+TEST_F(SqliteDatabaseTest, BackupInStepsWithExclusiveWal)
+{
+    // without read connections the WAL database is locked exclusively, the backup runs in the sqlite3 thread
+    config->journalMode = "WAL";
+    start();
+    database->storeInternalSetting("backup-key", "value");
+    backupAndShutdown();
+    EXPECT_EQ(backupValue("backup-key"), "value");
+}
+
+TEST_F(SqliteDatabaseTest, BackupOnOwnConnection)
+{
+    config->journalMode = "WAL";
+    config->intOptions[ConfigVal::SERVER_STORAGE_SQLITE_READ_CONNECTIONS] = 1;
+    start();
+    database->storeInternalSetting("backup-key", "value");
+    backupAndShutdown();
+    EXPECT_EQ(backupValue("backup-key"), "value");
+}
+
+TEST_F(SqliteDatabaseTest, BackupFailsOnLockedDatabase)
+{
+    start();
+    database->storeInternalSetting("backup-key", "value");
+
+    // the locked backup file makes every step busy, the backup gives up and shutdown does not hang
+    sqlite3* locker = nullptr;
+    ASSERT_EQ(sqlite3_open(fmt::format(SQLITE3_BACKUP_FORMAT, dbFile.string()).c_str(), &locker), SQLITE_OK);
+    ASSERT_EQ(sqlite3_exec(locker, "CREATE TABLE \"lock\" (\"id\" integer); BEGIN EXCLUSIVE", nullptr, nullptr, nullptr), SQLITE_OK);
+    backupAndShutdown();
+    sqlite3_exec(locker, "ROLLBACK", nullptr, nullptr, nullptr);
+    sqlite3_close(locker);
+    EXPECT_EQ(backupValue("backup-key"), "<no backup>");
+}
+
+TEST_F(SqliteDatabaseTest, ObjectCacheDropsChangedParents)
+{
+    config->intOptions[ConfigVal::SERVER_STORAGE_OBJECT_CACHE_SIZE] = 100;
+    start();
+
+    // hits/misses/size of the object cache
+    auto cacheStats = [this] {
+        auto status = database->getStatus();
+        return fmt::format("{}/{}/{}", status["objectCacheHits"], status["objectCacheMisses"], status["objectCacheSize"]);
+    };
+    // load the container through the cache, the stored counts are read separately
+    auto childCount = [this](int id) {
+        EXPECT_NE(database->loadObject(id), nullptr);
+        return database->getChildCount(id);
+    };
+
+    auto first = makeContainer(CDS_ID_FS_ROOT, "first");
+    database->addObject(first, nullptr);
+    auto second = makeContainer(CDS_ID_FS_ROOT, "second");
+    database->addObject(second, nullptr);
+    EXPECT_EQ(childCount(first->getID()), 0);
+    EXPECT_EQ(childCount(first->getID()), 0);
+    EXPECT_EQ(cacheStats(), "1/1/1");
+
+    // every change of the children drops the cached container
+    auto item = makeItem(first->getID(), "item");
+    database->addObject(item, nullptr);
+    EXPECT_EQ(cacheStats(), "1/1/0");
+    EXPECT_EQ(childCount(first->getID()), 1);
+    EXPECT_EQ(cacheStats(), "1/2/1");
+
+    database->addObjects({ makeItem(first->getID(), "batch") });
+    EXPECT_EQ(cacheStats(), "1/2/0");
+    EXPECT_EQ(childCount(first->getID()), 2);
+    EXPECT_EQ(cacheStats(), "1/3/1");
+
+    EXPECT_EQ(childCount(second->getID()), 0);
+    EXPECT_EQ(cacheStats(), "1/4/2");
+    item->setParentID(second->getID());
+    database->updateObject(item, nullptr);
+    EXPECT_EQ(cacheStats(), "1/4/0");
+    EXPECT_EQ(childCount(first->getID()), 1);
+    EXPECT_EQ(childCount(second->getID()), 1);
+    EXPECT_EQ(cacheStats(), "1/6/2");
+}
+
+TEST_F(SqliteDatabaseTest, SearchCacheDropsOnWrite)
+{
+    config->intOptions[ConfigVal::SERVER_STORAGE_SEARCH_CACHE_SIZE] = 10;
+    start();
+
+    auto cont = makeContainer(CDS_ID_FS_ROOT, "cont");
+    database->addObject(cont, nullptr);
+    auto item = makeItem(cont->getID(), "song one");
+    database->addObject(item, nullptr);
+
+    // the system update id stays the same, results change with the objects anyway
+    auto search = [this] {
+        auto param = SearchParam(fmt::to_string(CDS_ID_ROOT), R"(dc:title contains "song")", "", 0, 10, false, UNUSED_CLIENT_GROUP);
+        param.setUpdateId(1);
+        return database->search(param).size();
+    };
+    EXPECT_EQ(search(), 1U);
+    EXPECT_EQ(search(), 1U);
+
+    database->addObject(makeItem(cont->getID(), "song two"), nullptr);
+    EXPECT_EQ(search(), 2U);
+
+    item->setTitle("tune");
+    database->updateObject(item, nullptr);
+    EXPECT_EQ(search(), 1U);
+}
+
+TEST_F(SqliteDatabaseTest, SearchCountsObjects)
+{
+    config->intOptions[ConfigVal::SERVER_STORAGE_SEARCH_CACHE_SIZE] = 10;
+    start();
+
+    auto cont = makeContainer(CDS_ID_FS_ROOT, "cont");
+    database->addObject(cont, nullptr);
+    for (auto&& title : { "song one", "song two", "song three" }) {
+        auto item = makeItem(cont->getID(), title);
+        // several values of the sort key join several rows of the object
+        item->addMetaData(MetadataFields::M_ARTIST, "first");
+        item->addMetaData(MetadataFields::M_ARTIST, "second");
+        database->addObject(item, nullptr);
+    }
+
+    for (auto updateId : { 1, -1 }) {
+        auto param = SearchParam(fmt::to_string(CDS_ID_ROOT), R"(dc:title contains "song")", "+upnp:artist", 0, 2, false, UNUSED_CLIENT_GROUP);
+        param.setUpdateId(updateId);
+        EXPECT_EQ(database->search(param).size(), 2U) << updateId;
+        EXPECT_EQ(param.getTotalMatches(), 3) << updateId;
+    }
+}
+
+TEST_F(SqliteDatabaseTest, SearchCacheRemembersLargeSearches)
+{
+    config->intOptions[ConfigVal::SERVER_STORAGE_SEARCH_CACHE_SIZE] = 10;
+    start();
+
+    auto cont = makeContainer(CDS_ID_FS_ROOT, "cont");
+    database->addObject(cont, nullptr);
+    sqlDatabase->exec(fmt::format(R"(INSERT INTO "mt_cds_object" ("parent_id", "object_type", "upnp_class", "dc_title", "sort_key") )"
+                                  R"(WITH RECURSIVE n(x) AS (SELECT 1 UNION ALL SELECT x + 1 FROM n WHERE x < {0}) )"
+                                  R"(SELECT {1}, {2}, '{3}', 'song ' || x, 'song ' || x FROM n)",
+        SEARCH_CACHE_MAX_IDS + 1, cont->getID(), OBJECT_TYPE_ITEM, UPNP_CLASS_MUSIC_TRACK));
+
+    // the second search finds the search marked as too large instead of reading the ids again
+    for (auto&& hits : { "0", "1" }) {
+        auto param = SearchParam(fmt::to_string(CDS_ID_ROOT), R"(upnp:class derivedfrom "object.item")", "", 0, 10, false, UNUSED_CLIENT_GROUP);
+        param.setUpdateId(1);
+        EXPECT_EQ(database->search(param).size(), 10U);
+        EXPECT_EQ(param.getTotalMatches(), SEARCH_CACHE_MAX_IDS + 1);
+        auto status = database->getStatus();
+        EXPECT_EQ(status["searchCacheHits"], hits);
+        EXPECT_EQ(status["searchCacheSize"], "1");
+    }
+}
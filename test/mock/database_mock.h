@@ -37,6 +37,7 @@ public:
     void shutdown() override { }
 
     void addObject(const std::shared_ptr<CdsObject>& object, int* changedContainer) override { }
+    void addObjects(const std::vector<std::shared_ptr<CdsObject>>& objects) override { }
     bool addContainer(int parentContainerId, std::string virtualPath, const std::shared_ptr<CdsContainer>& cont, int* containerID) override { return true; }
     fs::path buildContainerPath(int parentID, const std::string& title) override { return {}; }
 
@@ -50,6 +51,7 @@ public:
     std::vector<std::shared_ptr<CdsObject>> findObjectByContentClass(const std::string& contentClass, const std::string& group) override { return {}; }
     std::shared_ptr<CdsObject> findObjectByPath(const fs::path& path, const std::string& group, DbFileType fileType = DbFileType::Auto) override { return {}; }
     int findObjectIDByPath(const fs::path& fullpath, DbFileType fileType = DbFileType::Auto) override { return INVALID_OBJECT_ID; }
+    std::unordered_map<std::string, FileState> getFileStates(int containerId) override { return {}; }
     std::string incrementUpdateIDs(const std::unordered_set<int>& ids) override { return {}; }
 
     std::shared_ptr<CdsObject> loadObject(int objectID) override { return nullptr; }
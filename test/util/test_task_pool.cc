@@ -0,0 +1,83 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    test_task_pool.cc - this file is part of Gerbera.
+
+    Copyright (C) 2025 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+/// \file test_task_pool.cc
+#include "util/task_pool.h"
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+TEST(TaskPoolTest, RunsAllTasks)
+{
+    TaskPool pool("TestPool", 3);
+    std::vector<int> results(20);
+    std::vector<std::function<void()>> tasks;
+    for (std::size_t i = 0; i < results.size(); i++)
+        tasks.emplace_back([&results, i] { results[i] = static_cast<int>(i) * 2; });
+
+    pool.run(std::move(tasks));
+    for (std::size_t i = 0; i < results.size(); i++)
+        EXPECT_EQ(results[i], static_cast<int>(i) * 2);
+}
+
+TEST(TaskPoolTest, RunsWithoutThreads)
+{
+    TaskPool pool("TestPool", 0);
+    int count = 0;
+    pool.run({ [&count] { count++; }, [&count] { count++; } });
+    EXPECT_EQ(count, 2);
+}
+
+TEST(TaskPoolTest, RethrowsFirstErrorAfterAllTasks)
+{
+    TaskPool pool("TestPool", 2);
+    std::atomic<int> count = 0;
+    std::vector<std::function<void()>> tasks;
+    for (int i = 0; i < 5; i++)
+        tasks.emplace_back([&count] { count++; });
+    tasks.emplace_back([] { throw std::runtime_error("failed"); });
+
+    EXPECT_THROW(pool.run(std::move(tasks)), std::runtime_error);
+    EXPECT_EQ(count, 5);
+}
+
+TEST(TaskPoolTest, ServesConcurrentCallers)
+{
+    TaskPool pool("TestPool", 2);
+    std::atomic<int> count = 0;
+    auto caller = [&pool, &count] {
+        for (int run = 0; run < 10; run++) {
+            std::vector<std::function<void()>> tasks;
+            for (int i = 0; i < 8; i++)
+                tasks.emplace_back([&count] { count++; });
+            pool.run(std::move(tasks));
+        }
+    };
+    std::thread first(caller);
+    std::thread second(caller);
+    first.join();
+    second.join();
+    EXPECT_EQ(count, 160);
+}
@@ -341,3 +341,40 @@ TEST(ToolsTest, parseTimeTest)
     EXPECT_EQ(result, 0);
     EXPECT_EQ(value, "1x:1x");
 }
+
+TEST(ToolsTest, sortKeyOrdersNumbersByValue)
+{
+    EXPECT_LT(makeSortKey("Track 2"), makeSortKey("Track 10"));
+    EXPECT_LT(makeSortKey("Track 9"), makeSortKey("Track 010"));
+    EXPECT_EQ(makeSortKey("Track 007"), makeSortKey("track 7"));
+    EXPECT_EQ(makeSortKey("Track 0"), "track 010");
+}
+
+TEST(ToolsTest, sortKeyFoldsCase)
+{
+    EXPECT_EQ(makeSortKey("ABBA"), "abba");
+    EXPECT_EQ(makeSortKey("Ärger ÜBER Straße"), "ärger über strasse");
+    EXPECT_EQ(makeSortKey("ΑΛΦΑ Ŀ"), "αλφα ŀ");
+    EXPECT_EQ(makeSortKey("ПРИВЕТ Ё"), "привет ё");
+    EXPECT_EQ(makeSortKey("İSTANBUL ı"), "istanbul ı");
+    // invalid utf-8 is kept
+    EXPECT_EQ(makeSortKey("A\xff"), "a\xff");
+}
+
+TEST(ToolsTest, sortKeyStripsArticles)
+{
+    std::vector<std::string> articles { "The", "A" };
+    EXPECT_EQ(makeSortKey("The Beatles", articles), "beatles");
+    EXPECT_EQ(makeSortKey("  a Tribe", articles), "tribe");
+    EXPECT_EQ(makeSortKey("Theory", articles), "theory");
+    EXPECT_EQ(makeSortKey("The", articles), "the");
+    EXPECT_EQ(makeSortKey("The Beatles"), "the beatles");
+}
+
+TEST(ToolsTest, sortKeyIsLimited)
+{
+    auto key = makeSortKey(std::string(300, 'x') + "ä");
+    EXPECT_EQ(key.size(), 255);
+    key = makeSortKey(std::string(254, 'x') + "ä");
+    EXPECT_EQ(key, std::string(254, 'x'));
+}
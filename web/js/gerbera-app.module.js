@@ -29,6 +29,7 @@ import { Tweaks } from "./gerbera-tweak.module.js";
 import { Tree } from './gerbera-tree.module.js';
 import { Updates } from './gerbera-updates.module.js';
 import { Clients } from './gerbera-clients.module.js';
+import { Queries } from './gerbera-queries.module.js';
 import { Config } from './gerbera-config.module.js';
 
 export class App {
@@ -54,6 +55,7 @@ export class App {
         'search': [],
         'fs': [],
         'clients': [],
+        'queries': [],
         'config': [],
       }
     };
@@ -63,6 +65,7 @@ export class App {
       'search': '#nav-search',
       'fs': '#nav-fs',
       'clients': '#nav-clients',
+      'queries': '#nav-queries',
       'config': '#nav-config',
     };
   }
@@ -188,6 +191,7 @@ export class App {
         'search': [],
         'fs': [],
         'clients': [],
+        'queries': [],
         'config': [],
       }
     };
@@ -290,6 +294,27 @@ export class App {
     }
   }
 
+  showCacheStatus(itemList) {
+    const hits = this.getStatusValue(itemList, 'objectCacheHits');
+    if (hits && hits !== '') {
+      $('#status-cache-hits').html(hits + ' hits');
+      $('#status-cache-misses').html(this.getStatusValue(itemList, 'objectCacheMisses') + ' misses');
+    } else {
+      $('#status-cache').hide();
+    }
+  }
+
+  showBackupStatus(itemList) {
+    const state = this.getStatusValue(itemList, 'backupState');
+    if (state && state !== '') {
+      const progress = this.getStatusValue(itemList, 'backupProgress');
+      $('#status-backup-state').html(progress && progress !== '' ? state + ' ' + progress : state);
+      $('#status-backup-time').html(this.getStatusValue(itemList, 'backupTime'));
+    } else {
+      $('#status-backup').hide();
+    }
+  }
+
   displayStatus(response) {
     let cnt = 0;
     if (response.success && response.values) {
@@ -306,6 +331,11 @@ export class App {
       cnt += this.showStatus(response.values.item, 'imagePhoto');
       cnt += this.showStatus(response.values.item, 'text');
       cnt += this.showStatus(response.values.item, 'item');
+      this.showCacheStatus(response.values.item);
+      this.showBackupStatus(response.values.item);
+    } else {
+      $('#status-cache').hide();
+      $('#status-backup').hide();
     }
     if (cnt == 0) {
       $('#server-empty').show();
@@ -393,6 +423,7 @@ export class App {
       Autoscan.initialize();
       Updates.initialize();
       Clients.initialize();
+      Queries.initialize();
       Config.initialize();
       Tweaks.initialize();
       this.getStatus(this.clientConfig)
@@ -439,6 +470,7 @@ export class App {
     Trail.destroy();
     Items.destroy();
     Clients.destroy();
+    Queries.destroy();
     Config.destroy();
   }
 
@@ -26,6 +26,7 @@ import { GerberaApp } from "./gerbera-app.module.js";
 import { Trail } from "./gerbera-trail.module.js";
 import { Tree } from "./gerbera-tree.module.js";
 import { Clients } from "./gerbera-clients.module.js";
+import { Queries } from "./gerbera-queries.module.js";
 import { Config } from "./gerbera-config.module.js";
 
 const disable = () => {
@@ -91,12 +92,14 @@ const selectType = (menuItem) => {
   $('#home').hide();
   $('#content').show();
   $('#clients').hide();
+  $('#queries').hide();
   $('#config').hide();
   const type = menuItem.data('gerbera-type');
   Tree.selectType(type, 0);
   GerberaApp.setType(type);
   Items.destroy();
   Clients.destroy();
+  Queries.destroy();
   Config.destroy();
 };
 
@@ -104,6 +107,7 @@ const selectClients = (menuItem) => {
   $('#home').hide();
   $('#content').hide();
   $('#clients').show();
+  $('#queries').hide();
   $('#config').hide();
   Trail.destroy();
   const type = menuItem.data('gerbera-type');
@@ -111,6 +115,22 @@ const selectClients = (menuItem) => {
   Clients.menuSelected();
   Items.destroy();
   Clients.destroy();
+  Queries.destroy();
+  Config.destroy();
+};
+
+const selectQueries = (menuItem) => {
+  $('#home').hide();
+  $('#content').hide();
+  $('#clients').hide();
+  $('#queries').show();
+  $('#config').hide();
+  Trail.destroy();
+  const type = menuItem.data('gerbera-type');
+  GerberaApp.setType(type);
+  Queries.menuSelected();
+  Items.destroy();
+  Clients.destroy();
   Config.destroy();
 };
 
@@ -118,12 +138,14 @@ const selectConfig = (menuItem) => {
   $('#home').hide();
   $('#content').hide();
   $('#clients').hide();
+  $('#queries').hide();
   $('#config').show();
   const type = menuItem.data('gerbera-type');
   GerberaApp.setType(type);
   Config.menuSelected();
   Items.destroy();
   Clients.destroy();
+  Queries.destroy();
   Config.destroy();
 };
 
@@ -148,6 +170,9 @@ var click = (event) => {
     case 'SELECT_CLIENTS':
       selectClients(menuItem);
       break;
+    case 'SELECT_QUERIES':
+      selectQueries(menuItem);
+      break;
     case 'SELECT_CONFIG':
       selectConfig(menuItem);
       break;
@@ -161,12 +186,14 @@ var home = function () {
   $('#home').show();
   $('#content').hide();
   $('#clients').hide();
+  $('#queries').hide();
   $('#config').hide();
   GerberaApp.setType('home');
   Tree.destroy();
   Trail.destroy();
   Items.destroy();
   Clients.destroy();
+  Queries.destroy();
   Config.destroy();
 };
 
@@ -0,0 +1,121 @@
+/*GRB*
+
+    Gerbera - https://gerbera.io/
+
+    gerbera-queries.module.js - this file is part of Gerbera.
+
+    Copyright (C) 2025 Gerbera Contributors
+
+    Gerbera is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License version 2
+    as published by the Free Software Foundation.
+
+    Gerbera is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Gerbera.  If not, see <http://www.gnu.org/licenses/>.
+
+    $Id$
+*/
+import { GerberaApp } from './gerbera-app.module.js';
+import { Auth } from './gerbera-auth.module.js';
+
+const queryHeadings = {
+  shape: 'Statement',
+  count: 'Count',
+  total: 'Total (ms)',
+  avg: 'Average (ms)',
+  max: 'Max (ms)',
+  histogram: '<0.1 / <1 / <10 / <100 / <1000 / >=1000 ms',
+};
+
+const slowHeadings = {
+  time: 'Time',
+  duration: 'Duration (ms)',
+  query: 'Statement',
+  plan: 'Plan',
+};
+
+const destroy = () => {
+  $('#querygrid').html('');
+};
+
+const initialize = () => {
+  $('#querygrid').html('');
+  return Promise.resolve();
+};
+
+const menuSelected = () => {
+  retrieveGerberaItems('queries')
+    .then((response) => loadItems(response))
+    .catch((err) => GerberaApp.error(err));
+};
+
+const retrieveGerberaItems = (type) => {
+  var requestData = {
+    req_type: type,
+    action: 'load'
+  };
+  requestData[Auth.SID] = Auth.getSessionId();
+  return $.ajax({
+    url: GerberaApp.clientConfig.api,
+    type: 'get',
+    data: requestData
+  });
+};
+
+const buildTable = (data, headings, caption) => {
+  const table = $('<table></table>').addClass('table');
+  const thead = $('<thead></thead>');
+  const tbody = $('<tbody></tbody>');
+  const props = Object.keys(headings);
+
+  const captionRow = $('<tr></tr>');
+  $('<th colspan="' + props.length + '"></th>').text(caption).appendTo(captionRow);
+  thead.append(captionRow);
+
+  if (data && data.length > 0) {
+    const row = $('<tr></tr>');
+    props.forEach((prop) => {
+      $('<th></th>').text(headings[prop]).addClass('grb-query-' + prop).appendTo(row);
+    });
+    thead.append(row);
+
+    data.forEach((item) => {
+      const row = $('<tr></tr>');
+      props.forEach((prop) => {
+        $('<td></td>').text(item[prop]).addClass('grb-query-' + prop).appendTo(row);
+      });
+      tbody.append(row);
+    });
+  } else {
+    const row = $('<tr></tr>');
+    $('<td colspan="' + props.length + '"></td>').text('No ' + caption + ' found').appendTo(row);
+    tbody.append(row);
+  }
+  table.append(thead);
+  table.append(tbody);
+  return table;
+};
+
+const loadItems = (response) => {
+  if (response.success) {
+    const queries = 'queries' in response ? response.queries.query : [];
+    const slow = 'slow' in response ? response.slow.query : [];
+
+    const datagrid = $('#querygrid');
+    datagrid.html('');
+    datagrid.append(buildTable(queries, queryHeadings, 'Statements'));
+    datagrid.append(buildTable(slow, slowHeadings, 'Slow Statements'));
+  }
+};
+
+export const Queries = {
+  destroy,
+  loadItems,
+  initialize,
+  menuSelected,
+};